@@ -27,7 +27,10 @@ void main()
     vec3 B = cross(N, T);
     mat3 TBN = mat3(T, B, N);
 
-    vec3 tNormals = TBN * normalize(texture(u_NormalMap, v_UV).xyz * 2.0 - vec3(1.0));
+    // Z is rebuilt from XY so two channel (BC5) normal maps work, uncompressed maps decode the same way
+    vec2 normalXY = texture(u_NormalMap, v_UV).xy * 2.0 - vec2(1.0);
+    vec3 tangentNormal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+    vec3 tNormals = TBN * normalize(tangentNormal);
     o_Normal = vec4(tNormals, 1.0);
 
     vec3 linearColor = decode(texture(u_DiffuseMap, v_UV).rgb);
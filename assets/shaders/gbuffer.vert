@@ -1,10 +1,21 @@
 #version 450
 
+#ifdef PACKED_VERTEX
+// Quantized VulkanModel::PackedVertex, color is a separate stream that only exists with VERTEX_COLOR
+layout (location = 0) in vec4 a_Position;
+#ifdef VERTEX_COLOR
+layout (location = 1) in vec4 a_Color;
+#endif
+layout (location = 2) in vec2 a_Normal;
+layout (location = 3) in vec2 a_Tangent;
+layout (location = 4) in vec2 a_UV;
+#else
 layout (location = 0) in vec3 a_Position;
 layout (location = 1) in vec3 a_Color;
 layout (location = 2) in vec3 a_Normal;
 layout (location = 3) in vec3 a_Tangent;
 layout (location = 4) in vec2 a_UV;
+#endif
 
 layout (location = 0) out vec3 v_WorldPos;
 layout (location = 1) out vec3 v_Color;
@@ -25,16 +36,43 @@ layout(set = 1, binding = 0) uniform GameObjectBufferData
 {
     mat4 ModelMatrix;
     mat4 NormalMatrix;
+    vec4 PositionOffset;
+    vec4 PositionScale;
 } u_GameObject;
 
+vec3 DecodeOctahedral(vec2 e)
+{
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.x += v.x >= 0.0 ? -t : t;
+    v.y += v.y >= 0.0 ? -t : t;
+    return normalize(v);
+}
+
 void main()
 {
+#ifdef PACKED_VERTEX
+    vec3 position = u_GameObject.PositionOffset.xyz + a_Position.xyz * u_GameObject.PositionScale.xyz;
+    vec3 normal = DecodeOctahedral(a_Normal);
+    vec3 tangent = DecodeOctahedral(a_Tangent);
+#ifdef VERTEX_COLOR
+    vec3 color = a_Color.rgb;
+#else
+    vec3 color = vec3(1.0);
+#endif
+#else
+    vec3 position = a_Position;
+    vec3 normal = normalize(a_Normal);
+    vec3 tangent = normalize(a_Tangent);
+    vec3 color = a_Color;
+#endif
+
     v_UV = a_UV;
-    v_WorldPos = mat3(u_GameObject.ModelMatrix) * a_Position;
+    v_WorldPos = mat3(u_GameObject.ModelMatrix) * position;
 
-    v_Normal = mat3(u_GameObject.NormalMatrix) * normalize(a_Normal);
-    v_Tangent = mat3(u_GameObject.NormalMatrix) * normalize(a_Tangent);
-    v_Color = a_Color;
+    v_Normal = mat3(u_GameObject.NormalMatrix) * normal;
+    v_Tangent = mat3(u_GameObject.NormalMatrix) * tangent;
+    v_Color = color;
 
-    gl_Position = u_UBO.Projection * u_UBO.View * u_GameObject.ModelMatrix * vec4(a_Position, 1.0);
+    gl_Position = u_UBO.Projection * u_UBO.View * u_GameObject.ModelMatrix * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -3,54 +3,84 @@
 #include "core/event/mouse_event.h"
 #include "engine_utils.h"
 #include "platform_path.h"
+#include "thread_pool.h"
+#include "vulkan/vulkan_asset_loader.h"
+#include "vulkan/vulkan_geometry_pool.h"
+#include "vulkan/vulkan_memory_allocator.h"
+#include "vulkan/vulkan_sampler_cache.h"
+#include "vulkan/vulkan_staging_ring.h"
+#include "vulkan/vulkan_streaming_model.h"
+#include "vulkan/vulkan_texture_streamer.h"
 
 #include <chrono>
+#include <cstdlib>
 
 void Application::CreateGameObjects(Scene& scene, VulkanRenderer& renderer)
 {
+    // Decoded on the thread pool and uploaded by the frame loop, objects show placeholders until then
+    VulkanAssetLoader& loader = VulkanAssetLoader::Get();
+
     TextureSpecification spec
     {
         .Usage = TextureUsage::Texture,
+        .Compression = TextureCompression::Auto,
+        .Streaming = true,
     };
 
 	auto textureDirectory = FileSystemUtil::GetTextureDirectory();
 
 	spec.DebugName = "Marble Color Texture";
-	auto marbleColor = VulkanTexture2D::CreateFromFile(spec, FileSystemUtil::PathToString(textureDirectory / "marble/color.jpg"));
+	spec.Encoding = MipGenerator::Encoding::SRGB;
+	auto marbleColor = loader.LoadTexture(spec, FileSystemUtil::PathToString(textureDirectory / "marble/color.jpg"));
 	spec.DebugName = "Marble Normal Texture";
-	auto marbleNormal = VulkanTexture2D::CreateFromFile(spec, FileSystemUtil::PathToString(textureDirectory / "marble/normal.jpg"));
+	spec.Encoding = MipGenerator::Encoding::NormalMap;
+	auto marbleNormal = loader.LoadTexture(spec, FileSystemUtil::PathToString(textureDirectory / "marble/normal.jpg"), loader.GetFlatNormalTexture());
 
 	spec.DebugName = "Paving Stones Color Texture";
-	auto pavingStonesColor = VulkanTexture2D::CreateFromFile(spec, FileSystemUtil::PathToString(textureDirectory / "paving_stones/color.jpg"));
+	spec.Encoding = MipGenerator::Encoding::SRGB;
+	auto pavingStonesColor = loader.LoadTexture(spec, FileSystemUtil::PathToString(textureDirectory / "paving_stones/color.jpg"));
 	spec.DebugName = "Paving Stones Normal Texture";
-	auto pavingStonesNormal = VulkanTexture2D::CreateFromFile(spec, FileSystemUtil::PathToString(textureDirectory / "paving_stones/normal.jpg"));
+	spec.Encoding = MipGenerator::Encoding::NormalMap;
+	auto pavingStonesNormal = loader.LoadTexture(spec, FileSystemUtil::PathToString(textureDirectory / "paving_stones/normal.jpg"), loader.GetFlatNormalTexture());
 
 	auto modelDirectory = FileSystemUtil::GetModelDirectory();
-    auto cubeModel = VulkanModel::CreateModelFromFile(FileSystemUtil::PathToString(modelDirectory /  "cube.obj"));
-    auto quadModel = VulkanModel::CreateModelFromFile(FileSystemUtil::PathToString(modelDirectory /  "quad.obj"));
+    auto cubeModel = loader.LoadModel(FileSystemUtil::PathToString(modelDirectory /  "cube.obj"));
+    auto quadModel = loader.LoadModel(FileSystemUtil::PathToString(modelDirectory /  "quad.obj"));
 
     auto& cubeA = scene.CreateGameObject(renderer);
 	cubeA.ObjectModel = cubeModel;
-	cubeA.ObjectTransform.Translation = {-0.5f, 0.0f, 2.0f};
-	cubeA.ObjectTransform.Scale = {0.25, 0.25, 0.25};
-	cubeA.ObjectTransform.Rotation = {0.0f, 0.0f, 0.0f};
+	cubeA.SetTransform({
+		.Translation = {-0.5f, 0.0f, 2.0f},
+		.Scale = {0.25, 0.25, 0.25},
+		.Rotation = {0.0f, 0.0f, 0.0f}});
 	cubeA.DiffuseMap = pavingStonesColor;
 	cubeA.NormalMap = pavingStonesNormal;
 
     auto &floor = scene.CreateGameObject(renderer);
     floor.ObjectModel = quadModel;
-    floor.ObjectTransform.Translation = {0.0f, 0.0f, 0.0};
-    floor.ObjectTransform.Scale = {3.f, 1.0f, 3.f};
-    floor.ObjectTransform.Rotation = {270.0, 0.0, 0.0};
+    floor.SetTransform({
+        .Translation = {0.0f, 0.0f, 0.0},
+        .Scale = {3.f, 1.0f, 3.f},
+        .Rotation = {270.0, 0.0, 0.0}});
 	floor.DiffuseMap = marbleColor;
 	floor.NormalMap = marbleNormal;
 }
 
 Application::Application()
 {
+    ThreadPool::Initialize();
+
     m_Window = std::make_unique<Window>();
     m_Window->SetEventCallback(BIND_FN(Application::OnEvent));
     VulkanContext::Initialize("coo", 1.0, m_Window.get());
+    VulkanContext& context = VulkanContext::Get();
+    VulkanMemoryAllocator::Initialize(context.Instance(), context.PhysicalDevice(), context.Device(), context.SupportsMemoryBudget());
+    VulkanTransferContext::Initialize();
+    VulkanStagingRing::Initialize();
+    VulkanGeometryPool::Initialize();
+    VulkanChunkStreamer::Initialize();
+    VulkanTextureStreamer::Initialize();
+    VulkanAssetLoader::Initialize();
 
     m_Renderer = std::make_unique<VulkanRenderer>(*m_Window);
     m_Renderer->Initialize();
@@ -63,9 +93,23 @@ Application::Application()
 
 Application::~Application()
 {
+    // High-water marks of the whole session, for sizing scenes against hardware tiers.
+    // Opt-in, COO_MEMORY_STATS names the file to write, e.g. memory_stats.json.
+    if (const char* statsPath = std::getenv("COO_MEMORY_STATS"); statsPath && *statsPath)
+        VulkanMemoryAllocator::Get().DumpStatsJson(statsPath);
+
     m_Renderer->Shutdown();
 	m_Scene = nullptr;
+    VulkanAssetLoader::Shutdown();
+    VulkanTextureStreamer::Shutdown();
+    VulkanChunkStreamer::Shutdown();
+    VulkanGeometryPool::Shutdown();
+    VulkanTransferContext::Shutdown();
+    VulkanStagingRing::Shutdown();
+    VulkanSamplerCache::Shutdown();
+    VulkanMemoryAllocator::Shutdown();
     VulkanContext::Shutdown();
+    ThreadPool::Shutdown();
 }
 
 void Application::Run()
@@ -80,6 +124,13 @@ void Application::Run()
         currentTime = newTime;
 
 		uint32_t frameIndex = m_Renderer->GetCurrentFrameIndex();
+		VulkanStagingRing::Get().BeginFrame(frameIndex);
+		VulkanGeometryPool::Get().BeginFrame();
+
+		VulkanAssetLoader::Get().ProcessUploads();
+		VulkanChunkStreamer::Get().ProcessLoads();
+		VulkanTextureStreamer::Get().ProcessUploads();
+
         m_Scene->UpdateGameObjectUboBuffers(frameIndex);
         m_Camera.Tick(deltaTime);
 
@@ -93,7 +144,7 @@ void Application::Run()
 		m_Renderer->Render(frameInfo);
     }
 
-	vkDeviceWaitIdle(VulkanContext::Get().Device());
+	VulkanContext::Get().WaitIdle();
 }
 
 void Application::OnEvent(Event& event)
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+enum class AssetStatus : uint32_t
+{
+    Loading = 0,
+    Ready,
+    Failed
+};
+
+// Shared reference to an asset that may still be loading. Until it resolves Get() returns the placeholder,
+// which may be null. Handles are cheap to copy and every copy sees the resolved asset.
+// Resolving happens once, on the thread that processes uploads, reading may happen anywhere.
+template<typename T>
+class AssetHandle
+{
+public:
+    AssetHandle() = default;
+
+    // A handle that is resolved from the start, lets loaded and streamed assets share one code path
+    AssetHandle(std::shared_ptr<T> asset)
+        : m_State(std::make_shared<State>())
+    {
+        m_State->Asset = std::move(asset);
+        m_State->Status.store(AssetStatus::Ready, std::memory_order_release);
+    }
+
+    static AssetHandle CreatePending(std::shared_ptr<T> placeholder)
+    {
+        AssetHandle handle{};
+        handle.m_State = std::make_shared<State>();
+        handle.m_State->Placeholder = std::move(placeholder);
+        return handle;
+    }
+
+    const std::shared_ptr<T>& Get() const
+    {
+        static const std::shared_ptr<T> empty{};
+        if (!m_State)
+            return empty;
+
+        return GetStatus() == AssetStatus::Ready ? m_State->Asset : m_State->Placeholder;
+    }
+
+    T* operator->() const { return Get().get(); }
+    explicit operator bool() const { return Get() != nullptr; }
+
+    AssetStatus GetStatus() const { return m_State ? m_State->Status.load(std::memory_order_acquire) : AssetStatus::Failed; }
+    bool IsReady() const { return GetStatus() == AssetStatus::Ready; }
+    bool HasFailed() const { return GetStatus() == AssetStatus::Failed; }
+
+    // Publishes the asset to every copy of the handle
+    void Resolve(std::shared_ptr<T> asset) const
+    {
+        m_State->Asset = std::move(asset);
+        m_State->Status.store(AssetStatus::Ready, std::memory_order_release);
+    }
+
+    // Keeps the placeholder for good
+    void Fail() const
+    {
+        m_State->Status.store(AssetStatus::Failed, std::memory_order_release);
+    }
+
+private:
+    struct State
+    {
+        // Written once before Status turns Ready, never touched after
+        std::shared_ptr<T> Asset;
+        std::shared_ptr<T> Placeholder;
+        std::atomic<AssetStatus> Status{AssetStatus::Loading};
+    };
+
+    std::shared_ptr<State> m_State;
+};
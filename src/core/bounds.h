@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Axis aligned box, empty until the first point is added
+struct BoundingBox
+{
+    glm::vec3 Min{std::numeric_limits<float>::max()};
+    glm::vec3 Max{std::numeric_limits<float>::lowest()};
+
+    bool IsEmpty() const { return Min.x > Max.x; }
+    glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+    glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+    void Expand(const glm::vec3& point)
+    {
+        Min = glm::min(Min, point);
+        Max = glm::max(Max, point);
+    }
+
+    void Expand(const BoundingBox& other)
+    {
+        Min = glm::min(Min, other.Min);
+        Max = glm::max(Max, other.Max);
+    }
+
+    // Arvo's method, the extents go through the absolute linear part so no corner has to be transformed
+    BoundingBox Transform(const glm::mat4& transform) const
+    {
+        if (IsEmpty())
+            return *this;
+
+        const glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+        const glm::mat3 linear{transform};
+        const glm::mat3 absolute{glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2])};
+        const glm::vec3 extents = absolute * GetExtents();
+        return {center - extents, center + extents};
+    }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 Center{0.0f};
+    float Radius = 0.0f;
+
+    // The radius grows by the largest axis scale, which keeps the sphere conservative under non-uniform scale
+    BoundingSphere Transform(const glm::mat4& transform) const
+    {
+        const float maxScale = std::sqrt(std::max({
+            glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+            glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+            glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))}));
+        return {glm::vec3(transform * glm::vec4(Center, 1.0f)), Radius * maxScale};
+    }
+};
+
+// Both volumes of a mesh, the box is tighter while the sphere is cheaper to test
+struct MeshBounds
+{
+    BoundingBox Box{};
+    BoundingSphere Sphere{};
+
+    MeshBounds Transform(const glm::mat4& transform) const
+    {
+        return {Box.Transform(transform), Sphere.Transform(transform)};
+    }
+};
+
+// Box around the points and a sphere centered on it. Not the minimal sphere, but it takes two passes and
+// is within a few percent of it for typical meshes. getPosition(i) returns the position of point i.
+template<typename GetPosition>
+MeshBounds ComputeMeshBounds(size_t count, GetPosition&& getPosition)
+{
+    MeshBounds bounds{};
+    if (count == 0)
+        return bounds;
+
+    for (size_t i = 0; i < count; i++)
+        bounds.Box.Expand(getPosition(i));
+
+    bounds.Sphere.Center = bounds.Box.GetCenter();
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        const glm::vec3 offset = getPosition(i) - bounds.Sphere.Center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    bounds.Sphere.Radius = std::sqrt(radiusSquared);
+    return bounds;
+}
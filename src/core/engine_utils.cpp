@@ -1,5 +1,6 @@
 #include "engine_utils.h"
 
+#include <filesystem>
 #include <vector>
 
 namespace EngineUtils
@@ -21,4 +22,17 @@ namespace EngineUtils
         file.close();
         return buffer;
     }
+
+    bool GetFileStamp(const std::string& filepath, uint64_t& size, int64_t& writeTime)
+    {
+        std::error_code ec;
+        size = std::filesystem::file_size(filepath, ec);
+        if (ec) return false;
+
+        auto time = std::filesystem::last_write_time(filepath, ec);
+        if (ec) return false;
+
+        writeTime = static_cast<int64_t>(time.time_since_epoch().count());
+        return true;
+    }
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <fstream>
 
@@ -14,5 +16,39 @@ namespace EngineUtils
         (HashCombine(seed, rest), ...);
     };
 
+    // Fast 64-bit hash over raw bytes, eight at a time with a murmur3 finalizer so every output bit
+    // depends on every input bit. Only meaningful for types without padding.
+    inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = seed ^ (size * 0x9E3779B97F4A7C15ull);
+
+        size_t offset = 0;
+        for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + offset, sizeof(uint64_t));
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+
+        if (offset < size)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + offset, size - offset);
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
     std::vector<char> ReadFile(const std::string &filepath);
+
+    // Size and last write time of a file, used to tell whether a cache built from it is stale
+    bool GetFileStamp(const std::string& filepath, uint64_t& size, int64_t& writeTime);
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Insert-only open addressing hash map with linear probing, meant for bulk passes like vertex welding.
+// Keys and values live in flat arrays next to a hash tag per slot, so probes compare full keys only when
+// the tags match and nothing is allocated per entry. Reserve the expected count up front to avoid rehashing.
+// Slots are picked from the low bits of the hash, so Hash must return well mixed 64-bit values
+// (see EngineUtils::HashBytes). Key and Value must be default constructible.
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+class FlatHashMap
+{
+public:
+    FlatHashMap() = default;
+    explicit FlatHashMap(size_t expectedCount) { Reserve(expectedCount); }
+
+    // Sizes the table so expectedCount entries stay below the maximum load factor
+    void Reserve(size_t expectedCount)
+    {
+        const size_t capacity = std::bit_ceil(std::max<size_t>(expectedCount * 2, MinCapacity));
+        if (capacity > m_Tags.size())
+            Rehash(capacity);
+    }
+
+    // Inserts when the key is missing. Returns the stored value and whether it was inserted.
+    // The pointer stays valid until the next insertion.
+    std::pair<Value*, bool> TryEmplace(const Key& key, const Value& value)
+    {
+        return TryEmplaceHashed(key, static_cast<uint64_t>(Hash{}(key)), value);
+    }
+
+    // Same as TryEmplace with a hash the caller already computed, which must equal Hash{}(key)
+    std::pair<Value*, bool> TryEmplaceHashed(const Key& key, uint64_t hash, const Value& value)
+    {
+        if ((m_Size + 1) * 2 > m_Tags.size())
+            Rehash(std::max(m_Tags.size() * 2, MinCapacity));
+
+        const uint32_t tag = MakeTag(hash);
+        const size_t mask = m_Tags.size() - 1;
+        for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask)
+        {
+            if (m_Tags[slot] == EmptyTag)
+            {
+                m_Tags[slot] = tag;
+                m_Keys[slot] = key;
+                m_Values[slot] = value;
+                m_Size++;
+                return {&m_Values[slot], true};
+            }
+
+            if (m_Tags[slot] == tag && Equal{}(m_Keys[slot], key))
+                return {&m_Values[slot], false};
+        }
+    }
+
+    Value* Find(const Key& key)
+    {
+        if (m_Size == 0)
+            return nullptr;
+
+        const uint64_t hash = static_cast<uint64_t>(Hash{}(key));
+        const uint32_t tag = MakeTag(hash);
+        const size_t mask = m_Tags.size() - 1;
+        for (size_t slot = static_cast<size_t>(hash) & mask; m_Tags[slot] != EmptyTag; slot = (slot + 1) & mask)
+        {
+            if (m_Tags[slot] == tag && Equal{}(m_Keys[slot], key))
+                return &m_Values[slot];
+        }
+        return nullptr;
+    }
+
+    size_t Size() const { return m_Size; }
+    bool Empty() const { return m_Size == 0; }
+
+    void Clear()
+    {
+        std::fill(m_Tags.begin(), m_Tags.end(), EmptyTag);
+        m_Size = 0;
+    }
+
+private:
+    static constexpr size_t MinCapacity = 16;
+    static constexpr uint32_t EmptyTag = 0;
+
+    // High bits of the hash, the slot index already covers the low ones. Never equal to EmptyTag.
+    static uint32_t MakeTag(uint64_t hash) { return static_cast<uint32_t>(hash >> 32) | 1u; }
+
+    void Rehash(size_t capacity)
+    {
+        std::vector<uint32_t> tags(capacity, EmptyTag);
+        std::vector<Key> keys(capacity);
+        std::vector<Value> values(capacity);
+
+        const size_t mask = capacity - 1;
+        for (size_t i = 0; i < m_Tags.size(); i++)
+        {
+            if (m_Tags[i] == EmptyTag)
+                continue;
+
+            size_t slot = static_cast<size_t>(Hash{}(m_Keys[i])) & mask;
+            while (tags[slot] != EmptyTag)
+                slot = (slot + 1) & mask;
+
+            tags[slot] = m_Tags[i];
+            keys[slot] = std::move(m_Keys[i]);
+            values[slot] = std::move(m_Values[i]);
+        }
+
+        m_Tags = std::move(tags);
+        m_Keys = std::move(keys);
+        m_Values = std::move(values);
+    }
+
+    std::vector<uint32_t> m_Tags;
+    std::vector<Key> m_Keys;
+    std::vector<Value> m_Values;
+    size_t m_Size = 0;
+};
@@ -4,6 +4,18 @@
 #include "scene.h"
 #include "vulkan/vulkan_context.h"
 
+namespace
+{
+    bool IsSameDescriptor(const VkDescriptorBufferInfo& a, const VkDescriptorBufferInfo& b)
+    {
+        return a.buffer == b.buffer && a.offset == b.offset && a.range == b.range;
+    }
+
+    bool IsSameDescriptor(const VkDescriptorImageInfo& a, const VkDescriptorImageInfo& b)
+    {
+        return a.sampler == b.sampler && a.imageView == b.imageView && a.imageLayout == b.imageLayout;
+    }
+}
 
 // Matrix corresponds to Translate * Ry * Rx * Rz * Scale
 // Rotations correspond to Tait-bryan angles of Y(1), X(2), Z(3)
@@ -70,48 +82,118 @@ glm::mat3 TransformComponent::NormalMatrix() const
   };
 }
 
-VkDescriptorBufferInfo GameObject::GetBufferInfo(int frameIndex)
+MeshBounds GameObject::GetWorldBounds() const
+{
+    if (StreamingModel)
+        return StreamingModel->GetBounds().Transform(m_Transform.Mat4());
+    if (ObjectModel)
+        return ObjectModel->GetBounds().Transform(m_Transform.Mat4());
+    return {};
+}
+
+VkDescriptorBufferInfo GameObject::GetBufferInfo(int frameIndex) const
+{
+    return m_Scene.GetGameObjectBufferInfo(frameIndex);
+}
+
+uint32_t GameObject::GetDynamicOffset() const
+{
+    return m_Scene.GetDynamicOffsetForGameObject(m_Id);
+}
+
+void GameObject::SetTransform(const TransformComponent& transform)
+{
+    m_Transform = transform;
+    MarkDirty();
+}
+
+void GameObject::MarkDirty()
 {
-    return m_Scene.GetBufferInfoForGameObject(frameIndex, m_Id);
+    m_Scene.MarkGameObjectDirty(m_Id);
 }
 
-void GameObject::Render(VkCommandBuffer cmd, uint32_t frameIndex, VkDescriptorBufferInfo globalUboInfo)
+void GameObject::Render(VkCommandBuffer cmd, uint32_t frameIndex, VkDescriptorBufferInfo globalUboInfo, const RenderView& view)
 {
-    Material->UpdateDescriptorSets(frameIndex,
+    // Streaming textures load the levels needed for the object's on-screen diameter
+    const BoundingSphere worldSphere = GetWorldBounds().Sphere;
+    const float sphereDistance = glm::max(glm::length(worldSphere.Center - view.CameraPosition) - worldSphere.Radius, 0.001f);
+    const float screenSize = 2.0f * worldSphere.Radius * view.LodScale / sphereDistance;
+    DiffuseMap->RequestResidency(screenSize);
+    NormalMap->RequestResidency(screenSize);
+
+    // The sets only change when a texture resolves or streams in a level, most draws skip the writes
+    const VkDescriptorBufferInfo objectUboInfo = GetBufferInfo(frameIndex);
+    const VkDescriptorImageInfo diffuseMapInfo = DiffuseMap->GetBaseViewDescriptorInfo();
+    const VkDescriptorImageInfo normalMapInfo = NormalMap->GetBaseViewDescriptorInfo();
+    WrittenDescriptors& written = m_WrittenDescriptors[frameIndex];
+    if (written.Material != Material.get() || !IsSameDescriptor(written.GlobalUbo, globalUboInfo) ||
+        !IsSameDescriptor(written.ObjectUbo, objectUboInfo) || !IsSameDescriptor(written.DiffuseMap, diffuseMapInfo) ||
+        !IsSameDescriptor(written.NormalMap, normalMapInfo))
     {
-       {0,
-           {
+        Material->UpdateDescriptorSets(frameIndex,
+        {
+           {0,
                {
-                   .binding = 0,
-                   .type = DescriptorUpdate::Type::Buffer,
-                   .bufferInfo =  globalUboInfo
+                   {
+                       .binding = 0,
+                       .type = DescriptorUpdate::Type::Buffer,
+                       .bufferInfo =  globalUboInfo
+                   }
                }
-           }
-       },
-       {1,
-            {
-               {
-                   .binding = 0,
-                   .type = DescriptorUpdate::Type::Buffer,
-                   .bufferInfo = GetBufferInfo(frameIndex)
-               },
-               {
-                   .binding = 1,
-                   .type = DescriptorUpdate::Type::Image,
-                   .imageInfo = DiffuseMap->GetBaseViewDescriptorInfo()
-               },
-               {
-                   .binding = 2,
-                   .type = DescriptorUpdate::Type::Image,
-                   .imageInfo = NormalMap->GetBaseViewDescriptorInfo()
+           },
+           {1,
+                {
+                   {
+                       .binding = 0,
+                       .type = DescriptorUpdate::Type::Buffer,
+                       .bufferInfo = objectUboInfo
+                   },
+                   {
+                       .binding = 1,
+                       .type = DescriptorUpdate::Type::Image,
+                       .imageInfo = diffuseMapInfo
+                   },
+                   {
+                       .binding = 2,
+                       .type = DescriptorUpdate::Type::Image,
+                       .imageInfo = normalMapInfo
+                   }
                }
            }
-       }
-   });
+       });
+        written = {Material.get(), globalUboInfo, objectUboInfo, diffuseMapInfo, normalMapInfo};
+    }
 
-    Material->BindDescriptors(frameIndex, cmd, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    Material->BindDescriptors(frameIndex, cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, {GetDynamicOffset()});
     Material->BindPushConstants(cmd);
-    ObjectModel->BindVertexInput(cmd);
-    ObjectModel->Draw(cmd);
+
+    if (StreamingModel)
+    {
+        const glm::vec3 viewerPosition = glm::vec3(glm::inverse(m_Transform.Mat4()) * glm::vec4(view.CameraPosition, 1.0f));
+        StreamingModel->RequestChunks(viewerPosition);
+        StreamingModel->Draw(cmd);
+        return;
+    }
+
+    const glm::vec3& scale = m_Transform.Scale;
+    if (ObjectModel->GetLodCount() > 1)
+    {
+        // Distance to the closest point of the bounding sphere, clamped so the camera inside the bounds picks LOD 0
+        const BoundingSphere sphere = ObjectModel->GetBounds().Sphere.Transform(m_Transform.Mat4());
+        const float maxScale = glm::max(glm::abs(scale.x), glm::max(glm::abs(scale.y), glm::abs(scale.z)));
+        const float distance = glm::max(glm::length(sphere.Center - view.CameraPosition) - sphere.Radius, 0.001f);
+        CurrentLod = ObjectModel->SelectLod(CurrentLod, view.LodScale * maxScale / distance);
+    }
+
+    // Meshlet cones are tested in object space, which only preserves angles under uniform positive scale
+    if (CurrentLod == 0 && ObjectModel->HasMeshlets() && scale.x > 0.0f && scale.x == scale.y && scale.x == scale.z)
+    {
+        const glm::vec3 viewerPosition = glm::vec3(glm::inverse(m_Transform.Mat4()) * glm::vec4(view.CameraPosition, 1.0f));
+        ObjectModel->DrawMeshlets(cmd, viewerPosition);
+    }
+    else
+    {
+        ObjectModel->Draw(cmd, CurrentLod);
+    }
 }
 
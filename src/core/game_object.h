@@ -1,10 +1,13 @@
 #pragma once
 
+#include "core/asset_handle.h"
 #include "vulkan/vulkan_model.h"
+#include "vulkan/vulkan_streaming_model.h"
 #include "vulkan/vulkan_swapchain.h"
 #include "vulkan/vulkan_material.h"
 #include "vulkan/vulkan_texture.h"
 
+#include <array>
 #include <memory>
 #include <unordered_map>
 #include <glm/gtc/matrix_transform.hpp>
@@ -31,6 +34,17 @@ struct GameObjectBufferData
 {
     glm::mat4 ModelMatrix{1.0f};
     glm::mat4 NormalMatrix{1.0f};
+    // Dequantization for packed vertex positions, identity for standard vertices
+    glm::vec4 PositionOffset{0.0f};
+    glm::vec4 PositionScale{1.0f};
+};
+
+// Per-view data used while recording draws to cull meshlets and pick levels of detail
+struct RenderView
+{
+    glm::vec3 CameraPosition{0.0f};
+    // Screen pixels covered by one world unit at a distance of one
+    float LodScale = 1.0f;
 };
 
 class GameObject
@@ -44,28 +58,56 @@ public:
     GameObject(GameObject&&) = default;
     GameObject&operator=(GameObject &&) = delete;
 
-    void Render(VkCommandBuffer cmd, uint32_t frameIndex, VkDescriptorBufferInfo globalUboInfo);
+    // Geometry is bound by the caller, see VulkanModel::GetGeometryBinding
+    void Render(VkCommandBuffer cmd, uint32_t frameIndex, VkDescriptorBufferInfo globalUboInfo, const RenderView& view);
 
     id_t GetId() const { return m_Id; }
 
-    VkDescriptorBufferInfo GetBufferInfo(int frameIndex);
+    // World space bounds of the model under its transform, empty while the model is still loading
+    MeshBounds GetWorldBounds() const;
+
+    // Shared by every object of the scene, see GetDynamicOffset
+    VkDescriptorBufferInfo GetBufferInfo(int frameIndex) const;
+    uint32_t GetDynamicOffset() const;
+
+    const TransformComponent& GetTransform() const { return m_Transform; }
+    // Transforms only reach the per-object uniform buffers through here, see Scene::UpdateGameObjectUboBuffers
+    void SetTransform(const TransformComponent& transform);
+    // Rewrites the uniform data without a new transform, needed after replacing the model of a live object
+    void MarkDirty();
 
     glm::vec3 Color{};
-    TransformComponent ObjectTransform{};
 
     std::shared_ptr<VulkanMaterial> Material = nullptr;
-    std::shared_ptr<VulkanTexture2D> DiffuseMap = nullptr;
-    std::shared_ptr<VulkanTexture2D> NormalMap = nullptr;
-    std::shared_ptr<VulkanModel> ObjectModel = nullptr;
+    // Asynchronously loaded assets resolve in place, see VulkanAssetLoader
+    AssetHandle<VulkanTexture2D> DiffuseMap{};
+    AssetHandle<VulkanTexture2D> NormalMap{};
+    AssetHandle<VulkanModel> ObjectModel{};
+    // Drawn instead of ObjectModel when set, binds its own geometry per resident chunk
+    std::shared_ptr<VulkanStreamingModel> StreamingModel = nullptr;
     std::unique_ptr<PointLightComponent> PointLightComp = nullptr;
+    // Level of detail drawn last frame, the starting point for hysteresis
+    uint32_t CurrentLod = 0;
 
 private:
 
-    explicit GameObject(id_t objectId, const Scene& gameObjectManager )
+    explicit GameObject(id_t objectId, Scene& gameObjectManager )
         : m_Id(objectId), m_Scene(gameObjectManager) { }
 
+    // Descriptors last written to the material's sets of a frame, so draws only write the ones that changed
+    struct WrittenDescriptors
+    {
+        const VulkanMaterial* Material = nullptr;
+        VkDescriptorBufferInfo GlobalUbo{};
+        VkDescriptorBufferInfo ObjectUbo{};
+        VkDescriptorImageInfo DiffuseMap{};
+        VkDescriptorImageInfo NormalMap{};
+    };
+
     id_t m_Id;
-    const Scene& m_Scene;
+    Scene& m_Scene;
+    TransformComponent m_Transform{};
+    std::array<WrittenDescriptors, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT> m_WrittenDescriptors{};
 
     friend class Scene;
 };
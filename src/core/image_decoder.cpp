@@ -0,0 +1,103 @@
+#include "image_decoder.h"
+#include "thread_pool.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    std::string GetFailureReason()
+    {
+        const char* reason = stbi_failure_reason();
+        return reason ? reason : "unknown error";
+    }
+
+    template<typename LoadHdr, typename LoadLdr>
+    ImageDecoder::DecodedImage Decode(bool isHdr, bool flipVertically, LoadHdr&& loadHdr, LoadLdr&& loadLdr)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // Only this thread's decodes see the flag
+        stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+
+        int width = 0, height = 0, channels = 0;
+        ImageDecoder::DecodedImage image{};
+        image.IsHDR = isHdr;
+        if (isHdr)
+            image.Pixels.reset(loadHdr(&width, &height, &channels));
+        else
+            image.Pixels.reset(loadLdr(&width, &height, &channels));
+
+        if (!image.Pixels)
+            return image;
+
+        image.Width = static_cast<uint32_t>(width);
+        image.Height = static_cast<uint32_t>(height);
+        image.DecodeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return image;
+    }
+}
+
+namespace ImageDecoder
+{
+    void PixelDeleter::operator()(void* pixels) const
+    {
+        stbi_image_free(pixels);
+    }
+
+    bool IsEncodedImage(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const stbi_uc*>(data);
+        return stbi_is_hdr_from_memory(bytes, static_cast<int>(size)) ||
+               stbi_info_from_memory(bytes, static_cast<int>(size), nullptr, nullptr, nullptr);
+    }
+
+    DecodedImage DecodeFile(const std::string& filepath, bool flipVertically)
+    {
+        const char* path = filepath.c_str();
+        DecodedImage image = Decode(stbi_is_hdr(path), flipVertically,
+            [path](int* w, int* h, int* c) { return stbi_loadf(path, w, h, c, 4); },
+            [path](int* w, int* h, int* c) { return stbi_load(path, w, h, c, 4); });
+
+        if (!image.IsValid())
+            throw std::runtime_error("Failed to load image: " + filepath + " (" + GetFailureReason() + ")");
+        return image;
+    }
+
+    DecodedImage DecodeMemory(const void* data, size_t size, bool flipVertically)
+    {
+        const auto* bytes = static_cast<const stbi_uc*>(data);
+        const int length = static_cast<int>(size);
+        DecodedImage image = Decode(stbi_is_hdr_from_memory(bytes, length), flipVertically,
+            [bytes, length](int* w, int* h, int* c) { return stbi_loadf_from_memory(bytes, length, w, h, c, 4); },
+            [bytes, length](int* w, int* h, int* c) { return stbi_load_from_memory(bytes, length, w, h, c, 4); });
+
+        if (!image.IsValid())
+            throw std::runtime_error("Failed to load image from memory (" + GetFailureReason() + ")");
+        return image;
+    }
+
+    std::vector<DecodedImage> DecodeFiles(const std::vector<std::string>& filepaths, bool flipVertically)
+    {
+        std::vector<DecodedImage> images(filepaths.size());
+        ThreadPool::Get().ParallelFor(filepaths.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                try
+                {
+                    images[i] = DecodeFile(filepaths[i], flipVertically);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << e.what() << "\n";
+                }
+            }
+        });
+        return images;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Decodes JPG/PNG/HDR and the other formats stb_image reads. Every call is thread safe, the vertical flip is
+// set per call through stb's thread local flag instead of its global one, so any number of decodes can run
+// on the thread pool at once.
+namespace ImageDecoder
+{
+    struct PixelDeleter
+    {
+        void operator()(void* pixels) const;
+    };
+
+    struct DecodedImage
+    {
+        // Tightly packed RGBA, 8 bits per channel or 32 bit floats for HDR sources. Null if decoding failed.
+        std::unique_ptr<void, PixelDeleter> Pixels;
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        bool IsHDR = false;
+        double DecodeMilliseconds = 0.0;
+
+        bool IsValid() const { return Pixels != nullptr; }
+        size_t GetSize() const { return static_cast<size_t>(Width) * Height * 4 * (IsHDR ? sizeof(float) : sizeof(uint8_t)); }
+        const uint8_t* Data() const { return static_cast<const uint8_t*>(Pixels.get()); }
+    };
+
+    // True if the bytes hold an image stb can decode, as opposed to raw pixels
+    bool IsEncodedImage(const void* data, size_t size);
+
+    // Both throw std::runtime_error when the image can't be decoded
+    DecodedImage DecodeFile(const std::string& filepath, bool flipVertically = true);
+    DecodedImage DecodeMemory(const void* data, size_t size, bool flipVertically = true);
+
+    // Decodes every file across the thread pool, results are in input order. Failures are logged and left invalid.
+    std::vector<DecodedImage> DecodeFiles(const std::vector<std::string>& filepaths, bool flipVertically = true);
+}
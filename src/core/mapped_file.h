@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the object.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filePath) { Open(filePath); }
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::string& filePath);
+    void Close();
+
+    bool IsOpen() const { return m_Data != nullptr; }
+    const uint8_t* Data() const { return m_Data; }
+    size_t Size() const { return m_Size; }
+
+    template<typename T>
+    const T* As(size_t offset = 0) const { return reinterpret_cast<const T*>(m_Data + offset); }
+
+private:
+    void Swap(MappedFile& other) noexcept;
+
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+
+#if defined(_WIN32)
+    void* m_FileHandle = nullptr;
+    void* m_MappingHandle = nullptr;
+#endif
+};
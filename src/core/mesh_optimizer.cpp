@@ -0,0 +1,770 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+    // Forsyth scoring parameters, see "Linear-Speed Vertex Cache Optimisation"
+    constexpr uint32_t ForsythCacheSize = 32;
+    constexpr float CacheDecayPower = 1.5f;
+    constexpr float LastTriangleScore = 0.75f;
+    constexpr float ValenceBoostScale = 2.0f;
+    constexpr float ValenceBoostPower = 0.5f;
+
+    constexpr uint32_t InvalidIndex = ~0u;
+
+    // Normal cones wider than this (dot product against the axis) are not worth testing
+    constexpr float MinimumConeSpread = 0.1f;
+
+    // Collapses that turn a triangle normal by more than ~75 degrees are treated as flips
+    constexpr float MinimumFlipCosine = 0.25f;
+
+    // Symmetric 4x4 plane quadric, normalized by the accumulated area so errors are squared distances
+    struct Quadric
+    {
+        double A00 = 0, A01 = 0, A02 = 0, A03 = 0;
+        double A11 = 0, A12 = 0, A13 = 0;
+        double A22 = 0, A23 = 0;
+        double A33 = 0;
+        double Weight = 0;
+
+        void AddPlane(const glm::vec3& normal, float distance, float weight)
+        {
+            const double a = normal.x, b = normal.y, c = normal.z, d = distance, w = weight;
+            A00 += w * a * a; A01 += w * a * b; A02 += w * a * c; A03 += w * a * d;
+            A11 += w * b * b; A12 += w * b * c; A13 += w * b * d;
+            A22 += w * c * c; A23 += w * c * d;
+            A33 += w * d * d;
+            Weight += w;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            A00 += other.A00; A01 += other.A01; A02 += other.A02; A03 += other.A03;
+            A11 += other.A11; A12 += other.A12; A13 += other.A13;
+            A22 += other.A22; A23 += other.A23;
+            A33 += other.A33;
+            Weight += other.Weight;
+            return *this;
+        }
+
+        float Evaluate(const glm::vec3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            const double error =
+                A00 * x * x + 2 * A01 * x * y + 2 * A02 * x * z + 2 * A03 * x +
+                A11 * y * y + 2 * A12 * y * z + 2 * A13 * y +
+                A22 * z * z + 2 * A23 * z +
+                A33;
+            return Weight > 0 ? static_cast<float>(std::max(0.0, error / Weight)) : 0.0f;
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t From;
+        uint32_t To;
+        float Error;
+    };
+
+    float ForsythVertexScore(int32_t cachePosition, uint32_t remainingValence)
+    {
+        if (remainingValence == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                score = LastTriangleScore;
+            }
+            else
+            {
+                const float scaler = 1.0f / static_cast<float>(ForsythCacheSize - 3);
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CacheDecayPower);
+            }
+        }
+
+        score += ValenceBoostScale * std::pow(static_cast<float>(remainingValence), -ValenceBoostPower);
+        return score;
+    }
+
+    struct TriangleAdjacency
+    {
+        std::vector<uint32_t> Offsets;
+        std::vector<uint32_t> Counts;
+        std::vector<uint32_t> Triangles;
+    };
+
+    TriangleAdjacency BuildAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        TriangleAdjacency adjacency{};
+        adjacency.Offsets.assign(vertexCount + 1, 0);
+        adjacency.Counts.assign(vertexCount, 0);
+        adjacency.Triangles.resize(indices.size());
+
+        for (uint32_t index : indices)
+            adjacency.Counts[index]++;
+
+        for (size_t v = 0; v < vertexCount; v++)
+            adjacency.Offsets[v + 1] = adjacency.Offsets[v] + adjacency.Counts[v];
+
+        std::vector<uint32_t> fill(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency.Triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+        return adjacency;
+    }
+}
+
+namespace MeshOptimizer
+{
+    VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+    {
+        VertexCacheStatistics statistics{};
+        if (indices.empty()) return statistics;
+
+        // FIFO simulated with timestamps: a vertex is resident if it was inserted less than cacheSize misses ago
+        std::vector<uint32_t> insertedAt(vertexCount, 0);
+        std::vector<bool> referenced(vertexCount, false);
+        uint32_t timestamp = cacheSize + 1;
+        size_t referencedCount = 0;
+
+        for (uint32_t index : indices)
+        {
+            if (timestamp - insertedAt[index] > cacheSize)
+            {
+                insertedAt[index] = timestamp++;
+                statistics.VerticesTransformed++;
+            }
+
+            if (!referenced[index])
+            {
+                referenced[index] = true;
+                referencedCount++;
+            }
+        }
+
+        statistics.ACMR = static_cast<float>(statistics.VerticesTransformed) / static_cast<float>(indices.size() / 3);
+        statistics.ATVR = static_cast<float>(statistics.VerticesTransformed) / static_cast<float>(referencedCount);
+        return statistics;
+    }
+
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) return;
+
+        TriangleAdjacency adjacency = BuildAdjacency(indices, vertexCount);
+
+        std::vector<uint32_t> remainingValence = adjacency.Counts;
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            vertexScores[v] = ForsythVertexScore(-1, remainingValence[v]);
+
+        std::vector<float> triangleScores(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++)
+            triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        uint32_t cache[ForsythCacheSize + 3];
+        uint32_t cacheCount = 0;
+        size_t scanCursor = 0;
+
+        uint32_t bestTriangle = 0;
+        float bestScore = triangleScores[0];
+        for (size_t t = 1; t < triangleCount; t++)
+        {
+            if (triangleScores[t] > bestScore)
+            {
+                bestScore = triangleScores[t];
+                bestTriangle = static_cast<uint32_t>(t);
+            }
+        }
+
+        for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            if (bestTriangle == InvalidIndex)
+            {
+                // Nothing adjacent to the cache is left, continue with the next triangle in input order
+                while (emitted[scanCursor]) scanCursor++;
+                bestTriangle = static_cast<uint32_t>(scanCursor);
+            }
+
+            const uint32_t* triangle = &indices[bestTriangle * 3];
+            result.insert(result.end(), triangle, triangle + 3);
+            emitted[bestTriangle] = true;
+
+            // Remove the triangle from its vertices' live lists
+            for (int i = 0; i < 3; i++)
+            {
+                uint32_t v = triangle[i];
+                uint32_t* begin = &adjacency.Triangles[adjacency.Offsets[v]];
+                uint32_t* end = begin + remainingValence[v];
+                uint32_t* found = std::find(begin, end, bestTriangle);
+                std::swap(*found, *(end - 1));
+                remainingValence[v]--;
+            }
+
+            // Move the triangle's vertices to the front of the LRU cache
+            uint32_t newCache[ForsythCacheSize + 3];
+            uint32_t newCacheCount = 0;
+            for (int i = 0; i < 3; i++)
+                newCache[newCacheCount++] = triangle[i];
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                    newCache[newCacheCount++] = v;
+            }
+
+            // Vertices pushed out of the cache lose their cache bonus
+            for (uint32_t i = ForsythCacheSize; i < newCacheCount; i++)
+            {
+                uint32_t v = newCache[i];
+                cachePosition[v] = -1;
+                vertexScores[v] = ForsythVertexScore(-1, remainingValence[v]);
+            }
+
+            cacheCount = std::min(newCacheCount, ForsythCacheSize);
+            std::memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                cachePosition[v] = static_cast<int32_t>(i);
+                vertexScores[v] = ForsythVertexScore(static_cast<int32_t>(i), remainingValence[v]);
+            }
+
+            // Rescore the triangles touching the cache and pick the best one for the next step
+            bestTriangle = InvalidIndex;
+            bestScore = -1.0f;
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                const uint32_t* liveTriangles = &adjacency.Triangles[adjacency.Offsets[v]];
+                for (uint32_t j = 0; j < remainingValence[v]; j++)
+                {
+                    uint32_t t = liveTriangles[j];
+                    float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                    triangleScores[t] = score;
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        bestTriangle = t;
+                    }
+                }
+            }
+
+            // Vertices that just left the cache may still have triangles with a changed score
+            for (uint32_t i = ForsythCacheSize; i < newCacheCount; i++)
+            {
+                uint32_t v = newCache[i];
+                const uint32_t* liveTriangles = &adjacency.Triangles[adjacency.Offsets[v]];
+                for (uint32_t j = 0; j < remainingValence[v]; j++)
+                {
+                    uint32_t t = liveTriangles[j];
+                    triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                }
+            }
+        }
+
+        indices.swap(result);
+    }
+
+    void OptimizeOverdraw(std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t vertexStride, uint32_t cacheSize)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2) return;
+
+        auto position = [vertices, vertexStride](uint32_t index)
+        {
+            return reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertices) + index * vertexStride);
+        };
+
+        // A triangle whose three vertices all miss the cache starts a new cluster, reordering whole
+        // clusters then costs at most one extra cache flush per boundary.
+        std::vector<uint32_t> clusterStarts;
+        {
+            std::vector<uint32_t> insertedAt(vertexCount, 0);
+            uint32_t timestamp = cacheSize + 1;
+
+            for (size_t t = 0; t < triangleCount; t++)
+            {
+                uint32_t misses = 0;
+                for (int i = 0; i < 3; i++)
+                {
+                    uint32_t index = indices[t * 3 + i];
+                    if (timestamp - insertedAt[index] > cacheSize)
+                    {
+                        insertedAt[index] = timestamp++;
+                        misses++;
+                    }
+                }
+
+                if (t == 0 || misses == 3)
+                    clusterStarts.push_back(static_cast<uint32_t>(t));
+            }
+        }
+
+        const size_t clusterCount = clusterStarts.size();
+        if (clusterCount < 2) return;
+        clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+        struct ClusterInfo
+        {
+            float Centroid[3];
+            float Normal[3];
+            float Area;
+        };
+
+        std::vector<ClusterInfo> clusters(clusterCount);
+        float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+        float meshArea = 0.0f;
+
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            ClusterInfo info{};
+            for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+            {
+                const float* p0 = position(indices[t * 3]);
+                const float* p1 = position(indices[t * 3 + 1]);
+                const float* p2 = position(indices[t * 3 + 2]);
+
+                float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                float normal[3] =
+                {
+                    e1[1] * e2[2] - e1[2] * e2[1],
+                    e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0]
+                };
+                // Cross product length is twice the area, the factor cancels out in the weighted averages
+                float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+                for (int k = 0; k < 3; k++)
+                {
+                    info.Centroid[k] += (p0[k] + p1[k] + p2[k]) * (area / 3.0f);
+                    info.Normal[k] += normal[k];
+                }
+                info.Area += area;
+            }
+
+            for (int k = 0; k < 3; k++)
+                meshCentroid[k] += info.Centroid[k];
+            meshArea += info.Area;
+
+            if (info.Area > 0.0f)
+            {
+                for (float& component : info.Centroid)
+                    component /= info.Area;
+            }
+
+            float normalLength = std::sqrt(info.Normal[0] * info.Normal[0] + info.Normal[1] * info.Normal[1] + info.Normal[2] * info.Normal[2]);
+            if (normalLength > 0.0f)
+            {
+                for (float& component : info.Normal)
+                    component /= normalLength;
+            }
+
+            clusters[c] = info;
+        }
+
+        if (meshArea > 0.0f)
+        {
+            for (float& component : meshCentroid)
+                component /= meshArea;
+        }
+
+        // Clusters that face away from the mesh center are likely in front of the others, draw them first
+        std::vector<float> sortKeys(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            const ClusterInfo& info = clusters[c];
+            sortKeys[c] =
+                (info.Centroid[0] - meshCentroid[0]) * info.Normal[0] +
+                (info.Centroid[1] - meshCentroid[1]) * info.Normal[1] +
+                (info.Centroid[2] - meshCentroid[2]) * info.Normal[2];
+        }
+
+        std::vector<uint32_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t c : order)
+        {
+            result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+        }
+
+        indices.swap(result);
+    }
+
+    size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexStride, std::vector<uint32_t>& indices)
+    {
+        std::vector<uint32_t> remap(vertexCount, InvalidIndex);
+        uint32_t nextVertex = 0;
+
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == InvalidIndex)
+                remap[index] = nextVertex++;
+            index = remap[index];
+        }
+
+        auto* bytes = static_cast<uint8_t*>(vertices);
+        std::vector<uint8_t> reordered(static_cast<size_t>(nextVertex) * vertexStride);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            if (remap[v] != InvalidIndex)
+                std::memcpy(&reordered[remap[v] * vertexStride], bytes + v * vertexStride, vertexStride);
+        }
+
+        std::memcpy(bytes, reordered.data(), reordered.size());
+        return nextVertex;
+    }
+
+    std::vector<Meshlet> BuildMeshlets(const std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t vertexStride,
+                                       uint32_t maxVertices, uint32_t maxTriangles)
+    {
+        auto position = [vertices, vertexStride](uint32_t index)
+        {
+            const auto* p = reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertices) + index * vertexStride);
+            return glm::vec3{p[0], p[1], p[2]};
+        };
+
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> lastMeshlet(vertexCount, InvalidIndex);
+        std::vector<glm::vec3> points;
+        points.reserve(maxVertices);
+
+        auto finishMeshlet = [&](Meshlet& meshlet)
+        {
+            // Ritter's bounding sphere over the unique vertices
+            glm::vec3 a = points[0];
+            glm::vec3 b = a;
+            float farthest = -1.0f;
+            for (const glm::vec3& p : points)
+            {
+                const float d = glm::dot(p - a, p - a);
+                if (d > farthest) { farthest = d; b = p; }
+            }
+            glm::vec3 c = b;
+            farthest = -1.0f;
+            for (const glm::vec3& p : points)
+            {
+                const float d = glm::dot(p - b, p - b);
+                if (d > farthest) { farthest = d; c = p; }
+            }
+
+            glm::vec3 center = (b + c) * 0.5f;
+            float radius = glm::length(c - b) * 0.5f;
+            for (const glm::vec3& p : points)
+            {
+                const float d = glm::length(p - center);
+                if (d > radius)
+                {
+                    const float newRadius = (radius + d) * 0.5f;
+                    center += (p - center) * ((newRadius - radius) / d);
+                    radius = newRadius;
+                }
+            }
+            meshlet.Center = center;
+            meshlet.Radius = radius;
+
+            // Normal cone around the average triangle normal, degenerate triangles don't constrain it
+            glm::vec3 normalSum{0.0f};
+            for (uint32_t i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndexCount; i += 3)
+            {
+                const glm::vec3 p0 = position(indices[i]);
+                const glm::vec3 normal = glm::cross(position(indices[i + 1]) - p0, position(indices[i + 2]) - p0);
+                const float area = glm::length(normal);
+                if (area > 0.0f)
+                    normalSum += normal / area;
+            }
+
+            const float sumLength = glm::length(normalSum);
+            if (sumLength > 0.0f)
+            {
+                const glm::vec3 axis = normalSum / sumLength;
+                float minimumDot = 1.0f;
+                for (uint32_t i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndexCount; i += 3)
+                {
+                    const glm::vec3 p0 = position(indices[i]);
+                    const glm::vec3 normal = glm::cross(position(indices[i + 1]) - p0, position(indices[i + 2]) - p0);
+                    const float area = glm::length(normal);
+                    if (area > 0.0f)
+                        minimumDot = std::min(minimumDot, glm::dot(normal / area, axis));
+                }
+
+                meshlet.ConeAxis = axis;
+                meshlet.ConeCutoff = minimumDot <= MinimumConeSpread ? 1.0f : std::sqrt(1.0f - minimumDot * minimumDot);
+            }
+
+            meshlets.push_back(meshlet);
+            points.clear();
+        };
+
+        Meshlet current{};
+        for (uint32_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+            uint32_t newVertices = 0;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                const uint32_t v = indices[i + k];
+                // Count repeated corners of the same triangle once
+                const bool repeated = (k > 0 && indices[i] == v) || (k > 1 && indices[i + 1] == v);
+                if (lastMeshlet[v] != meshletId && !repeated)
+                    newVertices++;
+            }
+
+            if (current.IndexCount > 0 &&
+                (current.VertexCount + newVertices > maxVertices || current.IndexCount / 3 + 1 > maxTriangles))
+            {
+                finishMeshlet(current);
+                current = Meshlet{};
+                current.FirstIndex = i;
+            }
+
+            const uint32_t currentId = static_cast<uint32_t>(meshlets.size());
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                const uint32_t v = indices[i + k];
+                if (lastMeshlet[v] != currentId)
+                {
+                    lastMeshlet[v] = currentId;
+                    points.push_back(position(v));
+                    current.VertexCount++;
+                }
+            }
+            current.IndexCount += 3;
+        }
+
+        if (current.IndexCount > 0)
+            finishMeshlet(current);
+
+        return meshlets;
+    }
+
+    bool IsMeshletBackfacing(const Meshlet& meshlet, const glm::vec3& viewerPosition)
+    {
+        // Conservative cone test against the whole bounding sphere
+        const glm::vec3 toCenter = meshlet.Center - viewerPosition;
+        return glm::dot(toCenter, meshlet.ConeAxis) >= meshlet.ConeCutoff * glm::length(toCenter) + meshlet.Radius;
+    }
+
+    std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t vertexStride,
+                                   size_t targetIndexCount, float maxError, float* resultError)
+    {
+        auto position = [vertices, vertexStride](uint32_t index)
+        {
+            const auto* p = reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertices) + index * vertexStride);
+            return glm::vec3{p[0], p[1], p[2]};
+        };
+
+        // Weld vertices by position, vertices that share a position with others sit on an attribute seam
+        std::vector<uint32_t> sorted(vertexCount);
+        std::iota(sorted.begin(), sorted.end(), 0);
+        auto lessPosition = [&](uint32_t a, uint32_t b)
+        {
+            const glm::vec3 pa = position(a), pb = position(b);
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            return pa.z < pb.z;
+        };
+        std::sort(sorted.begin(), sorted.end(), lessPosition);
+
+        std::vector<uint32_t> welded(vertexCount);
+        std::vector<uint8_t> seam(vertexCount, 0);
+        std::vector<uint8_t> locked(vertexCount, 0);
+        for (size_t begin = 0; begin < vertexCount;)
+        {
+            size_t end = begin + 1;
+            while (end < vertexCount && position(sorted[end]) == position(sorted[begin]))
+                end++;
+
+            for (size_t i = begin; i < end; i++)
+            {
+                welded[sorted[i]] = sorted[begin];
+                seam[sorted[i]] = locked[sorted[i]] = end - begin > 1;
+            }
+            begin = end;
+        }
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if (welded[a] != welded[b] && welded[b] != welded[c] && welded[a] != welded[c])
+                result.insert(result.end(), {a, b, c});
+        }
+
+        // Border and non-manifold edges of the welded topology keep their vertices in place
+        {
+            std::vector<uint64_t> edges;
+            edges.reserve(result.size());
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const uint32_t a = welded[result[i + k]];
+                    const uint32_t b = welded[result[i + (k + 1) % 3]];
+                    edges.push_back(static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            for (size_t begin = 0; begin < edges.size();)
+            {
+                size_t end = begin + 1;
+                while (end < edges.size() && edges[end] == edges[begin])
+                    end++;
+
+                if (end - begin != 2)
+                {
+                    locked[static_cast<uint32_t>(edges[begin] >> 32)] = 1;
+                    locked[static_cast<uint32_t>(edges[begin] & 0xFFFFFFFFu)] = 1;
+                }
+                begin = end;
+            }
+
+            // Welded representatives carry the lock for the whole group
+            for (size_t v = 0; v < vertexCount; v++)
+                locked[v] |= locked[welded[v]];
+        }
+
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const glm::vec3 p0 = position(result[i]);
+            const glm::vec3 normal = glm::cross(position(result[i + 1]) - p0, position(result[i + 2]) - p0);
+            const float area = glm::length(normal);
+            if (area <= 0.0f)
+                continue;
+
+            const glm::vec3 unitNormal = normal / area;
+            for (uint32_t k = 0; k < 3; k++)
+                quadrics[result[i + k]].AddPlane(unitNormal, -glm::dot(unitNormal, p0), area);
+        }
+
+        const float maxErrorSquared = maxError * maxError;
+        float largestError = 0.0f;
+        targetIndexCount -= targetIndexCount % 3;
+
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+        std::vector<Collapse> collapses;
+
+        while (result.size() > targetIndexCount)
+        {
+            TriangleAdjacency adjacency = BuildAdjacency(result, vertexCount);
+
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const uint32_t a = result[i + k];
+                    const uint32_t b = result[i + (k + 1) % 3];
+                    // Only unlocked vertices move, and only onto vertices without seams so attributes stay intact
+                    if (!locked[a] && !seam[b])
+                    {
+                        Quadric quadric = quadrics[a];
+                        quadric += quadrics[b];
+                        collapses.push_back({a, b, quadric.Evaluate(position(b))});
+                    }
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+            std::iota(remap.begin(), remap.end(), 0);
+            std::fill(touched.begin(), touched.end(), 0);
+
+            size_t triangleCount = result.size() / 3;
+            size_t collapseCount = 0;
+            for (const Collapse& collapse : collapses)
+            {
+                if (collapse.Error > maxErrorSquared || triangleCount * 3 <= targetIndexCount)
+                    break;
+
+                const uint32_t from = collapse.From, to = collapse.To;
+                if (touched[from] || touched[to])
+                    continue;
+
+                const uint32_t* triangles = &adjacency.Triangles[adjacency.Offsets[from]];
+                const uint32_t count = adjacency.Counts[from];
+
+                bool flips = false;
+                uint32_t removed = 0;
+                for (uint32_t t = 0; t < count && !flips; t++)
+                {
+                    const uint32_t* tri = &result[triangles[t] * 3];
+                    if (tri[0] == to || tri[1] == to || tri[2] == to)
+                    {
+                        removed++;
+                        continue;
+                    }
+
+                    glm::vec3 p[3] = {position(tri[0]), position(tri[1]), position(tri[2])};
+                    const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (uint32_t k = 0; k < 3; k++)
+                    {
+                        if (tri[k] == from)
+                            p[k] = position(to);
+                    }
+                    const glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    flips = glm::dot(before, after) <= MinimumFlipCosine * glm::length(before) * glm::length(after);
+                }
+
+                if (flips)
+                    continue;
+
+                remap[from] = to;
+                quadrics[to] += quadrics[from];
+                largestError = std::max(largestError, collapse.Error);
+                triangleCount -= removed;
+                collapseCount++;
+
+                // The ring around the collapsed vertex changed, leave it alone until adjacency is rebuilt
+                for (uint32_t t = 0; t < count; t++)
+                {
+                    const uint32_t* tri = &result[triangles[t] * 3];
+                    touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+                }
+            }
+
+            if (collapseCount == 0)
+                break;
+
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        if (resultError != nullptr)
+            *resultError = std::sqrt(largestError);
+
+        return result;
+    }
+}
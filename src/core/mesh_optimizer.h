@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Index and vertex reordering for indexed triangle lists.
+// All passes operate in place and leave the rendered result unchanged.
+namespace MeshOptimizer
+{
+    struct VertexCacheStatistics
+    {
+        uint32_t VerticesTransformed = 0;
+        float ACMR = 0.0f;  // Average cache miss ratio, transformed vertices per triangle (0.5 - 3.0)
+        float ATVR = 0.0f;  // Average transformed vertex ratio, transformed vertices per referenced vertex (1.0 is optimal)
+    };
+
+    // A small cluster of triangles that can be culled on its own, stored as a range of the mesh index buffer
+    struct Meshlet
+    {
+        uint32_t FirstIndex = 0;
+        uint32_t IndexCount = 0;
+        uint32_t VertexCount = 0;   // Unique vertices referenced by the range
+
+        // Object space bounding sphere
+        glm::vec3 Center{0.0f};
+        float Radius = 0.0f;
+
+        // Normal cone, see IsMeshletBackfacing. A cutoff of 1 means the cone is too wide to ever cull.
+        glm::vec3 ConeAxis{0.0f, 0.0f, 1.0f};
+        float ConeCutoff = 1.0f;
+    };
+
+    // Simulates a FIFO post-transform cache of the given size
+    VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+    // Reorders triangles to maximize post-transform cache hits (Forsyth's linear-speed algorithm)
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+    // Splits the cache-optimized triangle order into clusters at cache flush points and sorts the clusters
+    // so outward facing ones are drawn first, which reduces overdraw without hurting cache efficiency.
+    // Positions are read as three floats at the start of every vertex.
+    void OptimizeOverdraw(std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t vertexStride, uint32_t cacheSize = 16);
+
+    // Reorders vertices into first-use order so vertex fetch walks memory linearly.
+    // Unreferenced vertices are dropped, returns the new vertex count.
+    size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexStride, std::vector<uint32_t>& indices);
+
+    // Splits the triangle list into meshlets of at most maxVertices unique vertices and maxTriangles triangles.
+    // Triangle order is kept, so run it after OptimizeVertexCache to get spatially compact clusters.
+    // Positions are read as three floats at the start of every vertex.
+    std::vector<Meshlet> BuildMeshlets(const std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t vertexStride,
+                                       uint32_t maxVertices = 64, uint32_t maxTriangles = 124);
+
+    // True when every triangle of the meshlet faces away from the viewer, viewerPosition is in object space
+    bool IsMeshletBackfacing(const Meshlet& meshlet, const glm::vec3& viewerPosition);
+
+    // Quadric error edge collapse. Returns a reduced index list over the same vertices with at most targetIndexCount
+    // indices, unless reaching it would move the surface further than maxError (object space units).
+    // Mesh borders and attribute seams are kept in place. resultError receives the largest deviation introduced.
+    std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const void* vertices, size_t vertexCount, size_t vertexStride,
+                                   size_t targetIndexCount, float maxError, float* resultError = nullptr);
+}
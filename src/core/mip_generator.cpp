@@ -0,0 +1,228 @@
+#include "mip_generator.h"
+#include "thread_pool.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr size_t LevelAlignment = 16;
+    // Texels per ParallelFor grain, small levels end up on a single thread
+    constexpr size_t TexelsPerGrain = 16 * 1024;
+
+    // Source texels contributing to one destination texel along an axis. A destination texel covers
+    // srcSize / dstSize source texels, which is at most 3 for a halving step, so partial texels at the
+    // edges of the footprint contribute by the fraction they overlap.
+    struct Taps
+    {
+        uint32_t First = 0;
+        uint32_t Count = 0;
+        std::array<float, 4> Weights{};
+    };
+
+    std::vector<Taps> ComputeTaps(uint32_t srcSize, uint32_t dstSize)
+    {
+        std::vector<Taps> taps(dstSize);
+        const double scale = static_cast<double>(srcSize) / dstSize;
+        for (uint32_t dst = 0; dst < dstSize; dst++)
+        {
+            const double start = dst * scale;
+            const double end = std::min((dst + 1) * scale, static_cast<double>(srcSize));
+
+            Taps& tap = taps[dst];
+            tap.First = static_cast<uint32_t>(start);
+            for (uint32_t src = tap.First; src < end && tap.Count < tap.Weights.size(); src++)
+            {
+                const double overlap = std::min(end, src + 1.0) - std::max(start, static_cast<double>(src));
+                tap.Weights[tap.Count++] = static_cast<float>(overlap / scale);
+            }
+        }
+        return taps;
+    }
+
+    const std::array<float, 256>& GetSrgbToLinearTable()
+    {
+        static const std::array<float, 256> table = []()
+        {
+            std::array<float, 256> result{};
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                const float value = static_cast<float>(i) / 255.0f;
+                result[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    // Sampled finely enough to stay accurate on the steep part of the curve near black
+    constexpr size_t LinearToSrgbTableSize = 65536;
+
+    const std::vector<uint8_t>& GetLinearToSrgbTable()
+    {
+        static const std::vector<uint8_t> table = []()
+        {
+            std::vector<uint8_t> result(LinearToSrgbTableSize);
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                const float value = static_cast<float>(i) / (LinearToSrgbTableSize - 1);
+                const float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+                result[i] = static_cast<uint8_t>(std::lround(std::clamp(encoded, 0.0f, 1.0f) * 255.0f));
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    uint8_t ToUnorm8(float value)
+    {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    glm::vec3 Renormalize(const glm::vec3& normal)
+    {
+        const float length = glm::length(normal);
+        return length > 1e-6f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+
+    template<typename T, typename Decode, typename Encode>
+    void Downsample(const T* src, const MipGenerator::MipLevel& srcLevel, T* dst, const MipGenerator::MipLevel& dstLevel,
+                    Decode&& decode, Encode&& encode)
+    {
+        const std::vector<Taps> columns = ComputeTaps(srcLevel.Width, dstLevel.Width);
+        const std::vector<Taps> rows = ComputeTaps(srcLevel.Height, dstLevel.Height);
+
+        const size_t grainSize = std::max<size_t>(1, TexelsPerGrain / dstLevel.Width);
+        ThreadPool::Get().ParallelFor(dstLevel.Height, grainSize, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; y++)
+            {
+                const Taps& row = rows[y];
+                for (size_t x = 0; x < dstLevel.Width; x++)
+                {
+                    const Taps& column = columns[x];
+
+                    glm::vec4 sum{0.0f};
+                    for (uint32_t ty = 0; ty < row.Count; ty++)
+                    {
+                        const T* srcRow = src + (static_cast<size_t>(row.First + ty) * srcLevel.Width + column.First) * 4;
+                        for (uint32_t tx = 0; tx < column.Count; tx++)
+                            sum += decode(srcRow + tx * 4) * (row.Weights[ty] * column.Weights[tx]);
+                    }
+
+                    encode(sum, dst + (y * dstLevel.Width + x) * 4);
+                }
+            }
+        });
+    }
+}
+
+namespace MipGenerator
+{
+    std::vector<MipLevel> GetChainLayout(uint32_t width, uint32_t height, uint32_t mipCount, size_t texelSize)
+    {
+        std::vector<MipLevel> levels(mipCount);
+        size_t offset = 0;
+        for (uint32_t i = 0; i < mipCount; i++)
+        {
+            MipLevel& level = levels[i];
+            level.Width = std::max(width >> i, 1u);
+            level.Height = std::max(height >> i, 1u);
+            level.Offset = offset;
+            level.Size = static_cast<size_t>(level.Width) * level.Height * texelSize;
+            offset = (offset + level.Size + LevelAlignment - 1) & ~(LevelAlignment - 1);
+        }
+        return levels;
+    }
+
+    size_t GetChainSize(const std::vector<MipLevel>& levels)
+    {
+        return levels.empty() ? 0 : levels.back().Offset + levels.back().Size;
+    }
+
+    void GenerateRGBA8(uint8_t* chain, const std::vector<MipLevel>& levels, Encoding encoding)
+    {
+        const std::array<float, 256>& srgbToLinear = GetSrgbToLinearTable();
+        const std::vector<uint8_t>& linearToSrgb = GetLinearToSrgbTable();
+
+        for (size_t i = 1; i < levels.size(); i++)
+        {
+            const uint8_t* src = chain + levels[i - 1].Offset;
+            uint8_t* dst = chain + levels[i].Offset;
+
+            switch (encoding)
+            {
+                case Encoding::Linear:
+                    Downsample(src, levels[i - 1], dst, levels[i],
+                        [](const uint8_t* texel) { return glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.0f; },
+                        [](const glm::vec4& value, uint8_t* texel)
+                        {
+                            for (int c = 0; c < 4; c++)
+                                texel[c] = ToUnorm8(value[c]);
+                        });
+                    break;
+                case Encoding::SRGB:
+                    Downsample(src, levels[i - 1], dst, levels[i],
+                        [&](const uint8_t* texel)
+                        {
+                            return glm::vec4(srgbToLinear[texel[0]], srgbToLinear[texel[1]], srgbToLinear[texel[2]], texel[3] / 255.0f);
+                        },
+                        [&](const glm::vec4& value, uint8_t* texel)
+                        {
+                            for (int c = 0; c < 3; c++)
+                                texel[c] = linearToSrgb[std::lround(std::clamp(value[c], 0.0f, 1.0f) * (LinearToSrgbTableSize - 1))];
+                            texel[3] = ToUnorm8(value[3]);
+                        });
+                    break;
+                case Encoding::NormalMap:
+                    Downsample(src, levels[i - 1], dst, levels[i],
+                        [](const uint8_t* texel)
+                        {
+                            return glm::vec4(glm::vec3(texel[0], texel[1], texel[2]) * (2.0f / 255.0f) - 1.0f, texel[3] / 255.0f);
+                        },
+                        [](const glm::vec4& value, uint8_t* texel)
+                        {
+                            const glm::vec3 normal = Renormalize(glm::vec3(value)) * 0.5f + 0.5f;
+                            for (int c = 0; c < 3; c++)
+                                texel[c] = ToUnorm8(normal[c]);
+                            texel[3] = ToUnorm8(value[3]);
+                        });
+                    break;
+            }
+        }
+    }
+
+    void GenerateRGBA32F(float* chain, const std::vector<MipLevel>& levels, Encoding encoding)
+    {
+        for (size_t i = 1; i < levels.size(); i++)
+        {
+            const float* src = chain + levels[i - 1].Offset / sizeof(float);
+            float* dst = chain + levels[i].Offset / sizeof(float);
+            const auto decode = [](const float* texel) { return glm::vec4(texel[0], texel[1], texel[2], texel[3]); };
+
+            if (encoding == Encoding::NormalMap)
+            {
+                Downsample(src, levels[i - 1], dst, levels[i], decode, [](const glm::vec4& value, float* texel)
+                {
+                    const glm::vec3 normal = Renormalize(glm::vec3(value) * 2.0f - 1.0f) * 0.5f + 0.5f;
+                    texel[0] = normal.x;
+                    texel[1] = normal.y;
+                    texel[2] = normal.z;
+                    texel[3] = value.w;
+                });
+            }
+            else
+            {
+                Downsample(src, levels[i - 1], dst, levels[i], decode, [](const glm::vec4& value, float* texel)
+                {
+                    for (int c = 0; c < 4; c++)
+                        texel[c] = value[c];
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU mip chain generation for RGBA8 and RGBA32F images. Every level is box filtered from the one above it,
+// weighting source texels by the area they cover so odd sizes don't drop their last row or column.
+namespace MipGenerator
+{
+    // How the texels of an image are interpreted while averaging
+    enum class Encoding : uint32_t
+    {
+        Linear = 0,
+        SRGB,       // Color channels are averaged in linear light, alpha stays linear
+        NormalMap   // XYZ in [0, 1] are averaged as vectors and renormalized
+    };
+
+    struct MipLevel
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        size_t Offset = 0;  // In bytes from the start of the chain
+        size_t Size = 0;
+    };
+
+    // Level 0 first, each level halved (rounding down, at least 1) and stored at a 16 byte aligned offset
+    std::vector<MipLevel> GetChainLayout(uint32_t width, uint32_t height, uint32_t mipCount, size_t texelSize);
+    size_t GetChainSize(const std::vector<MipLevel>& levels);
+
+    // Fills levels 1 and up of a chain whose level 0 is already in place. Rows are split across the thread pool.
+    void GenerateRGBA8(uint8_t* chain, const std::vector<MipLevel>& levels, Encoding encoding);
+    // HDR data is linear, SRGB is treated as Linear
+    void GenerateRGBA32F(float* chain, const std::vector<MipLevel>& levels, Encoding encoding);
+}
@@ -0,0 +1,494 @@
+#include "obj_reader.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    constexpr size_t MinChunkSize = 1024 * 1024;
+
+    struct ShapeMarker
+    {
+        std::string Name;
+        uint32_t IndexOffset;
+    };
+
+    struct ParsedChunk
+    {
+        std::vector<float> Positions;
+        std::vector<float> Colors;
+        std::vector<float> Normals;
+        std::vector<float> TexCoords;
+        std::vector<ObjIndex> Indices;
+        std::vector<ShapeMarker> ShapeMarkers;
+
+        // Negative (relative) face indices can only be resolved once the attribute counts of the
+        // preceding chunks are known. They are stored chunk-local and the slots are listed here.
+        std::vector<uint32_t> RelativePositions;
+        std::vector<uint32_t> RelativeTexCoords;
+        std::vector<uint32_t> RelativeNormals;
+
+        bool HasColors = false;
+    };
+
+    bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    const char* SkipSpace(const char* p, const char* end)
+    {
+        while (p < end && IsSpace(*p)) p++;
+        return p;
+    }
+
+    double Pow10(int exponent)
+    {
+        static constexpr double exactPowers[] =
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        if (exponent >= 0 && exponent <= 22) return exactPowers[exponent];
+        if (exponent < 0 && exponent >= -22) return 1.0 / exactPowers[-exponent];
+        return std::pow(10.0, exponent);
+    }
+
+    // Locale independent float parser, returns nullptr when no number is found
+    const char* ParseFloat(const char* p, const char* end, float& value)
+    {
+        p = SkipSpace(p, end);
+
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative = *p == '-';
+            p++;
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            if (mantissa < 100000000000000000ull)
+                mantissa = mantissa * 10 + (*p - '0');
+            else
+                exponent++;
+            p++;
+            digits++;
+        }
+
+        if (p < end && *p == '.')
+        {
+            p++;
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                if (mantissa < 100000000000000000ull)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    exponent--;
+                }
+                p++;
+                digits++;
+            }
+        }
+
+        if (digits == 0)
+            return nullptr;
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char* exponentStart = p++;
+            bool negativeExponent = false;
+            if (p < end && (*p == '-' || *p == '+'))
+            {
+                negativeExponent = *p == '-';
+                p++;
+            }
+
+            if (p < end && *p >= '0' && *p <= '9')
+            {
+                int explicitExponent = 0;
+                while (p < end && *p >= '0' && *p <= '9')
+                {
+                    if (explicitExponent < 10000)
+                        explicitExponent = explicitExponent * 10 + (*p - '0');
+                    p++;
+                }
+                exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            }
+            else
+            {
+                p = exponentStart;
+            }
+        }
+
+        double result = static_cast<double>(mantissa) * Pow10(exponent);
+        value = static_cast<float>(negative ? -result : result);
+        return p;
+    }
+
+    const char* ParseInt(const char* p, const char* end, int32_t& value)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative = *p == '-';
+            p++;
+        }
+
+        if (p >= end || *p < '0' || *p > '9')
+            return nullptr;
+
+        int64_t result = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            result = std::min<int64_t>(result * 10 + (*p - '0'), INT32_MAX);
+            p++;
+        }
+
+        value = static_cast<int32_t>(negative ? -result : result);
+        return p;
+    }
+
+    void ParseFace(const char* p, const char* end, ParsedChunk& chunk, std::vector<ObjIndex>& polygon, std::vector<uint8_t>& relativeMask)
+    {
+        polygon.clear();
+        relativeMask.clear();
+
+        while (true)
+        {
+            p = SkipSpace(p, end);
+            if (p >= end) break;
+
+            int32_t values[3] = {0, 0, 0};
+            bool present[3] = {false, false, false};
+
+            for (int component = 0; component < 3; component++)
+            {
+                if (component > 0)
+                {
+                    if (p >= end || *p != '/') break;
+                    p++;
+                }
+
+                const char* next = ParseInt(p, end, values[component]);
+                if (next)
+                {
+                    present[component] = true;
+                    p = next;
+                }
+            }
+
+            if (!present[0])
+                break;
+
+            if (values[0] == 0 || (present[1] && values[1] == 0) || (present[2] && values[2] == 0))
+                throw std::runtime_error("OBJ face references index 0");
+
+            // Skip anything trailing the corner we don't understand
+            while (p < end && !IsSpace(*p)) p++;
+
+            ObjIndex corner{};
+            uint8_t mask = 0;
+            corner.Position = values[0] > 0 ? values[0] - 1 : values[0];
+            mask |= values[0] <= 0 ? 1 : 0;
+            if (present[1])
+            {
+                corner.TexCoord = values[1] > 0 ? values[1] - 1 : values[1];
+                mask |= values[1] <= 0 ? 2 : 0;
+            }
+            if (present[2])
+            {
+                corner.Normal = values[2] > 0 ? values[2] - 1 : values[2];
+                mask |= values[2] <= 0 ? 4 : 0;
+            }
+
+            polygon.push_back(corner);
+            relativeMask.push_back(mask);
+        }
+
+        if (polygon.size() < 3)
+            return;
+
+        const size_t positionCount = chunk.Positions.size() / 3;
+        const size_t texCoordCount = chunk.TexCoords.size() / 2;
+        const size_t normalCount = chunk.Normals.size() / 3;
+
+        // Resolve each polygon corner once, then fan triangulate
+        for (size_t i = 0; i < polygon.size(); i++)
+        {
+            uint8_t mask = relativeMask[i];
+            if (mask == 0) continue;
+
+            ObjIndex& corner = polygon[i];
+            if (mask & 1)
+                corner.Position = static_cast<int32_t>(static_cast<int64_t>(positionCount) + corner.Position);
+            if (mask & 2)
+                corner.TexCoord = static_cast<int32_t>(static_cast<int64_t>(texCoordCount) + corner.TexCoord);
+            if (mask & 4)
+                corner.Normal = static_cast<int32_t>(static_cast<int64_t>(normalCount) + corner.Normal);
+        }
+
+        for (size_t i = 1; i + 1 < polygon.size(); i++)
+        {
+            const size_t triangleCorners[3] = {0, i, i + 1};
+            for (size_t cornerIndex : triangleCorners)
+            {
+                auto slot = static_cast<uint32_t>(chunk.Indices.size());
+                uint8_t mask = relativeMask[cornerIndex];
+                if (mask & 1) chunk.RelativePositions.push_back(slot);
+                if (mask & 2) chunk.RelativeTexCoords.push_back(slot);
+                if (mask & 4) chunk.RelativeNormals.push_back(slot);
+                chunk.Indices.push_back(polygon[cornerIndex]);
+            }
+        }
+    }
+
+    void ParseChunk(const char* begin, const char* end, ParsedChunk& chunk)
+    {
+        std::vector<ObjIndex> polygon;
+        std::vector<uint8_t> relativeMask;
+
+        const char* line = begin;
+        while (line < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+            if (!lineEnd) lineEnd = end;
+
+            const char* p = SkipSpace(line, lineEnd);
+            const size_t remaining = lineEnd - p;
+
+            if (remaining >= 2 && p[0] == 'v' && IsSpace(p[1]))
+            {
+                float xyz[3] = {0.0f, 0.0f, 0.0f};
+                const char* cursor = p + 1;
+                for (float& component : xyz)
+                {
+                    const char* next = ParseFloat(cursor, lineEnd, component);
+                    if (next) cursor = next;
+                }
+                chunk.Positions.insert(chunk.Positions.end(), xyz, xyz + 3);
+
+                float rgb[3] = {1.0f, 1.0f, 1.0f};
+                bool hasColor = true;
+                for (float& component : rgb)
+                {
+                    const char* next = ParseFloat(cursor, lineEnd, component);
+                    if (!next)
+                    {
+                        hasColor = false;
+                        break;
+                    }
+                    cursor = next;
+                }
+
+                if (hasColor && !chunk.HasColors)
+                {
+                    // Backfill the positions seen before the first colored vertex
+                    chunk.HasColors = true;
+                    chunk.Colors.assign(chunk.Positions.size() - 3, 1.0f);
+                }
+
+                if (chunk.HasColors)
+                {
+                    if (!hasColor) rgb[0] = rgb[1] = rgb[2] = 1.0f;
+                    chunk.Colors.insert(chunk.Colors.end(), rgb, rgb + 3);
+                }
+            }
+            else if (remaining >= 3 && p[0] == 'v' && p[1] == 't' && IsSpace(p[2]))
+            {
+                float uv[2] = {0.0f, 0.0f};
+                const char* cursor = p + 2;
+                for (float& component : uv)
+                {
+                    const char* next = ParseFloat(cursor, lineEnd, component);
+                    if (next) cursor = next;
+                }
+                chunk.TexCoords.insert(chunk.TexCoords.end(), uv, uv + 2);
+            }
+            else if (remaining >= 3 && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2]))
+            {
+                float xyz[3] = {0.0f, 0.0f, 0.0f};
+                const char* cursor = p + 2;
+                for (float& component : xyz)
+                {
+                    const char* next = ParseFloat(cursor, lineEnd, component);
+                    if (next) cursor = next;
+                }
+                chunk.Normals.insert(chunk.Normals.end(), xyz, xyz + 3);
+            }
+            else if (remaining >= 2 && p[0] == 'f' && IsSpace(p[1]))
+            {
+                ParseFace(p + 1, lineEnd, chunk, polygon, relativeMask);
+            }
+            else if (remaining >= 1 && (p[0] == 'o' || p[0] == 'g') && (remaining == 1 || IsSpace(p[1])))
+            {
+                const char* nameBegin = SkipSpace(p + 1, lineEnd);
+                const char* nameEnd = lineEnd;
+                while (nameEnd > nameBegin && IsSpace(nameEnd[-1])) nameEnd--;
+
+                chunk.ShapeMarkers.push_back({std::string(nameBegin, nameEnd), static_cast<uint32_t>(chunk.Indices.size())});
+            }
+
+            line = lineEnd + 1;
+        }
+    }
+
+    std::vector<size_t> SplitIntoChunks(const char* data, size_t size, size_t chunkCount)
+    {
+        std::vector<size_t> boundaries{0};
+        const size_t chunkSize = size / chunkCount;
+
+        for (size_t i = 1; i < chunkCount; i++)
+        {
+            size_t position = std::max(i * chunkSize, boundaries.back());
+            const void* newline = position < size ? std::memchr(data + position, '\n', size - position) : nullptr;
+            if (!newline) break;
+
+            position = static_cast<const char*>(newline) - data + 1;
+            if (position > boundaries.back() && position < size)
+                boundaries.push_back(position);
+        }
+
+        boundaries.push_back(size);
+        return boundaries;
+    }
+}
+
+ObjData ObjReader::Read(const std::string& filePath)
+{
+    MappedFile file;
+    if (!file.Open(filePath))
+        throw std::runtime_error("failed to open OBJ file: " + filePath);
+
+    ThreadPool& pool = ThreadPool::Get();
+
+    const auto* data = reinterpret_cast<const char*>(file.Data());
+    const size_t desiredChunks = std::clamp<size_t>(file.Size() / MinChunkSize, 1, static_cast<size_t>(pool.GetConcurrency()) * 4);
+    const std::vector<size_t> boundaries = SplitIntoChunks(data, file.Size(), desiredChunks);
+    const size_t chunkCount = boundaries.size() - 1;
+
+    std::vector<ParsedChunk> chunks(chunkCount);
+    pool.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            ParseChunk(data + boundaries[i], data + boundaries[i + 1], chunks[i]);
+        }
+    });
+
+    // Prefix sums give every chunk its place in the merged arrays
+    struct ChunkBase
+    {
+        size_t Position, TexCoord, Normal, Index;
+    };
+
+    std::vector<ChunkBase> bases(chunkCount);
+    ChunkBase total{};
+    bool hasColors = false;
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        bases[i] = total;
+        total.Position += chunks[i].Positions.size() / 3;
+        total.TexCoord += chunks[i].TexCoords.size() / 2;
+        total.Normal += chunks[i].Normals.size() / 3;
+        total.Index += chunks[i].Indices.size();
+        hasColors |= chunks[i].HasColors;
+    }
+
+    if (total.Index > UINT32_MAX || total.Position > INT32_MAX)
+        throw std::runtime_error("OBJ file is too large: " + filePath);
+
+    ObjData result{};
+    result.Positions.resize(total.Position * 3);
+    result.TexCoords.resize(total.TexCoord * 2);
+    result.Normals.resize(total.Normal * 3);
+    result.Indices.resize(total.Index);
+    if (hasColors)
+        result.Colors.resize(total.Position * 3);
+
+    ObjShape current{};
+    auto closeShape = [&](size_t endIndex)
+    {
+        current.IndexCount = static_cast<uint32_t>(endIndex) - current.FirstIndex;
+        if (current.IndexCount > 0)
+            result.Shapes.push_back(current);
+    };
+
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        for (const ShapeMarker& marker : chunks[i].ShapeMarkers)
+        {
+            size_t markerIndex = bases[i].Index + marker.IndexOffset;
+            closeShape(markerIndex);
+            current = ObjShape{marker.Name, static_cast<uint32_t>(markerIndex), 0};
+        }
+    }
+    closeShape(total.Index);
+
+    std::atomic<bool> outOfRange{false};
+    pool.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            ParsedChunk& chunk = chunks[i];
+            const ChunkBase& base = bases[i];
+
+            std::copy(chunk.Positions.begin(), chunk.Positions.end(), result.Positions.begin() + base.Position * 3);
+            std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), result.TexCoords.begin() + base.TexCoord * 2);
+            std::copy(chunk.Normals.begin(), chunk.Normals.end(), result.Normals.begin() + base.Normal * 3);
+
+            if (hasColors)
+            {
+                auto colorOut = result.Colors.begin() + base.Position * 3;
+                if (chunk.HasColors)
+                    std::copy(chunk.Colors.begin(), chunk.Colors.end(), colorOut);
+                else
+                    std::fill(colorOut, colorOut + chunk.Positions.size(), 1.0f);
+            }
+
+            // -1 marks an absent attribute, so a relative index that resolves to it is rejected here rather than below
+            bool chunkOutOfRange = false;
+            for (uint32_t slot : chunk.RelativePositions) chunk.Indices[slot].Position += static_cast<int32_t>(base.Position);
+            for (uint32_t slot : chunk.RelativeTexCoords)
+            {
+                chunk.Indices[slot].TexCoord += static_cast<int32_t>(base.TexCoord);
+                chunkOutOfRange |= chunk.Indices[slot].TexCoord < 0;
+            }
+            for (uint32_t slot : chunk.RelativeNormals)
+            {
+                chunk.Indices[slot].Normal += static_cast<int32_t>(base.Normal);
+                chunkOutOfRange |= chunk.Indices[slot].Normal < 0;
+            }
+
+            for (const ObjIndex& index : chunk.Indices)
+            {
+                chunkOutOfRange |=
+                    index.Position < 0 || static_cast<size_t>(index.Position) >= total.Position ||
+                    index.TexCoord < -1 || (index.TexCoord >= 0 && static_cast<size_t>(index.TexCoord) >= total.TexCoord) ||
+                    index.Normal < -1 || (index.Normal >= 0 && static_cast<size_t>(index.Normal) >= total.Normal);
+            }
+            if (chunkOutOfRange)
+                outOfRange = true;
+
+            std::copy(chunk.Indices.begin(), chunk.Indices.end(), result.Indices.begin() + base.Index);
+
+            // Release the chunk as soon as it's merged to keep the peak footprint down
+            chunk = ParsedChunk{};
+        }
+    });
+
+    if (outOfRange)
+        throw std::runtime_error("OBJ face references an attribute that does not exist: " + filePath);
+
+    return result;
+}
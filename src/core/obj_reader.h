@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Wavefront OBJ reader. The file is memory mapped, split into line-aligned chunks
+// and the chunks are parsed in parallel on the ThreadPool before being stitched together.
+// Only geometry is read (v, vt, vn, f, o, g); materials and smoothing groups are ignored.
+struct ObjIndex
+{
+    // Zero-based attribute indices, -1 when the face corner does not reference the attribute
+    int32_t Position = -1;
+    int32_t TexCoord = -1;
+    int32_t Normal = -1;
+};
+
+struct ObjShape
+{
+    std::string Name;
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+};
+
+struct ObjData
+{
+    std::vector<float> Positions;   // xyz per position
+    std::vector<float> Colors;      // rgb per position, white when the file has no vertex colors
+    std::vector<float> Normals;     // xyz per normal
+    std::vector<float> TexCoords;   // uv per texture coordinate
+
+    // Triangle list, polygons are fan triangulated
+    std::vector<ObjIndex> Indices;
+    std::vector<ObjShape> Shapes;
+};
+
+class ObjReader
+{
+public:
+    // Throws std::runtime_error when the file can't be opened or references attributes that don't exist
+    static ObjData Read(const std::string& filePath);
+};
@@ -1,21 +1,75 @@
 #include "scene.h"
 #include "game_object.h"
 #include "vulkan/vulkan_renderer.h"
+#include <algorithm>
+#include <cassert>
 #include <numeric>
 
 void Scene::UpdateGameObjectUboBuffers(int frameIndex)
 {
-    // Copy model matrix and normal matrix for each game object into buffer for this frame.
-    for(auto& entry: GameObjects)
+    const uint64_t generation = ++m_Generation;
+    const uint64_t uploadedGeneration = m_UploadedGenerations[frameIndex];
+    m_UploadedGenerations[frameIndex] = generation;
+    const uint64_t oldestUploadedGeneration = *std::min_element(m_UploadedGenerations.begin(), m_UploadedGenerations.end());
+
+    // Copy model matrix and normal matrix of each changed game object into buffer for this frame.
+    std::vector<GameObject::id_t> writtenIds;
+    for (auto it = m_DirtyObjects.begin(); it != m_DirtyObjects.end();)
+    {
+        auto& [id, changedGeneration] = *it;
+        if (changedGeneration > uploadedGeneration)
+        {
+            const GameObject& obj = GameObjects.at(id);
+            GameObjectBufferData data{};
+            data.ModelMatrix = obj.GetTransform().Mat4();
+            data.NormalMatrix = glm::mat4(obj.GetTransform().NormalMatrix());
+            if (obj.StreamingModel || obj.ObjectModel)
+            {
+                const auto& quantization = obj.StreamingModel ? obj.StreamingModel->GetQuantization() : obj.ObjectModel->GetQuantization();
+                data.PositionOffset = glm::vec4(quantization.PositionOffset, 0.0f);
+                data.PositionScale = glm::vec4(quantization.PositionScale, 0.0f);
+            }
+            m_GameObjectUboBuffers[frameIndex]->WriteToIndex(&data, static_cast<int>(id));
+            writtenIds.push_back(id);
+
+            // The quantization changes once a loading model resolves, keep rewriting until it has
+            if (!obj.StreamingModel && obj.ObjectModel.GetStatus() == AssetStatus::Loading)
+                changedGeneration = generation + 1;
+        }
+
+        // Every frame's buffer has the latest data
+        if (changedGeneration <= oldestUploadedGeneration)
+            it = m_DirtyObjects.erase(it);
+        else
+            ++it;
+    }
+
+    if (writtenIds.empty())
+        return;
+
+    // Neighbouring objects share one range. The stride is the padded instance size WriteToIndex wrote at, which the
+    // constructor makes a multiple of nonCoherentAtomSize, so a flushed range never touches another object's atoms.
+    std::sort(writtenIds.begin(), writtenIds.end());
+    const VkDeviceSize stride = m_GameObjectUboBuffers[frameIndex]->GetAlignmentSize();
+    assert(stride % VulkanContext::Get().PhysicalDeviceProperties().limits.nonCoherentAtomSize == 0 &&
+        "Game object instances must be aligned to nonCoherentAtomSize to be flushed individually");
+    std::vector<MemoryRange> ranges;
+    for (GameObject::id_t id : writtenIds)
     {
-        auto& obj = entry.second;
-        GameObjectBufferData data{};
-        data.ModelMatrix = obj.ObjectTransform.Mat4();
-        data.NormalMatrix = glm::mat4(obj.ObjectTransform.NormalMatrix());
-        m_GameObjectUboBuffers[frameIndex]->WriteToIndex(&data, entry.first);
+        const VkDeviceSize offset = id * stride;
+        if (!ranges.empty() && ranges.back().Offset + ranges.back().Size == offset)
+            ranges.back().Size += stride;
+        else
+            ranges.push_back({offset, stride});
     }
 
-    m_GameObjectUboBuffers[frameIndex]->Flush();
+    m_GameObjectUboBuffers[frameIndex]->Flush(ranges);
+}
+
+void Scene::MarkGameObjectDirty(GameObject::id_t gameObjectId)
+{
+    // Seen by the next update of every frame's buffer
+    m_DirtyObjects[gameObjectId] = m_Generation + 1;
 }
 
 GameObject &Scene::CreateGameObject(VulkanRenderer &renderer)
@@ -25,12 +79,14 @@ GameObject &Scene::CreateGameObject(VulkanRenderer &renderer)
     auto gameObjectId = gameObject.GetId();
     renderer.PrepareGameObjectForRendering(gameObject);
     GameObjects.emplace(gameObjectId, std::move(gameObject));
+    MarkGameObjectDirty(gameObjectId);
     return GameObjects.at(gameObjectId);
 }
 
 Scene::Scene()
 {
-    // including nonCoherentAtomSize allows us to flush a specific index at once
+    // including nonCoherentAtomSize allows us to flush a specific index at once, minUniformBufferOffsetAlignment
+    // keeps every index a valid dynamic offset
     auto alignment = std::lcm(
             VulkanContext::Get().PhysicalDeviceProperties().limits.nonCoherentAtomSize,
             VulkanContext::Get().PhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment);
@@ -42,6 +98,7 @@ Scene::Scene()
                 Scene::MAX_GAME_OBJECTS,
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                MemoryCategory::Uniforms,
                 alignment);
         uboBuffer->Map();
     }
@@ -3,6 +3,9 @@
 #include "vulkan/vulkan_buffer.h"
 #include "game_object.h"
 
+#include <array>
+#include <unordered_map>
+
 class VulkanRenderer;
 
 class Scene
@@ -18,16 +21,30 @@ public:
     Scene& operator=(Scene&&) = delete;
 
     GameObject& CreateGameObject(VulkanRenderer& renderer);
-    VkDescriptorBufferInfo GetBufferInfoForGameObject(size_t frameIndex, GameObject::id_t gameObjectId) const
+    // One dynamic uniform buffer descriptor per frame covers every object, draws pick their slot with the offset
+    VkDescriptorBufferInfo GetGameObjectBufferInfo(size_t frameIndex) const
+    {
+        return m_GameObjectUboBuffers[frameIndex]->DescriptorInfoForIndex(0);
+    }
+    uint32_t GetDynamicOffsetForGameObject(GameObject::id_t gameObjectId) const
     {
-        return m_GameObjectUboBuffers[frameIndex]->DescriptorInfoForIndex(gameObjectId);
+        return static_cast<uint32_t>(gameObjectId * m_GameObjectUboBuffers[0]->GetAlignmentSize());
     }
 
+    // Rewrites only the objects that changed since this frame's buffer was last written and flushes their ranges
     void UpdateGameObjectUboBuffers(int frameIndex);
+    void MarkGameObjectDirty(GameObject::id_t gameObjectId);
 
     GameObject::Map GameObjects{};
     std::vector<std::unique_ptr<VulkanBuffer>> m_GameObjectUboBuffers{VulkanSwapchain::MAX_FRAMES_IN_FLIGHT};
 
 private:
     GameObject::id_t m_CurrentId = 0;
+
+    // Incremented by every UpdateGameObjectUboBuffers
+    uint64_t m_Generation = 0;
+    // Generation each frame's buffer was last written in
+    std::array<uint64_t, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT> m_UploadedGenerations{};
+    // Generation of the latest change of every object some frame's buffer hasn't caught up with yet
+    std::unordered_map<GameObject::id_t, uint64_t> m_DirtyObjects;
 };
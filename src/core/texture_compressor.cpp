@@ -0,0 +1,418 @@
+#include "texture_compressor.h"
+#include "thread_pool.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    constexpr size_t LevelAlignment = 16;
+    // Blocks per ParallelFor grain
+    constexpr size_t BlocksPerGrain = 1024;
+
+    using Block = std::array<glm::vec4, 16>;
+
+    // Texels outside the image repeat the last row and column
+    Block LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY)
+    {
+        Block block{};
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            const uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                const uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+                const uint8_t* texel = rgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4;
+                block[y * 4 + x] = glm::vec4(texel[0], texel[1], texel[2], texel[3]);
+            }
+        }
+        return block;
+    }
+
+    // Power iteration on the covariance of the texels, channels beyond channelCount are ignored
+    glm::vec4 ComputePrincipalAxis(const Block& block, const glm::vec4& mean, int channelCount)
+    {
+        glm::mat4 covariance{0.0f};
+        glm::vec4 minimum{std::numeric_limits<float>::max()};
+        glm::vec4 maximum{std::numeric_limits<float>::lowest()};
+        for (const glm::vec4& texel : block)
+        {
+            glm::vec4 offset = texel - mean;
+            for (int c = channelCount; c < 4; c++)
+                offset[c] = 0.0f;
+            for (int column = 0; column < 4; column++)
+                covariance[column] += offset * offset[column];
+            minimum = glm::min(minimum, texel);
+            maximum = glm::max(maximum, texel);
+        }
+
+        glm::vec4 axis = maximum - minimum;
+        for (int c = channelCount; c < 4; c++)
+            axis[c] = 0.0f;
+        if (glm::dot(axis, axis) < 1e-6f)
+            return glm::vec4(0.0f);
+
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            const glm::vec4 next = covariance * axis;
+            const float length = glm::length(next);
+            if (length < 1e-6f)
+                break;
+            axis = next / length;
+        }
+        return glm::normalize(axis);
+    }
+
+    glm::vec4 ComputeMean(const Block& block)
+    {
+        glm::vec4 sum{0.0f};
+        for (const glm::vec4& texel : block)
+            sum += texel;
+        return sum / 16.0f;
+    }
+
+    uint16_t PackRGB565(const glm::vec3& color)
+    {
+        const glm::vec3 clamped = glm::clamp(color, 0.0f, 255.0f);
+        const auto r = static_cast<uint16_t>(std::lround(clamped.x * 31.0f / 255.0f));
+        const auto g = static_cast<uint16_t>(std::lround(clamped.y * 63.0f / 255.0f));
+        const auto b = static_cast<uint16_t>(std::lround(clamped.z * 31.0f / 255.0f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    glm::vec3 UnpackRGB565(uint16_t color)
+    {
+        const uint32_t r = (color >> 11) & 31;
+        const uint32_t g = (color >> 5) & 63;
+        const uint32_t b = color & 31;
+        return glm::vec3((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+    }
+
+    float DistanceSquared(const glm::vec3& a, const glm::vec3& b)
+    {
+        const glm::vec3 offset = a - b;
+        return glm::dot(offset, offset);
+    }
+
+    // Picks the nearest of the four palette entries per texel, returns the total squared error
+    float SelectBC1Indices(const Block& block, uint16_t color0, uint16_t color1, uint32_t& indices)
+    {
+        const glm::vec3 endpoint0 = UnpackRGB565(color0);
+        const glm::vec3 endpoint1 = UnpackRGB565(color1);
+        const std::array<glm::vec3, 4> palette{
+            endpoint0, endpoint1, (endpoint0 * 2.0f + endpoint1) / 3.0f, (endpoint0 + endpoint1 * 2.0f) / 3.0f};
+
+        float error = 0.0f;
+        indices = 0;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const glm::vec3 texel{block[i]};
+            uint32_t best = 0;
+            float bestDistance = DistanceSquared(texel, palette[0]);
+            for (uint32_t p = 1; p < 4; p++)
+            {
+                const float distance = DistanceSquared(texel, palette[p]);
+                if (distance < bestDistance)
+                {
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+            indices |= best << (i * 2);
+            error += bestDistance;
+        }
+        return error;
+    }
+
+    // Orders the endpoints for four color mode, equal endpoints can only describe a single color
+    float EncodeBC1Endpoints(const Block& block, const glm::vec3& endpoint0, const glm::vec3& endpoint1,
+                             uint16_t& color0, uint16_t& color1, uint32_t& indices)
+    {
+        color0 = PackRGB565(endpoint0);
+        color1 = PackRGB565(endpoint1);
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        if (color0 == color1)
+        {
+            indices = 0;
+            float error = 0.0f;
+            for (const glm::vec4& texel : block)
+                error += DistanceSquared(glm::vec3(texel), UnpackRGB565(color0));
+            return error;
+        }
+        return SelectBC1Indices(block, color0, color1, indices);
+    }
+
+    void EncodeBC1(const Block& block, uint8_t* out)
+    {
+        const glm::vec4 mean = ComputeMean(block);
+        const glm::vec3 axis{ComputePrincipalAxis(block, mean, 3)};
+
+        float minProjection = 0.0f;
+        float maxProjection = 0.0f;
+        for (const glm::vec4& texel : block)
+        {
+            const float projection = glm::dot(glm::vec3(texel - mean), axis);
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        // Insetting the endpoints a little lowers the error of the texels between them
+        const float inset = (maxProjection - minProjection) / 16.0f;
+        glm::vec3 endpoint0 = glm::vec3(mean) + axis * (maxProjection - inset);
+        glm::vec3 endpoint1 = glm::vec3(mean) + axis * (minProjection + inset);
+
+        uint16_t color0, color1;
+        uint32_t indices;
+        float error = EncodeBC1Endpoints(block, endpoint0, endpoint1, color0, color1, indices);
+
+        // One least squares refit of the endpoints to the chosen indices
+        static constexpr std::array<float, 4> weights{1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        glm::vec3 ax{0.0f}, bx{0.0f};
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const float a = weights[(indices >> (i * 2)) & 3];
+            const float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            ax += glm::vec3(block[i]) * a;
+            bx += glm::vec3(block[i]) * b;
+        }
+
+        const float determinant = aa * bb - ab * ab;
+        if (color0 != color1 && std::abs(determinant) > 1e-6f)
+        {
+            endpoint0 = (ax * bb - bx * ab) / determinant;
+            endpoint1 = (bx * aa - ax * ab) / determinant;
+
+            uint16_t refitColor0, refitColor1;
+            uint32_t refitIndices;
+            const float refitError = EncodeBC1Endpoints(block, endpoint0, endpoint1, refitColor0, refitColor1, refitIndices);
+            if (refitError < error)
+            {
+                color0 = refitColor0;
+                color1 = refitColor1;
+                indices = refitIndices;
+            }
+        }
+
+        std::memcpy(out, &color0, sizeof(uint16_t));
+        std::memcpy(out + 2, &color1, sizeof(uint16_t));
+        std::memcpy(out + 4, &indices, sizeof(uint32_t));
+    }
+
+    // Eight value mode with the larger value first, indices 2-7 step from the first endpoint towards the second
+    void EncodeBC4(const Block& block, int channel, uint8_t* out)
+    {
+        float minimum = 255.0f;
+        float maximum = 0.0f;
+        for (const glm::vec4& texel : block)
+        {
+            minimum = std::min(minimum, texel[channel]);
+            maximum = std::max(maximum, texel[channel]);
+        }
+
+        const auto value0 = static_cast<uint8_t>(maximum);
+        const auto value1 = static_cast<uint8_t>(minimum);
+        out[0] = value0;
+        out[1] = value1;
+
+        uint64_t indices = 0;
+        if (value0 != value1)
+        {
+            const float scale = 7.0f / static_cast<float>(value0 - value1);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const auto step = static_cast<uint64_t>(std::lround((value0 - block[i][channel]) * scale));
+                const uint64_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+                indices |= index << (i * 3);
+            }
+        }
+
+        for (uint32_t i = 0; i < 6; i++)
+            out[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+    }
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t* out) : m_Out(out) { std::memset(out, 0, 16); }
+
+        void Write(uint32_t value, uint32_t bitCount)
+        {
+            for (uint32_t i = 0; i < bitCount; i++, m_Position++)
+            {
+                if ((value >> i) & 1)
+                    m_Out[m_Position / 8] |= static_cast<uint8_t>(1 << (m_Position % 8));
+            }
+        }
+
+    private:
+        uint8_t* m_Out;
+        uint32_t m_Position = 0;
+    };
+
+    constexpr std::array<int, 16> BC7Weights{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct BC7Candidate
+    {
+        glm::ivec4 Quantized[2];
+        int PBits[2];
+        std::array<uint8_t, 16> Indices;
+        float Error = std::numeric_limits<float>::max();
+    };
+
+    // Mode 6: one subset, 7 bit RGBA endpoints with a shared low bit per endpoint and 4 bit indices
+    void EncodeBC7(const Block& block, uint8_t* out)
+    {
+        const glm::vec4 mean = ComputeMean(block);
+        const glm::vec4 axis = ComputePrincipalAxis(block, mean, 4);
+
+        float minProjection = 0.0f;
+        float maxProjection = 0.0f;
+        for (const glm::vec4& texel : block)
+        {
+            const float projection = glm::dot(texel - mean, axis);
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+        const glm::vec4 endpoints[2]{mean + axis * minProjection, mean + axis * maxProjection};
+
+        BC7Candidate best{};
+        for (int pbits = 0; pbits < 4; pbits++)
+        {
+            BC7Candidate candidate{};
+            glm::vec4 decoded[2];
+            for (int e = 0; e < 2; e++)
+            {
+                candidate.PBits[e] = (pbits >> e) & 1;
+                candidate.Quantized[e] = glm::ivec4(glm::clamp(glm::round((endpoints[e] - static_cast<float>(candidate.PBits[e])) * 0.5f), 0.0f, 127.0f));
+                decoded[e] = glm::vec4(candidate.Quantized[e] * 2 + candidate.PBits[e]);
+            }
+
+            const glm::vec4 direction = decoded[1] - decoded[0];
+            const float lengthSquared = glm::dot(direction, direction);
+
+            candidate.Error = 0.0f;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const float t = lengthSquared > 0.0f ? glm::dot(block[i] - decoded[0], direction) / lengthSquared : 0.0f;
+                const int guess = std::clamp(static_cast<int>(std::lround(t * 15.0f)), 0, 15);
+
+                float bestDistance = std::numeric_limits<float>::max();
+                for (int index = std::max(guess - 1, 0); index <= std::min(guess + 1, 15); index++)
+                {
+                    const glm::vec4 value = glm::floor((decoded[0] * static_cast<float>(64 - BC7Weights[index]) + decoded[1] * static_cast<float>(BC7Weights[index]) + 32.0f) / 64.0f);
+                    const glm::vec4 offset = value - block[i];
+                    const float distance = glm::dot(offset, offset);
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        candidate.Indices[i] = static_cast<uint8_t>(index);
+                    }
+                }
+                candidate.Error += bestDistance;
+            }
+
+            if (candidate.Error < best.Error)
+                best = candidate;
+        }
+
+        // The anchor index is stored without its top bit, so it has to be below 8
+        if (best.Indices[0] >= 8)
+        {
+            std::swap(best.Quantized[0], best.Quantized[1]);
+            std::swap(best.PBits[0], best.PBits[1]);
+            for (uint8_t& index : best.Indices)
+                index = static_cast<uint8_t>(15 - index);
+        }
+
+        BitWriter writer{out};
+        writer.Write(1 << 6, 7);
+        for (int channel = 0; channel < 4; channel++)
+        {
+            writer.Write(best.Quantized[0][channel], 7);
+            writer.Write(best.Quantized[1][channel], 7);
+        }
+        writer.Write(best.PBits[0], 1);
+        writer.Write(best.PBits[1], 1);
+        writer.Write(best.Indices[0], 3);
+        for (uint32_t i = 1; i < 16; i++)
+            writer.Write(best.Indices[i], 4);
+    }
+}
+
+namespace TextureCompressor
+{
+    uint32_t GetBlockSize(Format format)
+    {
+        return format == Format::BC1 ? 8 : 16;
+    }
+
+    size_t GetCompressedSize(Format format, uint32_t width, uint32_t height)
+    {
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+    }
+
+    std::vector<MipGenerator::MipLevel> GetChainLayout(Format format, uint32_t width, uint32_t height, uint32_t mipCount)
+    {
+        std::vector<MipGenerator::MipLevel> levels(mipCount);
+        size_t offset = 0;
+        for (uint32_t i = 0; i < mipCount; i++)
+        {
+            MipGenerator::MipLevel& level = levels[i];
+            level.Width = std::max(width >> i, 1u);
+            level.Height = std::max(height >> i, 1u);
+            level.Offset = offset;
+            level.Size = GetCompressedSize(format, level.Width, level.Height);
+            offset = (offset + level.Size + LevelAlignment - 1) & ~(LevelAlignment - 1);
+        }
+        return levels;
+    }
+
+    void Compress(Format format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* blocks)
+    {
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        const uint32_t blockSize = GetBlockSize(format);
+
+        const size_t grainSize = std::max<size_t>(1, BlocksPerGrain / blocksX);
+        ThreadPool::Get().ParallelFor(blocksY, grainSize, [&](size_t begin, size_t end)
+        {
+            for (size_t blockY = begin; blockY < end; blockY++)
+            {
+                for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+                {
+                    const Block block = LoadBlock(rgba, width, height, blockX, static_cast<uint32_t>(blockY));
+                    uint8_t* out = blocks + (blockY * blocksX + blockX) * blockSize;
+
+                    switch (format)
+                    {
+                        case Format::BC1:
+                            EncodeBC1(block, out);
+                            break;
+                        case Format::BC3:
+                            EncodeBC4(block, 3, out);
+                            EncodeBC1(block, out + 8);
+                            break;
+                        case Format::BC5:
+                            EncodeBC4(block, 0, out);
+                            EncodeBC4(block, 1, out + 8);
+                            break;
+                        case Format::BC7:
+                            EncodeBC7(block, out);
+                            break;
+                    }
+                }
+            }
+        });
+    }
+}
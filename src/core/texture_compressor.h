@@ -0,0 +1,28 @@
+#pragma once
+
+#include "mip_generator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU encoders for block compressed formats. Every format stores 4x4 texel blocks, images whose size is not a
+// multiple of four repeat their last row and column into the edge blocks. Block rows are split across the thread pool.
+namespace TextureCompressor
+{
+    enum class Format : uint32_t
+    {
+        BC1 = 0,    // RGB, 8 bytes per block
+        BC3,        // RGBA, BC1 color plus a BC4 alpha block, 16 bytes
+        BC5,        // RG, two BC4 blocks, 16 bytes. Used for normal maps, Z is reconstructed in the shader
+        BC7         // RGBA, mode 6 only, 16 bytes
+    };
+
+    uint32_t GetBlockSize(Format format);
+    size_t GetCompressedSize(Format format, uint32_t width, uint32_t height);
+    // Same level sizes as MipGenerator::GetChainLayout, with every level stored as blocks
+    std::vector<MipGenerator::MipLevel> GetChainLayout(Format format, uint32_t width, uint32_t height, uint32_t mipCount);
+
+    // Encodes an RGBA8 image into row-major blocks
+    void Compress(Format format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* blocks);
+}
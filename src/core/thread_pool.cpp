@@ -0,0 +1,167 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool::~ThreadPool()
+{
+    Stop();
+}
+
+void ThreadPool::Initialize(uint32_t threadCount)
+{
+    ThreadPool& pool = Get();
+    if (!pool.m_Workers.empty()) return;
+
+    if (threadCount == 0)
+    {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    pool.m_Stopping = false;
+    pool.m_Workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        pool.m_Workers.emplace_back([&pool]() { pool.WorkerLoop(); });
+    }
+}
+
+void ThreadPool::Shutdown()
+{
+    Get().Stop();
+}
+
+void ThreadPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Condition.notify_all();
+
+    for (auto& worker : m_Workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_Workers.clear();
+
+    // Anything still queued after the workers are gone runs on the caller so no future is left dangling
+    while (!m_Jobs.empty())
+    {
+        auto job = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+        job();
+    }
+}
+
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Workers.empty() && !m_Stopping)
+        {
+            m_Jobs.push_back(std::move(job));
+            m_Condition.notify_one();
+            return;
+        }
+    }
+
+    job();
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+            if (m_Jobs.empty())
+                return;
+
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn)
+{
+    if (count == 0) return;
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t maxChunks = static_cast<size_t>(GetConcurrency()) * 4;
+    const size_t chunkCount = std::min((count + grainSize - 1) / grainSize, maxChunks);
+
+    if (chunkCount <= 1 || m_Workers.empty())
+    {
+        fn(0, count);
+        return;
+    }
+
+    struct SharedState
+    {
+        std::atomic<size_t> NextChunk{0};
+        std::atomic<size_t> CompletedChunks{0};
+        std::mutex Mutex;
+        std::condition_variable Done;
+        std::exception_ptr Exception;
+    };
+
+    // Helpers can still be dequeued after this call returns, so the state they touch is reference counted.
+    // They only ever read NextChunk once all chunks are claimed, and never call fn.
+    auto state = std::make_shared<SharedState>();
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    auto runChunks = [state, chunkCount, chunkSize, count, &fn]()
+    {
+        while (true)
+        {
+            size_t chunk = state->NextChunk.fetch_add(1);
+            if (chunk >= chunkCount)
+                return;
+
+            size_t begin = chunk * chunkSize;
+            size_t end = std::min(begin + chunkSize, count);
+
+            try
+            {
+                if (begin < end)
+                    fn(begin, end);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                if (!state->Exception)
+                    state->Exception = std::current_exception();
+            }
+
+            if (state->CompletedChunks.fetch_add(1) + 1 == chunkCount)
+            {
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                state->Done.notify_all();
+            }
+        }
+    };
+
+    const size_t helperCount = std::min(chunkCount - 1, m_Workers.size());
+    for (size_t i = 0; i < helperCount; i++)
+    {
+        Enqueue(runChunks);
+    }
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(state->Mutex);
+    state->Done.wait(lock, [&state, chunkCount]() { return state->CompletedChunks.load() == chunkCount; });
+
+    if (state->Exception)
+        std::rethrow_exception(state->Exception);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    static ThreadPool& Get()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // A thread count of 0 uses one worker per hardware thread, minus the calling thread.
+    static void Initialize(uint32_t threadCount = 0);
+    static void Shutdown();
+
+    // Runs the job on a worker. Without workers (pool not initialized) the job runs inline.
+    template<typename Fn>
+    auto Submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn>>
+    {
+        using ResultType = std::invoke_result_t<Fn>;
+
+        auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Fn>(fn));
+        std::future<ResultType> future = task->get_future();
+        Enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // Splits [0, count) into ranges of at least grainSize elements and runs fn(begin, end) on each.
+    // The calling thread takes part in the work, so nested calls from a worker cannot deadlock.
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn);
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+    // Number of threads that take part in a ParallelFor, including the caller
+    uint32_t GetConcurrency() const { return GetThreadCount() + 1; }
+
+private:
+    ThreadPool() = default;
+    ~ThreadPool();
+
+    void Enqueue(std::function<void()> job);
+    void WorkerLoop();
+    void Stop();
+
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void()>> m_Jobs;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Stopping = false;
+};
@@ -0,0 +1,201 @@
+#include "vulkan_asset_loader.h"
+#include "core/platform_path.h"
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+void VulkanAssetLoader::Initialize()
+{
+    VulkanAssetLoader& loader = Get();
+
+    TextureSpecification missingSpec{};
+    missingSpec.DebugName = "Missing Texture";
+    loader.m_MissingTexture = VulkanTexture2D::CreateFromFile(missingSpec, FileSystemUtil::PathToString(FileSystemUtil::GetTextureDirectory() / "missing.png"));
+
+    // A single texel is enough, tangent space normals only need +Z
+    const std::array<uint8_t, 4> flatNormal{128, 128, 255, 255};
+    TextureSpecification flatNormalSpec{};
+    flatNormalSpec.Format = ImageFormat::RGBA;
+    flatNormalSpec.Width = 1;
+    flatNormalSpec.Height = 1;
+    flatNormalSpec.GenerateMips = false;
+    flatNormalSpec.DebugName = "Flat Normal Texture";
+    loader.m_FlatNormalTexture = VulkanTexture2D::CreateFromMemory(flatNormalSpec, Buffer{flatNormal.data(), flatNormal.size()});
+}
+
+void VulkanAssetLoader::Shutdown()
+{
+    VulkanAssetLoader& loader = Get();
+    loader.WaitIdle();
+
+    loader.m_MissingTexture.reset();
+    loader.m_FlatNormalTexture.reset();
+}
+
+AssetHandle<VulkanTexture2D> VulkanAssetLoader::LoadTexture(const TextureSpecification& specification, const std::string& filepath,
+                                                            std::shared_ptr<VulkanTexture2D> placeholder)
+{
+    auto handle = AssetHandle<VulkanTexture2D>::CreatePending(placeholder ? std::move(placeholder) : m_MissingTexture);
+
+    Dispatch(filepath, [this, handle, specification, filepath]() -> DecodedAsset
+    {
+        auto texture = VulkanTexture2D::DecodeFromFile(specification, filepath);
+        // Cached textures skip the decoder entirely
+        if (texture->GetDecodeMilliseconds() > 0.0)
+            RecordDecode(texture->GetDecodeMilliseconds());
+        return
+        {
+            [texture]() { texture->Invalidate(false); },
+            [handle, texture]() { handle.Resolve(texture); },
+            [handle]() { handle.Fail(); }
+        };
+    },
+    [handle]() { handle.Fail(); });
+
+    return handle;
+}
+
+AssetHandle<VulkanModel> VulkanAssetLoader::LoadModel(const std::string& filepath, const ModelLoadOptions& options)
+{
+    auto handle = AssetHandle<VulkanModel>::CreatePending(nullptr);
+
+    Dispatch(filepath, [handle, filepath, options]() -> DecodedAsset
+    {
+        auto source = std::make_shared<ModelSource>(VulkanModel::LoadModelSource(filepath, options));
+        auto model = std::make_shared<std::shared_ptr<VulkanModel>>();
+        return
+        {
+            // The source is released with the decoded asset, mapped cache pages are copied to staging by then
+            [source, model]() { *model = VulkanModel::CreateModelFromSource(*source); },
+            [handle, model]() { handle.Resolve(*model); },
+            [handle]() { handle.Fail(); }
+        };
+    },
+    [handle]() { handle.Fail(); });
+
+    return handle;
+}
+
+void VulkanAssetLoader::Dispatch(const std::string& filepath, std::function<DecodedAsset()> decode, std::function<void()> fail)
+{
+    m_PendingCount++;
+
+    ThreadPool::Get().Submit([this, filepath, decode = std::move(decode), fail = std::move(fail)]()
+    {
+        DecodedAsset decoded{};
+        try
+        {
+            decoded = decode();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Failed to load asset '" << filepath << "': " << e.what() << "\n";
+            decoded.Fail = fail;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_DecodedMutex);
+            m_Decoded.push_back(std::move(decoded));
+        }
+        m_DecodedCondition.notify_one();
+    });
+}
+
+void VulkanAssetLoader::RecordDecode(double milliseconds)
+{
+    std::lock_guard<std::mutex> lock(m_DecodeStatsMutex);
+    m_DecodeStats.DecodedTextures++;
+    m_DecodeStats.DecodeMilliseconds += milliseconds;
+    m_DecodeStats.SlowestDecodeMilliseconds = std::max(m_DecodeStats.SlowestDecodeMilliseconds, milliseconds);
+}
+
+VulkanAssetLoader::DecodeStats VulkanAssetLoader::GetDecodeStats()
+{
+    std::lock_guard<std::mutex> lock(m_DecodeStatsMutex);
+    return m_DecodeStats;
+}
+
+void VulkanAssetLoader::ProcessUploads(uint32_t maxUploads)
+{
+    ResolveCompletedBatches();
+
+    std::vector<DecodedAsset> decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_DecodedMutex);
+        while (!m_Decoded.empty() && decoded.size() < maxUploads)
+        {
+            decoded.push_back(std::move(m_Decoded.front()));
+            m_Decoded.pop_front();
+        }
+    }
+
+    if (decoded.empty())
+        return;
+
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+    UploadBatch batch{};
+
+    transfer.BeginBatch();
+    for (DecodedAsset& asset : decoded)
+    {
+        if (!asset.Upload)
+        {
+            // Decoding failed, nothing to wait for
+            asset.Fail();
+            m_PendingCount--;
+            continue;
+        }
+
+        try
+        {
+            asset.Upload();
+            batch.Publish.push_back(std::move(asset.Publish));
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Failed to upload asset: " << e.what() << "\n";
+            asset.Fail();
+            m_PendingCount--;
+        }
+    }
+    batch.Ticket = transfer.EndBatch();
+
+    if (!batch.Publish.empty())
+        m_InFlight.push_back(std::move(batch));
+}
+
+void VulkanAssetLoader::WaitIdle()
+{
+    while (m_PendingCount.load() > 0)
+    {
+        ProcessUploads(UINT32_MAX);
+
+        if (!m_InFlight.empty())
+        {
+            VulkanTransferContext::Get().Wait(m_InFlight.back().Ticket);
+            ResolveCompletedBatches();
+            continue;
+        }
+
+        // Everything left is still being decoded
+        std::unique_lock<std::mutex> lock(m_DecodedMutex);
+        m_DecodedCondition.wait(lock, [this]() { return !m_Decoded.empty() || m_PendingCount.load() == 0; });
+    }
+}
+
+void VulkanAssetLoader::ResolveCompletedBatches()
+{
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+
+    while (!m_InFlight.empty() && transfer.IsComplete(m_InFlight.front().Ticket))
+    {
+        for (auto& publish : m_InFlight.front().Publish)
+        {
+            publish();
+            m_PendingCount--;
+        }
+        m_InFlight.pop_front();
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "core/asset_handle.h"
+#include "vulkan_model.h"
+#include "vulkan_texture.h"
+#include "vulkan_transfer_context.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Loads textures and models in the background. File reads, image decoding and mesh processing run as
+// thread pool jobs, the GPU side of every asset is created by ProcessUploads on the render thread, which
+// records them into one transfer batch per call. A handle resolves once its batch has finished executing,
+// until then it hands out its placeholder.
+class VulkanAssetLoader
+{
+public:
+    // Image decoding across all textures loaded so far. DecodeMilliseconds is summed over workers, so it exceeds
+    // wall clock time when decodes overlap.
+    struct DecodeStats
+    {
+        uint32_t DecodedTextures = 0;
+        double DecodeMilliseconds = 0.0;
+        double SlowestDecodeMilliseconds = 0.0;
+    };
+
+    static VulkanAssetLoader& Get()
+    {
+        static VulkanAssetLoader loader;
+        return loader;
+    }
+
+    // Requires the transfer context, loads the placeholder textures synchronously
+    static void Initialize();
+    static void Shutdown();
+
+    // A null placeholder falls back to the missing texture
+    AssetHandle<VulkanTexture2D> LoadTexture(const TextureSpecification& specification, const std::string& filepath,
+                                             std::shared_ptr<VulkanTexture2D> placeholder = nullptr);
+    // Objects with a model that is still loading are not drawn
+    AssetHandle<VulkanModel> LoadModel(const std::string& filepath, const ModelLoadOptions& options = {});
+
+    // Render thread only. Resolves the handles of finished batches and uploads up to maxUploads decoded assets.
+    void ProcessUploads(uint32_t maxUploads = 16);
+    // Render thread only. Blocks until every requested asset has resolved or failed.
+    void WaitIdle();
+
+    uint32_t GetPendingCount() const { return m_PendingCount.load(); }
+    DecodeStats GetDecodeStats();
+
+    const std::shared_ptr<VulkanTexture2D>& GetMissingTexture() const { return m_MissingTexture; }
+    // Tangent space +Z, for normal maps that are still loading
+    const std::shared_ptr<VulkanTexture2D>& GetFlatNormalTexture() const { return m_FlatNormalTexture; }
+
+private:
+    // Produced on a worker, Upload runs on the render thread inside a transfer batch and Publish once it has executed
+    struct DecodedAsset
+    {
+        std::function<void()> Upload;
+        std::function<void()> Publish;
+        std::function<void()> Fail;
+    };
+
+    struct UploadBatch
+    {
+        TransferTicket Ticket = 0;
+        std::vector<std::function<void()>> Publish;
+    };
+
+    VulkanAssetLoader() = default;
+
+    void Dispatch(const std::string& filepath, std::function<DecodedAsset()> decode, std::function<void()> fail);
+    void RecordDecode(double milliseconds);
+    void ResolveCompletedBatches();
+
+    std::shared_ptr<VulkanTexture2D> m_MissingTexture;
+    std::shared_ptr<VulkanTexture2D> m_FlatNormalTexture;
+
+    std::deque<DecodedAsset> m_Decoded;
+    std::mutex m_DecodedMutex;
+    std::condition_variable m_DecodedCondition;
+
+    std::deque<UploadBatch> m_InFlight;
+    // Requested and not yet resolved or failed
+    std::atomic<uint32_t> m_PendingCount = 0;
+
+    DecodeStats m_DecodeStats{};
+    std::mutex m_DecodeStatsMutex;
+};
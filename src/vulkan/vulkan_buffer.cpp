@@ -1,5 +1,6 @@
 #include "vulkan_buffer.h"
 #include "vulkan_context.h"
+#include "vulkan_transfer_context.h"
 
 #include <cassert>
 #include <ostream>
@@ -7,7 +8,8 @@
 void VulkanBuffer::CreateVkBuffer(
         VkDeviceSize size,
         VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-        VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+        MemoryCategory category,
+        VkBuffer& buffer, MemoryAllocation& allocation)
 {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -18,18 +20,7 @@ void VulkanBuffer::CreateVkBuffer(
     if (vkCreateBuffer(VulkanContext::Get().Device(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
         throw std::runtime_error("Failed to create vertex buffer!");
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(VulkanContext::Get().Device(), buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = VulkanContext::Get().FindDeviceMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(VulkanContext::Get().Device(), &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-        throw std::runtime_error("Failed to allocate vertex buffer memory!");
-
-    vkBindBufferMemory(VulkanContext::Get().Device(), buffer, bufferMemory, 0);
+    allocation = VulkanMemoryAllocator::Get().AllocateForBuffer(buffer, properties, category);
 }
 
 void VulkanBuffer::CopyBufferToImage(
@@ -38,7 +29,7 @@ void VulkanBuffer::CopyBufferToImage(
         uint32_t width, uint32_t height,
         uint32_t layerCount)
 {
-    VkCommandBuffer commandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+    VkCommandBuffer commandBuffer = VulkanTransferContext::Get().BeginRecording();
 
     VkBufferImageCopy region{};
     region.bufferOffset = 0;
@@ -61,21 +52,21 @@ void VulkanBuffer::CopyBufferToImage(
             1,
             &region);
 
-    VulkanContext::Get().EndSingleTimeCommand(commandBuffer);
+    VulkanTransferContext::Get().EndRecording();
 }
 
 
-void VulkanBuffer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+void VulkanBuffer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset)
 {
-    VkCommandBuffer commandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+    VkCommandBuffer commandBuffer = VulkanTransferContext::Get().BeginRecording();
 
     VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = 0; // Optional
-    copyRegion.dstOffset = 0; // Optional
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
     copyRegion.size = size;
     vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
-    VulkanContext::Get().EndSingleTimeCommand(commandBuffer);
+    VulkanTransferContext::Get().EndRecording();
 }
 
 VkDeviceSize VulkanBuffer::GetAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment)
@@ -92,6 +83,7 @@ VulkanBuffer::VulkanBuffer(
     uint32_t instanceCount,
     VkBufferUsageFlags usageFlags,
     VkMemoryPropertyFlags memoryPropertyFlags,
+    MemoryCategory category,
     VkDeviceSize minOffsetAlignment)
     : m_InstanceCount{instanceCount},
       m_InstanceSize{instanceSize},
@@ -100,14 +92,14 @@ VulkanBuffer::VulkanBuffer(
 {
     m_AlignmentSize = GetAlignment(instanceSize, minOffsetAlignment);
     m_BufferSize = m_AlignmentSize * instanceCount;
-    CreateVkBuffer(m_BufferSize, usageFlags, memoryPropertyFlags, m_Buffer, m_Memory);
+    CreateVkBuffer(m_BufferSize, usageFlags, memoryPropertyFlags, category, m_Buffer, m_Allocation);
 }
 
 VulkanBuffer::~VulkanBuffer()
 {
     Unmap();
     vkDestroyBuffer(VulkanContext::Get().Device(), m_Buffer, nullptr);
-    vkFreeMemory(VulkanContext::Get().Device(), m_Memory, nullptr);
+    VulkanMemoryAllocator::Get().Free(m_Allocation);
 }
 
 /**
@@ -117,12 +109,18 @@ VulkanBuffer::~VulkanBuffer()
  * buffer range.
  * @param offset (Optional) Byte offset from beginning
  *
+ * @note Host visible memory stays mapped by the allocator, this only hands out a pointer into it
+ *
  * @return VkResult of the buffer mapping call
  */
 VkResult VulkanBuffer::Map(VkDeviceSize size, VkDeviceSize offset)
 {
-    assert(m_Buffer && m_Memory && "Called map on buffer before create");
-    return vkMapMemory(VulkanContext::Get().Device(), m_Memory, offset, size, 0, &m_Mapped);
+    assert(m_Buffer && m_Allocation.IsValid() && "Called map on buffer before create");
+    if (!m_Allocation.Mapped)
+        return VK_ERROR_MEMORY_MAP_FAILED;
+
+    m_Mapped = static_cast<char*>(m_Allocation.Mapped) + offset;
+    return VK_SUCCESS;
 }
 
 /**
@@ -132,11 +130,7 @@ VkResult VulkanBuffer::Map(VkDeviceSize size, VkDeviceSize offset)
  */
 void VulkanBuffer::Unmap()
 {
-    if (m_Mapped)
-    {
-        vkUnmapMemory(VulkanContext::Get().Device(), m_Memory);
-        m_Mapped = nullptr;
-    }
+    m_Mapped = nullptr;
 }
 
 /**
@@ -177,12 +171,21 @@ void VulkanBuffer::WriteToBuffer(const void* data, VkDeviceSize size, VkDeviceSi
  */
 VkResult VulkanBuffer::Flush(VkDeviceSize size, VkDeviceSize offset) const
 {
-    VkMappedMemoryRange mappedRange = {};
-    mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    mappedRange.memory = m_Memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
-    return vkFlushMappedMemoryRanges(VulkanContext::Get().Device(), 1, &mappedRange);
+    return VulkanMemoryAllocator::Get().Flush(m_Allocation, size, offset);
+}
+
+/**
+ * Flush several memory ranges of the buffer with a single call
+ *
+ * @note Only required for non-coherent memory
+ *
+ * @param ranges Byte ranges relative to the beginning of the buffer
+ *
+ * @return VkResult of the flush call
+ */
+VkResult VulkanBuffer::Flush(const std::vector<MemoryRange>& ranges) const
+{
+    return VulkanMemoryAllocator::Get().Flush(m_Allocation, ranges);
 }
 
 /**
@@ -198,12 +201,7 @@ VkResult VulkanBuffer::Flush(VkDeviceSize size, VkDeviceSize offset) const
  */
 VkResult VulkanBuffer::Invalidate(VkDeviceSize size, VkDeviceSize offset)
 {
-    VkMappedMemoryRange mappedRange = {};
-    mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    mappedRange.memory = m_Memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
-    return vkInvalidateMappedMemoryRanges(VulkanContext::Get().Device(), 1, &mappedRange);
+    return VulkanMemoryAllocator::Get().Invalidate(m_Allocation, size, offset);
 }
 
 /**
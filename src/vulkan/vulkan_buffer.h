@@ -1,7 +1,11 @@
 #pragma once
 
+#include "vulkan_memory_allocator.h"
+
 #include <vulkan/vulkan.h>
 
+#include <vector>
+
 class VulkanBuffer
 {
 public:
@@ -10,6 +14,7 @@ public:
         uint32_t instanceCount,
         VkBufferUsageFlags usageFlags,
         VkMemoryPropertyFlags memoryPropertyFlags,
+        MemoryCategory category,
         VkDeviceSize minOffsetAlignment = 1);
 
     ~VulkanBuffer();
@@ -18,8 +23,9 @@ public:
             VkDeviceSize size,
             VkBufferUsageFlags usage,
             VkMemoryPropertyFlags properties,
+            MemoryCategory category,
             VkBuffer& buffer,
-            VkDeviceMemory& bufferMemory);
+            MemoryAllocation& allocation);
 
     static void CopyBufferToImage(
             VkBuffer buffer,
@@ -30,7 +36,9 @@ public:
     static void CopyBuffer(
             VkBuffer srcBuffer,
             VkBuffer dstBuffer,
-            VkDeviceSize size);
+            VkDeviceSize size,
+            VkDeviceSize srcOffset = 0,
+            VkDeviceSize dstOffset = 0);
 
     VulkanBuffer(const VulkanBuffer&) = delete;
     VulkanBuffer& operator=(const VulkanBuffer&) = delete;
@@ -40,6 +48,7 @@ public:
 
     void WriteToBuffer(const void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) const;
     VkResult Flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) const;
+    VkResult Flush(const std::vector<MemoryRange>& ranges) const;
     VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) const;
     VkResult Invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
@@ -52,17 +61,18 @@ public:
     void* GetMappedMemory() const { return m_Mapped; }
     uint32_t GetInstanceCount() const { return m_InstanceCount; }
     VkDeviceSize GetInstanceSize() const { return m_InstanceSize; }
-    VkDeviceSize GetAlignmentSize() const { return m_InstanceSize; }
+    VkDeviceSize GetAlignmentSize() const { return m_AlignmentSize; }
     VkBufferUsageFlags GetUsageFlags() const { return m_UsageFlags; }
     VkMemoryPropertyFlags GetMemoryPropertyFlags() const { return m_MemoryPropertyFlags; }
     VkDeviceSize GetBufferSize() const { return m_BufferSize; }
+    const MemoryAllocation& GetAllocation() const { return m_Allocation; }
 
 private:
     static VkDeviceSize GetAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
 
     void* m_Mapped = nullptr;
     VkBuffer m_Buffer = VK_NULL_HANDLE;
-    VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+    MemoryAllocation m_Allocation{};
 
     VkDeviceSize m_BufferSize;
     uint32_t m_InstanceCount;
@@ -0,0 +1,295 @@
+#include "vulkan_chunked_mesh.h"
+#include "core/engine_utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr uint64_t PayloadAlignment = 16;
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    struct ChunkLayout
+    {
+        uint64_t VertexBytes;
+        uint64_t ColorBytes;
+        uint64_t IndexBytes;
+
+        uint64_t ColorOffset() const { return AlignUp(VertexBytes, PayloadAlignment); }
+        uint64_t IndexOffset() const { return ColorOffset() + AlignUp(ColorBytes, PayloadAlignment); }
+        uint64_t Size() const { return IndexOffset() + AlignUp(IndexBytes, PayloadAlignment); }
+    };
+
+    ChunkLayout GetLayout(VertexFormat format, const VulkanChunkedMesh::Chunk& chunk)
+    {
+        return {
+            static_cast<uint64_t>(chunk.VertexCount) * VulkanModel::GetVertexStride(format),
+            format == VertexFormat::PackedColor ? static_cast<uint64_t>(chunk.VertexCount) * sizeof(uint32_t) : 0,
+            static_cast<uint64_t>(chunk.IndexCount) * sizeof(uint16_t)};
+    }
+
+    // Splits triangles on the longest axis of their centroid bounds until every leaf fits a chunk.
+    // Leaves come out in depth first order, so neighbouring chunks are neighbours in space as well.
+    std::vector<std::vector<uint32_t>> PartitionTriangles(const std::vector<glm::vec3>& centroids, uint32_t maxChunkTriangles)
+    {
+        std::vector<uint32_t> triangles(centroids.size());
+        std::iota(triangles.begin(), triangles.end(), 0u);
+
+        std::vector<std::vector<uint32_t>> leaves;
+        std::vector<std::pair<size_t, size_t>> stack{{0, triangles.size()}};
+        while (!stack.empty())
+        {
+            const auto [begin, end] = stack.back();
+            stack.pop_back();
+
+            if (end - begin <= maxChunkTriangles)
+            {
+                // Restore the optimized triangle order inside the chunk
+                std::vector<uint32_t> leaf(triangles.begin() + static_cast<ptrdiff_t>(begin), triangles.begin() + static_cast<ptrdiff_t>(end));
+                std::sort(leaf.begin(), leaf.end());
+                leaves.push_back(std::move(leaf));
+                continue;
+            }
+
+            glm::vec3 boundsMin = centroids[triangles[begin]];
+            glm::vec3 boundsMax = boundsMin;
+            for (size_t i = begin; i < end; i++)
+            {
+                boundsMin = glm::min(boundsMin, centroids[triangles[i]]);
+                boundsMax = glm::max(boundsMax, centroids[triangles[i]]);
+            }
+
+            const glm::vec3 extent = boundsMax - boundsMin;
+            const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+            const size_t middle = begin + (end - begin) / 2;
+            std::nth_element(
+                triangles.begin() + static_cast<ptrdiff_t>(begin),
+                triangles.begin() + static_cast<ptrdiff_t>(middle),
+                triangles.begin() + static_cast<ptrdiff_t>(end),
+                [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+            stack.emplace_back(middle, end);
+            stack.emplace_back(begin, middle);
+        }
+
+        return leaves;
+    }
+}
+
+std::string VulkanChunkedMesh::GetChunkedPath(const std::string& sourcePath)
+{
+    return sourcePath + ".coochunks";
+}
+
+bool VulkanChunkedMesh::Write(const std::string& path, const std::string& sourcePath, const VulkanModel::Builder& builder, uint32_t maxChunkTriangles)
+{
+    maxChunkTriangles = std::clamp(maxChunkTriangles, 1u, MaxChunkTriangles);
+
+    const uint32_t indexCount = builder.Lods.empty() ? static_cast<uint32_t>(builder.Indices.size()) : builder.Lods[0].IndexCount;
+    const uint32_t triangleCount = indexCount / 3;
+    const std::vector<VulkanModel::Vertex>& vertices = builder.Vertices;
+    if (triangleCount == 0)
+        return false;
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        centroids[triangle] = (vertices[builder.Indices[triangle * 3 + 0]].Position +
+                               vertices[builder.Indices[triangle * 3 + 1]].Position +
+                               vertices[builder.Indices[triangle * 3 + 2]].Position) / 3.0f;
+    }
+
+    const std::vector<std::vector<uint32_t>> leaves = PartitionTriangles(centroids, maxChunkTriangles);
+
+    Header header{};
+    header.Magic = Magic;
+    header.Version = Version;
+    if (!EngineUtils::GetFileStamp(sourcePath, header.SourceSize, header.SourceWriteTime))
+        return false;
+    header.Format = builder.Format;
+    header.ChunkCount = static_cast<uint32_t>(leaves.size());
+    header.Quantization = builder.Quantization;
+    header.Bounds = builder.Bounds;
+
+    const uint32_t stride = VulkanModel::GetVertexStride(builder.Format);
+    const auto* sourceVertices = builder.Format == VertexFormat::Standard
+        ? reinterpret_cast<const uint8_t*>(builder.Vertices.data())
+        : reinterpret_cast<const uint8_t*>(builder.PackedVertices.data());
+
+    // The chunk table is written last, once every payload offset is known
+    const std::string tempPath = path + ".tmp";
+    std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open())
+    {
+        std::cerr << "Unable to write chunked mesh: " << path << "\n";
+        return false;
+    }
+
+    std::vector<Chunk> chunks(leaves.size());
+    uint64_t offset = AlignUp(sizeof(Header) + sizeof(Chunk) * chunks.size(), PayloadAlignment);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+    std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<uint32_t> chunkVertices;
+    std::vector<uint16_t> chunkIndices;
+    std::vector<uint8_t> payload;
+    for (size_t chunkIndex = 0; chunkIndex < leaves.size(); chunkIndex++)
+    {
+        chunkVertices.clear();
+        chunkIndices.clear();
+        for (uint32_t triangle : leaves[chunkIndex])
+        {
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                const uint32_t vertex = builder.Indices[triangle * 3 + corner];
+                if (remap[vertex] == UINT32_MAX)
+                {
+                    remap[vertex] = static_cast<uint32_t>(chunkVertices.size());
+                    chunkVertices.push_back(vertex);
+                }
+                chunkIndices.push_back(static_cast<uint16_t>(remap[vertex]));
+            }
+        }
+
+        Chunk& chunk = chunks[chunkIndex];
+        chunk.Offset = offset;
+        chunk.VertexCount = static_cast<uint32_t>(chunkVertices.size());
+        chunk.IndexCount = static_cast<uint32_t>(chunkIndices.size());
+
+        chunk.Bounds = ComputeMeshBounds(chunkVertices.size(), [&](size_t i) { return vertices[chunkVertices[i]].Position; }).Sphere;
+
+        const ChunkLayout layout = GetLayout(builder.Format, chunk);
+        payload.assign(layout.Size(), 0);
+        for (size_t i = 0; i < chunkVertices.size(); i++)
+        {
+            std::memcpy(payload.data() + i * stride, sourceVertices + static_cast<size_t>(chunkVertices[i]) * stride, stride);
+            if (builder.Format == VertexFormat::PackedColor)
+                std::memcpy(payload.data() + layout.ColorOffset() + i * sizeof(uint32_t), &builder.PackedColors[chunkVertices[i]], sizeof(uint32_t));
+        }
+        std::memcpy(payload.data() + layout.IndexOffset(), chunkIndices.data(), layout.IndexBytes);
+
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        offset += payload.size();
+
+        for (uint32_t vertex : chunkVertices)
+            remap[vertex] = UINT32_MAX;
+    }
+
+    file.seekp(sizeof(Header));
+    file.write(reinterpret_cast<const char*>(chunks.data()), static_cast<std::streamsize>(sizeof(Chunk) * chunks.size()));
+
+    const bool written = file.good();
+    file.close();
+
+    std::error_code ec;
+    if (written)
+        fs::rename(tempPath, path, ec);
+    if (!written || ec)
+    {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanChunkedMesh::Open(const std::string& path, const std::string& sourcePath)
+{
+    std::lock_guard<std::mutex> lock(m_FileMutex);
+
+    m_Chunks.clear();
+    m_File.close();
+    m_File.clear();
+    m_File.open(path, std::ios::binary | std::ios::ate);
+    if (!m_File.is_open())
+        return false;
+
+    const auto fileSize = static_cast<uint64_t>(m_File.tellg());
+    m_File.seekg(0);
+
+    Header header{};
+    m_File.read(reinterpret_cast<char*>(&header), sizeof(Header));
+    const bool headerValid =
+        m_File.good() &&
+        header.Magic == Magic &&
+        header.Version == Version &&
+        static_cast<uint32_t>(header.Format) < static_cast<uint32_t>(VertexFormat::Count) &&
+        header.ChunkCount > 0 &&
+        sizeof(Header) + sizeof(Chunk) * static_cast<uint64_t>(header.ChunkCount) <= fileSize;
+
+    uint64_t sourceSize = 0;
+    int64_t sourceWriteTime = 0;
+    // A missing source is fine, the chunked mesh can be shipped on its own
+    const bool sourceMatches =
+        !EngineUtils::GetFileStamp(sourcePath, sourceSize, sourceWriteTime) ||
+        (sourceSize == header.SourceSize && sourceWriteTime == header.SourceWriteTime);
+
+    if (!headerValid || !sourceMatches)
+    {
+        m_File.close();
+        return false;
+    }
+
+    std::vector<Chunk> chunks(header.ChunkCount);
+    m_File.read(reinterpret_cast<char*>(chunks.data()), static_cast<std::streamsize>(sizeof(Chunk) * chunks.size()));
+
+    for (const Chunk& chunk : chunks)
+    {
+        if (!m_File.good() || chunk.IndexCount % 3 != 0 || chunk.VertexCount > 65536 ||
+            chunk.Offset > fileSize || GetLayout(header.Format, chunk).Size() > fileSize - chunk.Offset)
+        {
+            m_File.close();
+            return false;
+        }
+    }
+
+    m_Header = header;
+    m_Chunks = std::move(chunks);
+    return true;
+}
+
+bool VulkanChunkedMesh::ReadChunk(uint32_t chunkIndex, ChunkData& data) const
+{
+    const Chunk& chunk = m_Chunks[chunkIndex];
+    const ChunkLayout layout = GetLayout(m_Header.Format, chunk);
+
+    data.Vertices.resize(layout.VertexBytes);
+    data.Colors.resize(layout.ColorBytes / sizeof(uint32_t));
+    data.Indices.resize(chunk.IndexCount);
+
+    std::lock_guard<std::mutex> lock(m_FileMutex);
+
+    m_File.seekg(static_cast<std::streamoff>(chunk.Offset));
+    m_File.read(reinterpret_cast<char*>(data.Vertices.data()), static_cast<std::streamsize>(layout.VertexBytes));
+    if (layout.ColorBytes > 0)
+    {
+        m_File.seekg(static_cast<std::streamoff>(chunk.Offset + layout.ColorOffset()));
+        m_File.read(reinterpret_cast<char*>(data.Colors.data()), static_cast<std::streamsize>(layout.ColorBytes));
+    }
+    m_File.seekg(static_cast<std::streamoff>(chunk.Offset + layout.IndexOffset()));
+    m_File.read(reinterpret_cast<char*>(data.Indices.data()), static_cast<std::streamsize>(layout.IndexBytes));
+
+    if (!m_File.good())
+    {
+        m_File.clear();
+        return false;
+    }
+    return true;
+}
+
+uint64_t VulkanChunkedMesh::GetChunkSize(uint32_t chunk) const
+{
+    const ChunkLayout layout = GetLayout(m_Header.Format, m_Chunks[chunk]);
+    return layout.VertexBytes + layout.ColorBytes + layout.IndexBytes;
+}
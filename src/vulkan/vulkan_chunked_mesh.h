@@ -0,0 +1,78 @@
+#pragma once
+
+#include "vulkan_model.h"
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Binary container that splits a model into spatially compact chunks which can be read and uploaded on
+// their own. Only the header and chunk table are read on open, chunk payloads are read on demand, so the
+// file can be far larger than the memory budget. Every chunk is a small indexed mesh with its own vertices
+// and 16-bit indices, laid out as [vertices][colors][indices] at 16 byte aligned offsets.
+class VulkanChunkedMesh
+{
+public:
+    static constexpr uint32_t Magic = 0x4B4F4F43; // "COOK"
+    static constexpr uint32_t Version = 3;
+    // Three unique vertices per triangle at most, so chunks of this size always fit 16-bit indices
+    static constexpr uint32_t MaxChunkTriangles = 65535 / 3;
+    static constexpr uint32_t DefaultChunkTriangles = 16 * 1024;
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        // Size and write time of the source the chunks were built from
+        uint64_t SourceSize;
+        int64_t SourceWriteTime;
+        VertexFormat Format;
+        uint32_t ChunkCount;
+        VulkanModel::QuantizationParams Quantization;
+        MeshBounds Bounds;
+    };
+
+    struct Chunk
+    {
+        BoundingSphere Bounds;
+        uint64_t Offset;
+        uint32_t VertexCount;
+        uint32_t IndexCount;
+    };
+
+    // Payload of one chunk as read from disk
+    struct ChunkData
+    {
+        std::vector<uint8_t> Vertices;
+        std::vector<uint32_t> Colors;
+        std::vector<uint16_t> Indices;
+    };
+
+    static std::string GetChunkedPath(const std::string& sourcePath);
+
+    // Partitions LOD 0 of a processed model by recursive median splits of the triangle centroids
+    static bool Write(const std::string& path, const std::string& sourcePath, const VulkanModel::Builder& builder,
+                      uint32_t maxChunkTriangles = DefaultChunkTriangles);
+
+    // Fails when the file is missing, invalid or older than the source. A missing source is fine.
+    bool Open(const std::string& path, const std::string& sourcePath);
+    bool IsOpen() const { return !m_Chunks.empty(); }
+
+    // Thread safe, reads are serialized on the shared file handle
+    bool ReadChunk(uint32_t chunk, ChunkData& data) const;
+
+    VertexFormat GetVertexFormat() const { return m_Header.Format; }
+    const VulkanModel::QuantizationParams& GetQuantization() const { return m_Header.Quantization; }
+    const MeshBounds& GetBounds() const { return m_Header.Bounds; }
+    const std::vector<Chunk>& GetChunks() const { return m_Chunks; }
+    uint32_t GetChunkCount() const { return static_cast<uint32_t>(m_Chunks.size()); }
+    // Bytes a chunk occupies once resident, in host and in device memory alike
+    uint64_t GetChunkSize(uint32_t chunk) const;
+
+private:
+    Header m_Header{};
+    std::vector<Chunk> m_Chunks;
+    mutable std::ifstream m_File;
+    mutable std::mutex m_FileMutex;
+};
@@ -141,76 +141,10 @@ void VulkanContext::CreateComputeCommandPool()
     }
 }
 
-VkCommandBuffer VulkanContext::BeginSingleTimeCommands(QueueFamilyType family)
+void VulkanContext::WaitIdle()
 {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-    VkCommandPool pool = VK_NULL_HANDLE;
-    switch(family)
-    {
-        case QueueFamilyType::Compute:
-        {
-            pool = m_ComputeCommandPool;
-            break;
-        }
-        case QueueFamilyType::Present:
-        case QueueFamilyType::Graphics:
-        default:
-        {
-            pool = m_GraphicsCommandPool;
-            break;
-        }
-    }
-
-    allocInfo.commandPool = pool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(m_LogicalDevice.Device, &allocInfo, &commandBuffer);
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-    return commandBuffer;
-}
-
-void VulkanContext::EndSingleTimeCommand(VkCommandBuffer commandBuffer, QueueFamilyType family)
-{
-    vkEndCommandBuffer(commandBuffer);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    VkQueue queue = VK_NULL_HANDLE;
-    VkCommandPool pool = VK_NULL_HANDLE;
-    switch (family)
-    {
-        case QueueFamilyType::Compute:
-        {
-            queue = m_LogicalDevice.m_ComputeQueue;
-            pool = m_ComputeCommandPool;
-            break;
-        }
-        case QueueFamilyType::Present:
-        case QueueFamilyType::Graphics:
-        default:
-        {
-            queue = m_LogicalDevice.m_GraphicsQueue;
-            pool = m_GraphicsCommandPool;
-            break;
-        }
-    }
-
-    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(queue);
-
-    vkFreeCommandBuffers(m_LogicalDevice.Device, pool, 1, &commandBuffer);
+    std::lock_guard<std::mutex> lock(m_QueueMutex);
+    vkDeviceWaitIdle(m_LogicalDevice.Device);
 }
 
 uint32_t VulkanContext::FindDeviceMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
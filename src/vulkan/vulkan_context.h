@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan.h>
 #include <vector>
+#include <mutex>
 #include <optional>
 #include <unordered_map>
 
@@ -11,14 +12,6 @@
 #include "core/window.h"
 #include "vulkan_logical_device.h"
 
-enum class QueueFamilyType
-{
-    None = 0,
-    Graphics = 1,
-    Compute = 2,
-    Present = 3
-};
-
 class VulkanContext
 {
 public:
@@ -36,6 +29,8 @@ public:
     VkDevice Device() const { return m_LogicalDevice.Device; }
     VkPhysicalDevice PhysicalDevice() const { return m_PhysicalDevice.PhysicalDevice; }
     VkPhysicalDeviceProperties PhysicalDeviceProperties() const { return m_PhysicalDevice.PhysicalDeviceProperties; }
+    const VkPhysicalDeviceFeatures& PhysicalDeviceFeatures() const { return m_PhysicalDevice.PhysicalDeviceFeatures; }
+    bool SupportsMemoryBudget() const { return m_PhysicalDevice.SupportsMemoryBudget; }
 
     VkSurfaceKHR Surface() const { return  m_Surface; }
     VkCommandPool GraphicsCommandPool() const { return m_GraphicsCommandPool; }
@@ -49,10 +44,13 @@ public:
     VkQueue GraphicsQueue() const { return m_LogicalDevice.m_GraphicsQueue; }
     VkQueue PresentQueue() const { return m_LogicalDevice.m_PresentQueue; }
     VkQueue ComputeQueue() const { return m_LogicalDevice.m_ComputeQueue; }
+    // Queue access must be externally synchronized and the queues may share one VkQueue, so every submit,
+    // present and wait idle holds this, whichever thread it comes from
+    std::mutex& QueueMutex() { return m_QueueMutex; }
+    // vkDeviceWaitIdle under the queue mutex
+    void WaitIdle();
 
 public:
-    VkCommandBuffer BeginSingleTimeCommands(QueueFamilyType family = QueueFamilyType::Graphics);
-    void EndSingleTimeCommand(VkCommandBuffer commandBuffer, QueueFamilyType family = QueueFamilyType::Graphics);
     uint32_t FindDeviceMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     VkFormat SelectSupportedFormat(
             const std::vector<VkFormat> &candidates,
@@ -84,6 +82,7 @@ private:
     VkCommandPool m_GraphicsCommandPool{};
     VkCommandPool m_ComputeCommandPool{};
     std::vector<uint32_t> m_QueueFamilyIndices{};
+    std::mutex m_QueueMutex;
 
     const std::vector<const char *> m_DeviceExtensions =
     {
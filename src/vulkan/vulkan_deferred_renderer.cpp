@@ -1,10 +1,12 @@
 #include "vulkan_deferred_renderer.h"
 
 #include "core/platform_path.h"
+#include "vulkan_geometry_pool.h"
 #include "vulkan_model.h"
 #include "vulkan_renderer.h"
 #include "vulkan_utils.h"
 
+#include <optional>
 #include <vulkan/vulkan.h>
 
 VulkanDeferredRenderer::VulkanDeferredRenderer(VulkanRenderer* renderer) : m_Renderer(renderer)
@@ -68,8 +70,8 @@ void VulkanDeferredRenderer::Shutdown()
 	m_CompositionPass = nullptr;
 
 	// Pipelines
-	m_GBufferPipeline.reset();
-	m_GBufferPipeline = nullptr;
+	for (auto& pipeline : m_GBufferPipelines)
+		pipeline.reset();
 
 	m_LightingPipeline.reset();
 	m_LightingPipeline = nullptr;
@@ -102,8 +104,8 @@ void VulkanDeferredRenderer::Shutdown()
 	m_FullScreenQuadVertexShader.reset();
 	m_FullScreenQuadVertexShader = nullptr;
 
-	m_GBufferVertexShader.reset();
-	m_GBufferVertexShader = nullptr;
+	for (auto& shader : m_GBufferVertexShaders)
+		shader.reset();
 
 	m_GBufferFragmentShader.reset();
 	m_GBufferFragmentShader = nullptr;
@@ -168,7 +170,12 @@ void VulkanDeferredRenderer::CreateShaders()
 	auto compositionFragPath = FileSystemUtil::PathToString(shaderDirectory / "texture_display.frag");
 
 	m_FullScreenQuadVertexShader = std::make_shared<VulkanShader>(fsqPath, ShaderType::Vertex);
-	m_GBufferVertexShader = std::make_shared<VulkanShader>(gBufferVertPath, ShaderType::Vertex);
+	m_GBufferVertexShaders[static_cast<size_t>(VertexFormat::Standard)] =
+		std::make_shared<VulkanShader>(gBufferVertPath, ShaderType::Vertex);
+	m_GBufferVertexShaders[static_cast<size_t>(VertexFormat::Packed)] =
+		std::make_shared<VulkanShader>(gBufferVertPath, ShaderType::Vertex, std::vector<std::string>{"PACKED_VERTEX"});
+	m_GBufferVertexShaders[static_cast<size_t>(VertexFormat::PackedColor)] =
+		std::make_shared<VulkanShader>(gBufferVertPath, ShaderType::Vertex, std::vector<std::string>{"PACKED_VERTEX", "VERTEX_COLOR"});
 	m_GBufferFragmentShader = std::make_shared<VulkanShader>(gBufferFragPath, ShaderType::Fragment);
 	m_LightingFragmentShader = std::make_shared<VulkanShader>(lightingFragPath, ShaderType::Fragment);
 	m_CompositionFragmentShader = std::make_shared<VulkanShader>(compositionFragPath, ShaderType::Fragment);
@@ -176,7 +183,10 @@ void VulkanDeferredRenderer::CreateShaders()
 
 void VulkanDeferredRenderer::CreateMaterials()
 {
-	m_GBufferMaterialLayout = std::make_shared<VulkanMaterialLayout>(m_GBufferVertexShader, m_GBufferFragmentShader);
+	// Every object draws from one buffer of per-object data, selected with a dynamic offset
+	m_GBufferMaterialLayout = std::make_shared<VulkanMaterialLayout>(
+		m_GBufferVertexShaders[static_cast<size_t>(VertexFormat::Standard)], m_GBufferFragmentShader,
+		std::vector<VulkanMaterialLayout::DescriptorBinding>{{.set = 1, .binding = 0}});
 	m_GBufferBaseMaterial = std::make_shared<VulkanMaterial>(m_GBufferMaterialLayout);
 
 	m_LightingMaterialLayout = std::make_shared<VulkanMaterialLayout>(m_FullScreenQuadVertexShader, m_LightingFragmentShader);
@@ -189,7 +199,8 @@ void VulkanDeferredRenderer::CreateMaterials()
 void VulkanDeferredRenderer::InvalidateGBufferPass()
 {
 	m_GBufferPass.reset();
-	m_GBufferPipeline.reset();
+	for (auto& pipeline : m_GBufferPipelines)
+		pipeline.reset();
 	m_GBufferFramebuffers.clear();
 
 	CreateGBufferRenderPass();
@@ -354,19 +365,23 @@ void VulkanDeferredRenderer::CreateGBufferRenderPass()
 
 void VulkanDeferredRenderer::CreateGBufferPipeline()
 {
-	auto builder = VulkanGraphicsPipelineBuilder("G-Buffer Pipeline")
-					   .SetShaders(m_GBufferVertexShader, m_GBufferFragmentShader)
-					   .SetVertexInputDescription(
-						   {VulkanModel::Vertex::GetBindingDescriptions(), VulkanModel::Vertex::GetAttributeDescriptions()})
-					   .SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-					   .SetPolygonMode(VK_POLYGON_MODE_FILL)
-					   .SetCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE)
-					   .SetMultisampling(VK_SAMPLE_COUNT_1_BIT)
-					   .SetDepthTesting(true, true, VK_COMPARE_OP_LESS_OR_EQUAL)
-					   .SetRenderPass(m_GBufferPass.get())
-					   .SetLayout(m_GBufferMaterialLayout->GetPipelineLayout());
-
-	m_GBufferPipeline = builder.Build();
+	// Every vertex format shares the material layout, only the vertex input and shader variant differ
+	for (size_t i = 0; i < m_GBufferPipelines.size(); i++)
+	{
+		auto format = static_cast<VertexFormat>(i);
+		auto builder = VulkanGraphicsPipelineBuilder("G-Buffer Pipeline " + std::to_string(i))
+						   .SetShaders(m_GBufferVertexShaders[i], m_GBufferFragmentShader)
+						   .SetVertexInputDescription(VulkanModel::GetVertexInputDescription(format))
+						   .SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+						   .SetPolygonMode(VK_POLYGON_MODE_FILL)
+						   .SetCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE)
+						   .SetMultisampling(VK_SAMPLE_COUNT_1_BIT)
+						   .SetDepthTesting(true, true, VK_COMPARE_OP_LESS_OR_EQUAL)
+						   .SetRenderPass(m_GBufferPass.get())
+						   .SetLayout(m_GBufferMaterialLayout->GetPipelineLayout());
+
+		m_GBufferPipelines[i] = builder.Build();
+	}
 }
 
 void VulkanDeferredRenderer::CreateGBufferFramebuffers()
@@ -641,6 +656,7 @@ void VulkanDeferredRenderer::SubmitRenderPasses(uint32_t frameIndex)
 	gBufferSubmitInfo.commandBufferCount = 1;
 	gBufferSubmitInfo.pCommandBuffers = &m_GBufferCommandBuffers[frameIndex];
 
+	std::lock_guard<std::mutex> lock(VulkanContext::Get().QueueMutex());
 	vkQueueSubmit(VulkanContext::Get().GraphicsQueue(), 1, &gBufferSubmitInfo, VK_NULL_HANDLE);
 
 	// Submit Lighting pass
@@ -689,12 +705,47 @@ void VulkanDeferredRenderer::RecordGBufferCommandBuffer(FrameInfo& frameInfo)
 	auto attachmentExtent = VkExtent2D{m_GBufferFramebuffers[frameIndex]->Width(), m_GBufferFramebuffers[frameIndex]->Height()};
 	gBufferRenderPassInfo.renderArea.extent = attachmentExtent;
 
-	m_GBufferPipeline->Bind(gBufferCmd);
+	RenderView view{};
+	view.CameraPosition = frameInfo.Cam.GetPosition();
+	view.LodScale = glm::abs(frameInfo.Cam.GetProjection()[1][1]) * 0.5f * static_cast<float>(attachmentExtent.height);
+
 	m_GBufferPass->BeginPass(gBufferCmd, gBufferRenderPassInfo, attachmentExtent);
+	VulkanGraphicsPipeline* boundPipeline = nullptr;
+	std::optional<GeometryBinding> boundGeometry;
 	for (auto& [id, gameObject] : frameInfo.ActiveScene.GameObjects)
 	{
+		const auto& streamingModel = gameObject.StreamingModel;
+
+		// Still loading, there is no placeholder geometry
+		if (!streamingModel && !gameObject.ObjectModel)
+			continue;
+
+		const VertexFormat format = streamingModel ? streamingModel->GetVertexFormat() : gameObject.ObjectModel->GetVertexFormat();
+		auto* pipeline = m_GBufferPipelines[static_cast<size_t>(format)].get();
+		if (pipeline != boundPipeline)
+		{
+			pipeline->Bind(gBufferCmd);
+			boundPipeline = pipeline;
+		}
+
+		if (streamingModel)
+		{
+			// Binds the geometry of each resident chunk itself
+			boundGeometry.reset();
+		}
+		else
+		{
+			// Models share a handful of pool buffers, so most draws reuse the bound geometry
+			const GeometryBinding geometry = gameObject.ObjectModel->GetGeometryBinding();
+			if (geometry != boundGeometry)
+			{
+				VulkanGeometryPool::Get().Bind(gBufferCmd, geometry);
+				boundGeometry = geometry;
+			}
+		}
+
 		auto globalUbo = frameInfo.GlobalUbo.lock();
-		gameObject.Render(gBufferCmd, frameIndex, globalUbo->DescriptorInfo());
+		gameObject.Render(gBufferCmd, frameIndex, globalUbo->DescriptorInfo(), view);
 	}
 	m_GBufferPass->EndPass(gBufferCmd);
 
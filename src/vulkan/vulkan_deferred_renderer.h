@@ -7,8 +7,11 @@
 #include "vulkan_image.h"
 #include "vulkan_material.h"
 #include "vulkan_render_pass.h"
+#include "vulkan_model.h"
 #include "vulkan_texture.h"
 
+#include <array>
+
 class VulkanRenderer;
 class VulkanDeferredRenderer : public IRenderer
 {
@@ -82,11 +85,12 @@ private:
     std::unique_ptr<VulkanRenderPass> m_LightingPass;
     std::unique_ptr<VulkanRenderPass> m_CompositionPass;
 
-    std::unique_ptr<VulkanGraphicsPipeline> m_GBufferPipeline;
+    // One G-Buffer pipeline per VertexFormat, indexed by the format
+    std::array<std::unique_ptr<VulkanGraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> m_GBufferPipelines;
     std::unique_ptr<VulkanGraphicsPipeline> m_LightingPipeline;
     std::unique_ptr<VulkanGraphicsPipeline> m_CompositionPipeline;
 
-    std::shared_ptr<VulkanShader> m_GBufferVertexShader;
+    std::array<std::shared_ptr<VulkanShader>, static_cast<size_t>(VertexFormat::Count)> m_GBufferVertexShaders;
     std::shared_ptr<VulkanShader> m_GBufferFragmentShader;
 
     std::shared_ptr<VulkanShader> m_FullScreenQuadVertexShader;
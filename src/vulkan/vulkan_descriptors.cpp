@@ -102,6 +102,7 @@ VulkanDescriptorPool::VulkanDescriptorPool(
     uint32_t maxSets,
     VkDescriptorPoolCreateFlags poolFlags,
     const std::vector<VkDescriptorPoolSize>& poolSizes)
+    : m_MaxSets(maxSets)
 {
     VkDescriptorPoolCreateInfo descriptorPoolInfo{};
     descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -114,11 +115,16 @@ VulkanDescriptorPool::VulkanDescriptorPool(
     {
         throw std::runtime_error("failed to create descriptor pool!");
     }
+
+    m_LivePoolCount++;
+    m_ReservedSetCount += m_MaxSets;
 }
 
 VulkanDescriptorPool::~VulkanDescriptorPool()
 {
     vkDestroyDescriptorPool(VulkanContext::Get().Device(), m_DescriptorPool, nullptr);
+    m_LivePoolCount--;
+    m_ReservedSetCount -= m_MaxSets;
 }
 
 bool VulkanDescriptorPool::AllocateDescriptor(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor) const
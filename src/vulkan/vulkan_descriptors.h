@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -68,8 +69,16 @@ public:
     void FreeDescriptors(std::vector<VkDescriptorSet>& descriptors) const;
     void ResetPool();
 
+    // Descriptor pool memory belongs to the driver, the memory telemetry only reports how much is reserved
+    static uint32_t GetLivePoolCount() { return m_LivePoolCount; }
+    static uint64_t GetReservedSetCount() { return m_ReservedSetCount; }
+
 private:
     VkDescriptorPool m_DescriptorPool{};
+    uint32_t m_MaxSets = 0;
+
+    inline static std::atomic<uint32_t> m_LivePoolCount = 0;
+    inline static std::atomic<uint64_t> m_ReservedSetCount = 0;
 
     friend class VulkanDescriptorWriter;
 };
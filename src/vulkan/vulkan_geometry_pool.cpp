@@ -0,0 +1,272 @@
+#include "vulkan_geometry_pool.h"
+#include "vulkan_model.h"
+#include "vulkan_staging_ring.h"
+#include "vulkan_swapchain.h"
+#include "vulkan_transfer_context.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    constexpr VkDeviceSize VertexBlockSize = 64ull * 1024 * 1024;
+    constexpr VkDeviceSize IndexBlockSize = 32ull * 1024 * 1024;
+}
+
+VulkanGeometryArena::VulkanGeometryArena(std::string debugName, std::vector<uint32_t> streamStrides, VkBufferUsageFlags usage, VkDeviceSize blockSize)
+    : m_DebugName(std::move(debugName)), m_Strides(std::move(streamStrides)), m_Usage(usage)
+{
+    const uint32_t elementSize = std::accumulate(m_Strides.begin(), m_Strides.end(), 0u);
+    m_BlockCapacity = static_cast<uint32_t>(std::min<VkDeviceSize>(blockSize / elementSize, UINT32_MAX));
+}
+
+GeometryAllocation VulkanGeometryArena::Allocate(uint32_t count)
+{
+    if (count == 0)
+        return {};
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // First fit, blocks are tried in creation order so older blocks fill up before new ones are touched
+    for (uint32_t blockIndex = 0; blockIndex < m_Blocks.size(); blockIndex++)
+    {
+        auto& freeRanges = m_Blocks[blockIndex].FreeRanges;
+        for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+        {
+            if (it->Count < count)
+                continue;
+
+            GeometryAllocation allocation{blockIndex, it->Offset, count};
+            it->Offset += count;
+            it->Count -= count;
+            if (it->Count == 0)
+                freeRanges.erase(it);
+
+            m_UsedElements += count;
+            return allocation;
+        }
+    }
+
+    const uint32_t blockIndex = CreateBlock(count);
+    auto& freeRanges = m_Blocks[blockIndex].FreeRanges;
+    GeometryAllocation allocation{blockIndex, 0, count};
+    freeRanges.front().Offset += count;
+    freeRanges.front().Count -= count;
+    if (freeRanges.front().Count == 0)
+        freeRanges.clear();
+
+    m_UsedElements += count;
+    return allocation;
+}
+
+void VulkanGeometryArena::Free(const GeometryAllocation& allocation)
+{
+    if (!allocation.IsValid() || allocation.Count == 0)
+        return;
+
+    // Frames up to the current one may have been recorded with the range, the current one finishes at the latest
+    // while the render thread waits for its fence MAX_FRAMES_IN_FLIGHT frames from now
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_PendingFrees.push_back({allocation, m_Frame + VulkanSwapchain::MAX_FRAMES_IN_FLIGHT + 1});
+}
+
+void VulkanGeometryArena::BeginFrame()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Frame++;
+
+    std::erase_if(m_PendingFrees, [&](const PendingFree& pending)
+    {
+        if (m_Frame < pending.ReleaseFrame)
+            return false;
+
+        Release(pending.Allocation);
+        return true;
+    });
+}
+
+void VulkanGeometryArena::ReleaseAllPendingFrees()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const PendingFree& pending : m_PendingFrees)
+        Release(pending.Allocation);
+    m_PendingFrees.clear();
+}
+
+void VulkanGeometryArena::Release(const GeometryAllocation& allocation)
+{
+    auto& freeRanges = m_Blocks[allocation.Block].FreeRanges;
+    auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), allocation.Offset,
+                                 [](const FreeRange& range, uint32_t offset) { return range.Offset < offset; });
+    auto it = freeRanges.insert(next, {allocation.Offset, allocation.Count});
+
+    // Merge with the following range, then with the preceding one
+    if (auto following = std::next(it); following != freeRanges.end() && it->Offset + it->Count == following->Offset)
+    {
+        it->Count += following->Count;
+        freeRanges.erase(following);
+    }
+    if (it != freeRanges.begin())
+    {
+        auto preceding = std::prev(it);
+        if (preceding->Offset + preceding->Count == it->Offset)
+        {
+            preceding->Count += it->Count;
+            freeRanges.erase(it);
+        }
+    }
+
+    m_UsedElements -= allocation.Count;
+}
+
+void VulkanGeometryArena::Upload(const GeometryAllocation& allocation, uint32_t stream, const void* data)
+{
+    if (!allocation.IsValid() || allocation.Count == 0)
+        return;
+
+    const uint32_t stride = m_Strides[stream];
+    const VkDeviceSize size = static_cast<VkDeviceSize>(stride) * allocation.Count;
+
+    VulkanStagingRing::Get().UploadToBuffer(
+            GetBuffer(allocation.Block, stream),
+            static_cast<VkDeviceSize>(stride) * allocation.Offset,
+            data,
+            size);
+}
+
+VkBuffer VulkanGeometryArena::GetBuffer(uint32_t block, uint32_t stream) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Blocks[block].Streams[stream]->GetBuffer();
+}
+
+uint32_t VulkanGeometryArena::CreateBlock(uint32_t minimumCapacity)
+{
+    // Meshes bigger than a block get a block of their own
+    const uint32_t capacity = std::max(m_BlockCapacity, minimumCapacity);
+
+    Block block{};
+    block.Capacity = capacity;
+    block.FreeRanges.push_back({0, capacity});
+    for (uint32_t stride : m_Strides)
+    {
+        block.Streams.push_back(std::make_unique<VulkanBuffer>(
+            stride,
+            capacity,
+            m_Usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            MemoryCategory::Geometry));
+    }
+
+    // Block growth shows up in the allocator's Geometry category stats
+    m_Blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(m_Blocks.size() - 1);
+}
+
+void VulkanGeometryPool::Initialize()
+{
+    VulkanGeometryPool& pool = Get();
+
+    pool.m_VertexArenas.resize(static_cast<size_t>(VertexFormat::Count));
+    pool.m_VertexArenas[static_cast<size_t>(VertexFormat::Standard)] = std::make_unique<VulkanGeometryArena>(
+        "Standard Vertices", std::vector<uint32_t>{sizeof(VulkanModel::Vertex)}, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VertexBlockSize);
+    pool.m_VertexArenas[static_cast<size_t>(VertexFormat::Packed)] = std::make_unique<VulkanGeometryArena>(
+        "Packed Vertices", std::vector<uint32_t>{sizeof(VulkanModel::PackedVertex)}, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VertexBlockSize);
+    pool.m_VertexArenas[static_cast<size_t>(VertexFormat::PackedColor)] = std::make_unique<VulkanGeometryArena>(
+        "Packed Color Vertices", std::vector<uint32_t>{sizeof(VulkanModel::PackedVertex), sizeof(uint32_t)}, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VertexBlockSize);
+
+    pool.m_Index16Arena = std::make_unique<VulkanGeometryArena>(
+        "16-bit Indices", std::vector<uint32_t>{sizeof(uint16_t)}, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, IndexBlockSize);
+    pool.m_Index32Arena = std::make_unique<VulkanGeometryArena>(
+        "32-bit Indices", std::vector<uint32_t>{sizeof(uint32_t)}, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, IndexBlockSize);
+}
+
+void VulkanGeometryPool::Shutdown()
+{
+    VulkanGeometryPool& pool = Get();
+
+    // The device is idle, nothing reads the pending ranges anymore
+    for (auto& arena : pool.m_VertexArenas)
+        arena->ReleaseAllPendingFrees();
+    pool.m_Index16Arena->ReleaseAllPendingFrees();
+    pool.m_Index32Arena->ReleaseAllPendingFrees();
+
+    pool.m_VertexArenas.clear();
+    pool.m_Index16Arena.reset();
+    pool.m_Index32Arena.reset();
+}
+
+GeometryAllocation VulkanGeometryPool::AllocateVertices(VertexFormat format, uint32_t vertexCount)
+{
+    return GetVertexArena(format).Allocate(vertexCount);
+}
+
+GeometryAllocation VulkanGeometryPool::AllocateIndices(VkIndexType indexType, uint32_t indexCount)
+{
+    return GetIndexArena(indexType).Allocate(indexCount);
+}
+
+void VulkanGeometryPool::FreeVertices(VertexFormat format, const GeometryAllocation& allocation)
+{
+    GetVertexArena(format).Free(allocation);
+}
+
+void VulkanGeometryPool::FreeIndices(VkIndexType indexType, const GeometryAllocation& allocation)
+{
+    GetIndexArena(indexType).Free(allocation);
+}
+
+void VulkanGeometryPool::BeginFrame()
+{
+    for (auto& arena : m_VertexArenas)
+        arena->BeginFrame();
+    m_Index16Arena->BeginFrame();
+    m_Index32Arena->BeginFrame();
+}
+
+void VulkanGeometryPool::UploadVertices(VertexFormat format, const GeometryAllocation& allocation, uint32_t stream, const void* data)
+{
+    GetVertexArena(format).Upload(allocation, stream, data);
+}
+
+void VulkanGeometryPool::UploadIndices(VkIndexType indexType, const GeometryAllocation& allocation, const void* data)
+{
+    GetIndexArena(indexType).Upload(allocation, 0, data);
+}
+
+void VulkanGeometryPool::Bind(VkCommandBuffer commandBuffer, const GeometryBinding& binding) const
+{
+    const VulkanGeometryArena& vertexArena = GetVertexArena(binding.Format);
+    if (binding.VertexBlock != GeometryAllocation::InvalidBlock)
+    {
+        std::array<VkBuffer, 2> buffers{};
+        std::array<VkDeviceSize, 2> offsets{};
+        for (uint32_t stream = 0; stream < vertexArena.GetStreamCount(); stream++)
+            buffers[stream] = vertexArena.GetBuffer(binding.VertexBlock, stream);
+
+        vkCmdBindVertexBuffers(commandBuffer, 0, vertexArena.GetStreamCount(), buffers.data(), offsets.data());
+    }
+
+    if (binding.IndexBlock != GeometryAllocation::InvalidBlock)
+    {
+        vkCmdBindIndexBuffer(commandBuffer, GetIndexArena(binding.IndexType).GetBuffer(binding.IndexBlock, 0), 0, binding.IndexType);
+    }
+}
+
+VulkanGeometryArena& VulkanGeometryPool::GetVertexArena(VertexFormat format) const
+{
+    const auto index = static_cast<size_t>(format);
+    if (index >= m_VertexArenas.size() || !m_VertexArenas[index])
+        throw std::runtime_error("Geometry pool used before VulkanGeometryPool::Initialize");
+    return *m_VertexArenas[index];
+}
+
+VulkanGeometryArena& VulkanGeometryPool::GetIndexArena(VkIndexType indexType) const
+{
+    const auto& arena = indexType == VK_INDEX_TYPE_UINT16 ? m_Index16Arena : m_Index32Arena;
+    if (!arena)
+        throw std::runtime_error("Geometry pool used before VulkanGeometryPool::Initialize");
+    return *arena;
+}
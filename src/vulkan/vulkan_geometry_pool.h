@@ -0,0 +1,134 @@
+#pragma once
+
+#include "vulkan_buffer.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class VertexFormat : uint32_t;
+
+// Range of elements suballocated from one block of a geometry arena
+struct GeometryAllocation
+{
+    static constexpr uint32_t InvalidBlock = ~0u;
+
+    uint32_t Block = InvalidBlock;
+    uint32_t Offset = 0;    // In elements, becomes the base vertex or first index of a draw
+    uint32_t Count = 0;
+
+    bool IsValid() const { return Block != InvalidBlock; }
+};
+
+// Everything that has to be bound before drawing a model, draws that share it need no rebinding
+struct GeometryBinding
+{
+    VertexFormat Format{};
+    uint32_t VertexBlock = GeometryAllocation::InvalidBlock;
+    VkIndexType IndexType = VK_INDEX_TYPE_UINT32;
+    uint32_t IndexBlock = GeometryAllocation::InvalidBlock;
+
+    bool operator==(const GeometryBinding& other) const = default;
+};
+
+// Suballocates fixed stride elements from a few large device local buffers. Every block holds one buffer per
+// stream and all streams share element offsets, so a packed vertex and its color use the same base vertex.
+// Allocation and freeing may happen on any thread, models are released wherever their last reference goes.
+// Frames still in flight may draw from freed ranges, so they only become reusable MAX_FRAMES_IN_FLIGHT + 1
+// BeginFrame calls later.
+class VulkanGeometryArena
+{
+public:
+    VulkanGeometryArena(std::string debugName, std::vector<uint32_t> streamStrides, VkBufferUsageFlags usage, VkDeviceSize blockSize);
+
+    VulkanGeometryArena(const VulkanGeometryArena&) = delete;
+    VulkanGeometryArena& operator=(const VulkanGeometryArena&) = delete;
+
+    GeometryAllocation Allocate(uint32_t count);
+    void Free(const GeometryAllocation& allocation);
+    // Render thread, once per frame. Returns the ranges no frame in flight can still read to the free lists.
+    void BeginFrame();
+    // Device must be idle
+    void ReleaseAllPendingFrees();
+    void Upload(const GeometryAllocation& allocation, uint32_t stream, const void* data);
+
+    VkBuffer GetBuffer(uint32_t block, uint32_t stream) const;
+    uint32_t GetStreamCount() const { return static_cast<uint32_t>(m_Strides.size()); }
+    uint32_t GetBlockCount() const { return static_cast<uint32_t>(m_Blocks.size()); }
+    uint64_t GetUsedElementCount() const { return m_UsedElements; }
+
+private:
+    struct FreeRange
+    {
+        uint32_t Offset;
+        uint32_t Count;
+    };
+
+    struct Block
+    {
+        std::vector<std::unique_ptr<VulkanBuffer>> Streams;
+        uint32_t Capacity = 0;
+        // Sorted by offset and coalesced on free
+        std::vector<FreeRange> FreeRanges;
+    };
+
+    struct PendingFree
+    {
+        GeometryAllocation Allocation;
+        uint64_t ReleaseFrame;
+    };
+
+    uint32_t CreateBlock(uint32_t minimumCapacity);
+    // Caller holds m_Mutex
+    void Release(const GeometryAllocation& allocation);
+
+    std::string m_DebugName;
+    std::vector<uint32_t> m_Strides;
+    VkBufferUsageFlags m_Usage;
+    uint32_t m_BlockCapacity;
+
+    std::vector<Block> m_Blocks;
+    std::vector<PendingFree> m_PendingFrees;
+    uint64_t m_Frame = 0;
+    uint64_t m_UsedElements = 0;
+    mutable std::mutex m_Mutex;
+};
+
+// Owns one arena per vertex format and index type. Models allocate their geometry here instead of
+// creating their own buffers, which keeps the allocation count low and lets draws share bindings.
+class VulkanGeometryPool
+{
+public:
+    static VulkanGeometryPool& Get()
+    {
+        static VulkanGeometryPool pool;
+        return pool;
+    }
+
+    static void Initialize();
+    static void Shutdown();
+
+    GeometryAllocation AllocateVertices(VertexFormat format, uint32_t vertexCount);
+    GeometryAllocation AllocateIndices(VkIndexType indexType, uint32_t indexCount);
+    void FreeVertices(VertexFormat format, const GeometryAllocation& allocation);
+    void FreeIndices(VkIndexType indexType, const GeometryAllocation& allocation);
+    // Render thread, once per frame before anything is recorded, see VulkanGeometryArena
+    void BeginFrame();
+
+    void UploadVertices(VertexFormat format, const GeometryAllocation& allocation, uint32_t stream, const void* data);
+    void UploadIndices(VkIndexType indexType, const GeometryAllocation& allocation, const void* data);
+
+    void Bind(VkCommandBuffer commandBuffer, const GeometryBinding& binding) const;
+
+private:
+    VulkanGeometryPool() = default;
+
+    VulkanGeometryArena& GetVertexArena(VertexFormat format) const;
+    VulkanGeometryArena& GetIndexArena(VkIndexType indexType) const;
+
+    // Indexed by VertexFormat
+    std::vector<std::unique_ptr<VulkanGeometryArena>> m_VertexArenas;
+    std::unique_ptr<VulkanGeometryArena> m_Index16Arena;
+    std::unique_ptr<VulkanGeometryArena> m_Index32Arena;
+};
@@ -2,28 +2,22 @@
 
 #include "vulkan_context.h"
 #include "vulkan_sampler_builder.h"
+#include "vulkan_sampler_cache.h"
+#include "vulkan_transfer_context.h"
 #include "vulkan_utils.h"
 
+#include <algorithm>
 #include <utility>
 
 void VulkanImage2D::CreateVkImageWithInfo(const VkImageCreateInfo &imageInfo,
                                           VkMemoryPropertyFlags properties,
+                                          MemoryCategory category,
+                                          bool dedicated,
                                           VkImage &image,
-                                          VkDeviceMemory &imageMemory)
+                                          MemoryAllocation &allocation)
 {
-    auto device = VulkanContext::Get().Device();
-    VK_CHECK_RESULT(vkCreateImage(device, &imageInfo, nullptr, &image));
-
-    VkMemoryRequirements memRequirements;
-    vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = VulkanContext::Get().FindDeviceMemoryType(memRequirements.memoryTypeBits, properties);
-
-    VK_CHECK_RESULT(vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory));
-    VK_CHECK_RESULT(vkBindImageMemory(device, image, imageMemory, 0));
+    VK_CHECK_RESULT(vkCreateImage(VulkanContext::Get().Device(), &imageInfo, nullptr, &image));
+    allocation = VulkanMemoryAllocator::Get().AllocateForImage(image, properties, imageInfo.tiling, category, dedicated);
 }
 
 VulkanImage2D::VulkanImage2D(ImageSpecification specification)
@@ -45,7 +39,7 @@ void VulkanImage2D::Release()
 
     if (m_Sampler != VK_NULL_HANDLE)
     {
-        vkDestroySampler(VulkanContext::Get().Device(), m_Sampler, nullptr);
+        VulkanSamplerCache::Get().Release(m_Sampler);
         m_Sampler = VK_NULL_HANDLE;
     }
 
@@ -58,13 +52,10 @@ void VulkanImage2D::Release()
         }
     }
 
-    if (m_DeviceMemory != VK_NULL_HANDLE)
+    if (m_Allocation.IsValid())
     {
         if(m_Specification.Usage != ImageUsage::Swapchain)
-        {
-            vkFreeMemory(VulkanContext::Get().Device(), m_DeviceMemory, nullptr);
-			m_DeviceMemory = VK_NULL_HANDLE;
-        }
+            VulkanMemoryAllocator::Get().Free(m_Allocation);
     }
 }
 
@@ -78,7 +69,7 @@ void VulkanImage2D::ReleaseSwapchainResources()
 
 	// The image and device memory will be freed by the implementation.
 	m_Image = VK_NULL_HANDLE;
-	m_DeviceMemory = VK_NULL_HANDLE;
+	m_Allocation = {};
 }
 
 void VulkanImage2D::Invalidate()
@@ -101,9 +92,9 @@ void VulkanImage2D::Invalidate()
         }
 
         VkImageLayout initialLayout = DetermineInitialLayout();
-        VkCommandBuffer commandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+        VkCommandBuffer commandBuffer = VulkanTransferContext::Get().BeginRecording();
         TransitionLayout(commandBuffer, initialLayout, 0, m_Specification.Mips);
-        VulkanContext::Get().EndSingleTimeCommand(commandBuffer);
+        VulkanTransferContext::Get().EndRecording();
     }
 
     CreateImageView(0);
@@ -136,7 +127,11 @@ void VulkanImage2D::CreateImage()
     imageCreateInfo.usage = usage;
 
     SetupImageSharingMode(imageCreateInfo);
-    CreateVkImageWithInfo(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Image, m_DeviceMemory);
+    const bool dedicated = m_Specification.Usage == ImageUsage::Attachment || m_Specification.Usage == ImageUsage::Storage;
+    const MemoryCategory category = m_Specification.Usage == ImageUsage::Texture ? MemoryCategory::Textures
+                                  : dedicated ? MemoryCategory::Attachments
+                                  : MemoryCategory::Other;
+    CreateVkImageWithInfo(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, category, dedicated, m_Image, m_Allocation);
     SetDebugUtilsObjectName(VulkanContext::Get().Device(), VK_OBJECT_TYPE_IMAGE, (uint64_t)m_Image, m_Specification.DebugName.c_str());
 }
 
@@ -208,7 +203,7 @@ void VulkanImage2D::CreateSampler()
 		.SetMipmapMode(m_Specification.SamplerSpec.MipMapMode)
 		.SetAddressMode(m_Specification.SamplerSpec.AddressModeU, m_Specification.SamplerSpec.AddressModeV, m_Specification.SamplerSpec.AddressModeW);
 
-	m_Sampler = builder.Build();
+	m_Sampler = VulkanSamplerCache::Get().Acquire(builder);
 }
 
 VulkanImageView* VulkanImage2D::GetView(uint32_t mip)
@@ -251,6 +246,8 @@ void VulkanImage2D::CreateImageView(uint32_t mip)
     VkImageView imageView;
     VK_CHECK_RESULT(vkCreateImageView(VulkanContext::Get().Device(), &viewInfo, nullptr, &imageView));
     view->SetImageView(imageView);
+    // Views created on demand start out describing the layout their base level is in
+    view->UpdateDescriptorInfo(m_MipLayouts.empty() ? m_CurrentLayout : m_MipLayouts[mip], m_Sampler);
     m_MipViews[mip] = std::move(view);
 }
 
@@ -275,7 +272,7 @@ void VulkanImage2D::Resize(uint32_t width, uint32_t height)
 
 void VulkanImage2D::CopyFromBufferAndGenerateMipmaps(VkBuffer buffer, VkDeviceSize bufferSize, uint32_t mipLevels)
 {
-    VkCommandBuffer commandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+    VkCommandBuffer commandBuffer = VulkanTransferContext::Get().BeginRecording();
 
     TransitionLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, 1);
 
@@ -308,7 +305,43 @@ void VulkanImage2D::CopyFromBufferAndGenerateMipmaps(VkBuffer buffer, VkDeviceSi
         TransitionLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 1);
     }
 
-    VulkanContext::Get().EndSingleTimeCommand(commandBuffer);
+    VulkanTransferContext::Get().EndRecording();
+}
+
+void VulkanImage2D::CopyMipChainFromBuffer(VkBuffer buffer, const std::vector<VkDeviceSize>& mipOffsets, uint32_t baseMipLevel)
+{
+    const uint32_t mipLevels = static_cast<uint32_t>(mipOffsets.size());
+    VkCommandBuffer commandBuffer = VulkanTransferContext::Get().BeginRecording();
+
+    TransitionLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, baseMipLevel, mipLevels);
+
+    std::vector<VkBufferImageCopy> regions(mipLevels);
+    for (uint32_t i = 0; i < mipLevels; i++)
+    {
+        VkBufferImageCopy& region = regions[i];
+        const uint32_t mip = baseMipLevel + i;
+        region.bufferOffset = mipOffsets[i];
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = mip;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {std::max(m_Specification.Width >> mip, 1u), std::max(m_Specification.Height >> mip, 1u), 1};
+    }
+
+    vkCmdCopyBufferToImage(
+            commandBuffer,
+            buffer,
+            m_Image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            mipLevels,
+            regions.data());
+
+    TransitionLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, baseMipLevel, mipLevels);
+
+    VulkanTransferContext::Get().EndRecording();
 }
 
 void VulkanImage2D::GenerateMipmaps(VkCommandBuffer commandBuffer, uint32_t mipLevels)
@@ -481,9 +514,9 @@ void VulkanImage2D::SetExpectedLayout(VkImageLayout expectedLayout)
 
 void VulkanImage2D::TransitionLayout(VkImageLayout newLayout, uint32_t baseMipLevel, uint32_t levelCount)
 {
-	auto cmd = VulkanContext::Get().BeginSingleTimeCommands();
+	auto cmd = VulkanTransferContext::Get().BeginRecording();
 	TransitionLayout(cmd, newLayout, baseMipLevel, levelCount);
-	VulkanContext::Get().EndSingleTimeCommand(cmd);
+	VulkanTransferContext::Get().EndRecording();
 }
 
 VulkanImageView::VulkanImageView(VulkanImage2D* image, uint32_t mip)
@@ -7,6 +7,7 @@
 #include <vulkan/vulkan.h>
 #include "vulkan_context.h"
 #include "vulkan_image_utils.h"
+#include "vulkan_memory_allocator.h"
 
 
 struct ImageSpecification
@@ -47,6 +48,8 @@ public:
     void TransitionLayout(VkImageLayout newLayout, uint32_t baseMipLevel = 0, uint32_t levelCount = VK_REMAINING_MIP_LEVELS);
     const VkDescriptorImageInfo& GetDescriptorInfo(uint32_t mip = 0) const;
     void CopyFromBufferAndGenerateMipmaps(VkBuffer buffer, VkDeviceSize bufferSize, uint32_t mipLevels);
+    // Uploads consecutive mip levels with one copy, level baseMipLevel + i starts at mipOffsets[i] in the buffer
+    void CopyMipChainFromBuffer(VkBuffer buffer, const std::vector<VkDeviceSize>& mipOffsets, uint32_t baseMipLevel = 0);
 
     const ImageSpecification& GetSpecification() const { return m_Specification; }
     VkImage GetVkImage() const { return m_Image; }
@@ -69,14 +72,17 @@ private:
                              VkPipelineStageFlags& srcStage, VkPipelineStageFlags& dstStage,
                              VkAccessFlags& srcAccess, VkAccessFlags& dstAccess);
 
+    // Attachments and storage images are recreated on resize, a dedicated allocation gives their memory straight back
     static void CreateVkImageWithInfo(const VkImageCreateInfo& imageInfo,
                                       VkMemoryPropertyFlags properties,
+                                      MemoryCategory category,
+                                      bool dedicated,
                                       VkImage& image,
-                                      VkDeviceMemory& imageMemory);
+                                      MemoryAllocation& allocation);
 
     ImageSpecification m_Specification;
     VkImage m_Image = VK_NULL_HANDLE;
-    VkDeviceMemory m_DeviceMemory = VK_NULL_HANDLE;
+    MemoryAllocation m_Allocation{};
     VkSampler m_Sampler = VK_NULL_HANDLE;
     VkImageLayout m_CurrentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
@@ -8,7 +8,9 @@ struct SamplerSpecification
 	VkFilter MinFilter = VK_FILTER_LINEAR;
 	VkFilter MagFilter = VK_FILTER_LINEAR;
 	VkSamplerMipmapMode MipMapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-	VkSamplerAddressMode AddressModeU, AddressModeV, AddressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	VkSamplerAddressMode AddressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode AddressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode AddressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
 };
 
 enum class ImageFormat
@@ -32,6 +34,12 @@ enum class ImageFormat
 
     SRGB,
 
+    // Block compressed, 4x4 texel blocks
+    BC1,
+    BC3,
+    BC5,
+    BC7,
+
     DEPTH32FSTENCIL8UINT,
     DEPTH32F,
     DEPTH24STENCIL8,
@@ -102,7 +110,22 @@ namespace ImageUtils
             case ImageFormat::B10R11G11UF:
                 return 4;
         }
+        // Block compressed formats have no whole byte texel size, use GetBlockSize
         assert(false);
+        return 0;
+    }
+
+    inline bool IsBlockCompressed(ImageFormat format)
+    {
+        return format == ImageFormat::BC1 || format == ImageFormat::BC3 ||
+               format == ImageFormat::BC5 || format == ImageFormat::BC7;
+    }
+
+    // Bytes per 4x4 block
+    inline uint32_t GetBlockSize(ImageFormat format)
+    {
+        assert(IsBlockCompressed(format));
+        return format == ImageFormat::BC1 ? 8 : 16;
     }
 
     inline bool IsIntegerBased(const ImageFormat format)
@@ -127,6 +150,10 @@ namespace ImageUtils
             case ImageFormat::RGBA16F:
             case ImageFormat::RGB:
             case ImageFormat::SRGB:
+            case ImageFormat::BC1:
+            case ImageFormat::BC3:
+            case ImageFormat::BC5:
+            case ImageFormat::BC7:
             case ImageFormat::DEPTH24STENCIL8:
                 return false;
         }
@@ -163,6 +190,14 @@ namespace ImageUtils
                 return VK_FORMAT_R32G32B32A32_SFLOAT;
             case ImageFormat::B10R11G11UF:
                 return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+            case ImageFormat::BC1:
+                return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+            case ImageFormat::BC3:
+                return VK_FORMAT_BC3_UNORM_BLOCK;
+            case ImageFormat::BC5:
+                return VK_FORMAT_BC5_UNORM_BLOCK;
+            case ImageFormat::BC7:
+                return VK_FORMAT_BC7_UNORM_BLOCK;
             case ImageFormat::DEPTH32FSTENCIL8UINT:
                 return VK_FORMAT_D32_SFLOAT_S8_UINT;
             case ImageFormat::DEPTH32F:
@@ -204,6 +239,14 @@ namespace ImageUtils
                 return ImageFormat::RGBA32F;
             case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
                 return ImageFormat::B10R11G11UF;
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                return ImageFormat::BC1;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+                return ImageFormat::BC3;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                return ImageFormat::BC5;
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+                return ImageFormat::BC7;
             case VK_FORMAT_D32_SFLOAT_S8_UINT:
                 return ImageFormat::DEPTH32FSTENCIL8UINT;
             case VK_FORMAT_D32_SFLOAT:
@@ -221,6 +264,8 @@ namespace ImageUtils
 
     inline uint32_t GetImageMemorySize(ImageFormat format, uint32_t width, uint32_t height)
     {
+        if (IsBlockCompressed(format))
+            return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
         return width * height * GetImageFormatBPP(format);
     }
 
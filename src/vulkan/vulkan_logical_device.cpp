@@ -24,6 +24,8 @@ void VulkanLogicalDevice::Initialize(VulkanPhysicalDevice& physicalDeviceRef, co
 
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // Optional, file textures stay uncompressed when the device can't sample BC formats
+    deviceFeatures.textureCompressionBC = physicalDeviceRef.PhysicalDeviceFeatures.textureCompressionBC;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -31,9 +33,14 @@ void VulkanLogicalDevice::Initialize(VulkanPhysicalDevice& physicalDeviceRef, co
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+    // Optional, memory budgets fall back to an estimate without it
+    std::vector<const char*> extensions = requestedDeviceExtensions;
+    if (physicalDeviceRef.SupportsMemoryBudget)
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(requestedDeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = requestedDeviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     if (vkCreateDevice(physicalDeviceRef.PhysicalDevice, &createInfo, nullptr, &Device) != VK_SUCCESS)
     {
@@ -65,7 +65,8 @@ void VulkanMaterial::AllocateDescriptorSets()
     }
 }
 
-void VulkanMaterial::BindDescriptors(uint32_t frameIndex, VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint)
+void VulkanMaterial::BindDescriptors(uint32_t frameIndex, VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint,
+                                     std::initializer_list<uint32_t> dynamicOffsets)
 {
     vkCmdBindDescriptorSets(
             commandBuffer,
@@ -74,8 +75,8 @@ void VulkanMaterial::BindDescriptors(uint32_t frameIndex, VkCommandBuffer comman
             0,
             static_cast<uint32_t>(m_DescriptorSets[frameIndex].size()),
             m_DescriptorSets[frameIndex].data(),
-            0,
-            nullptr
+            static_cast<uint32_t>(dynamicOffsets.size()),
+            dynamicOffsets.begin()
     );
 }
 
@@ -2,6 +2,7 @@
 
 #include "vulkan_material_layout.h"
 #include "vulkan_descriptors.h"
+#include <initializer_list>
 #include <memory>
 #include <vector>
 
@@ -34,7 +35,9 @@ public:
     VulkanMaterial(VulkanMaterial&& other) noexcept;
     VulkanMaterial& operator=(VulkanMaterial&& other) noexcept;
 
-    void BindDescriptors(uint32_t frameIndex, VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint);
+    // One offset per dynamic uniform buffer of the layout, ordered by set and binding
+    void BindDescriptors(uint32_t frameIndex, VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint,
+                         std::initializer_list<uint32_t> dynamicOffsets = {});
     void UpdateDescriptor(uint32_t frameIndex, uint32_t set, const DescriptorUpdate& update);
     void UpdateDescriptorSets(uint32_t frameIndex, const std::vector<std::pair<uint32_t, std::vector<DescriptorUpdate>>>& updates);
 
@@ -1,11 +1,16 @@
 #include "vulkan_material_layout.h"
 #include "vulkan_context.h"
 
-VulkanMaterialLayout::VulkanMaterialLayout(const std::shared_ptr<VulkanShader>& vertexShader, const std::shared_ptr<VulkanShader>& fragmentShader)
+VulkanMaterialLayout::VulkanMaterialLayout(const std::shared_ptr<VulkanShader>& vertexShader, const std::shared_ptr<VulkanShader>& fragmentShader,
+                                           const std::vector<DescriptorBinding>& dynamicUniformBuffers)
         : m_VertexShader(vertexShader), m_FragmentShader(fragmentShader)
 {
     m_ShaderDescriptorInfo.AddShaderReflection(m_VertexShader->GetReflection(), m_VertexShader->GetShaderStage());
     m_ShaderDescriptorInfo.AddShaderReflection(m_FragmentShader->GetReflection(), m_FragmentShader->GetShaderStage());
+    for (const auto& [set, binding] : dynamicUniformBuffers)
+    {
+        m_ShaderDescriptorInfo.SetDynamicUniformBuffer(set, binding);
+    }
 
     ProcessPushConstants();
     CreateDescriptorSetLayouts();
@@ -16,7 +16,15 @@ public:
         uint32_t size;
     };
 
-    VulkanMaterialLayout(const std::shared_ptr<VulkanShader>& vertexShader, const std::shared_ptr<VulkanShader>& fragmentShader);
+    struct DescriptorBinding
+    {
+        uint32_t set;
+        uint32_t binding;
+    };
+
+    // Uniform buffers listed in dynamicUniformBuffers take a dynamic offset in VulkanMaterial::BindDescriptors
+    VulkanMaterialLayout(const std::shared_ptr<VulkanShader>& vertexShader, const std::shared_ptr<VulkanShader>& fragmentShader,
+                         const std::vector<DescriptorBinding>& dynamicUniformBuffers = {});
     ~VulkanMaterialLayout();
 
     VulkanMaterialLayout(const VulkanMaterialLayout&) = delete;
@@ -0,0 +1,657 @@
+#include "vulkan_memory_allocator.h"
+#include "vulkan_descriptors.h"
+#include "vulkan_utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    VkDeviceSize AlignDown(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return value / alignment * alignment;
+    }
+
+    // Without VK_EXT_memory_budget assume the engine may use most of a heap, the OS and other processes take the rest
+    constexpr VkDeviceSize FallbackBudgetPercent = 80;
+}
+
+const char* MemoryCategoryToString(MemoryCategory category)
+{
+    switch (category)
+    {
+        case MemoryCategory::Geometry:      return "Geometry";
+        case MemoryCategory::Textures:      return "Textures";
+        case MemoryCategory::Attachments:   return "Attachments";
+        case MemoryCategory::Uniforms:      return "Uniforms";
+        case MemoryCategory::Staging:       return "Staging";
+        case MemoryCategory::Other:         return "Other";
+        default:                            return "Unknown";
+    }
+}
+
+void VulkanMemoryAllocator::Initialize(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device,
+                                       bool supportsMemoryBudget, VkDeviceSize blockSize)
+{
+    VulkanMemoryAllocator& allocator = Get();
+    std::lock_guard<std::mutex> lock(allocator.m_Mutex);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &allocator.m_MemoryProperties);
+    allocator.m_PhysicalDevice = physicalDevice;
+    allocator.m_Device = device;
+    allocator.m_BlockSize = blockSize;
+    allocator.m_NonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+    allocator.m_MaxMemoryAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    // The instance must enable VK_KHR_get_physical_device_properties2 for this, the device extension is optional
+    if (supportsMemoryBudget)
+    {
+        allocator.m_GetMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+            vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+    }
+
+    const uint32_t typeCount = allocator.m_MemoryProperties.memoryTypeCount;
+    allocator.m_HeapReservedBytes.assign(allocator.m_MemoryProperties.memoryHeapCount, 0);
+    allocator.m_PeakHeapReservedBytes.assign(allocator.m_MemoryProperties.memoryHeapCount, 0);
+    allocator.m_Categories = {};
+    allocator.m_PeakDeviceMemoryCount = 0;
+    allocator.m_Pools.resize(typeCount * 2);
+    allocator.m_Stats.resize(typeCount);
+    for (uint32_t i = 0; i < typeCount; i++)
+    {
+        allocator.m_Stats[i].Properties = allocator.m_MemoryProperties.memoryTypes[i].propertyFlags;
+        allocator.m_Stats[i].Heap = allocator.m_MemoryProperties.memoryTypes[i].heapIndex;
+    }
+}
+
+void VulkanMemoryAllocator::Shutdown()
+{
+    VulkanMemoryAllocator& allocator = Get();
+    std::lock_guard<std::mutex> lock(allocator.m_Mutex);
+
+    uint32_t leaked = 0;
+    for (uint32_t poolIndex = 0; poolIndex < allocator.m_Pools.size(); poolIndex++)
+    {
+        for (Block& block : allocator.m_Pools[poolIndex].Blocks)
+        {
+            if (block.Memory == VK_NULL_HANDLE)
+                continue;
+
+            leaked += block.AllocationCount;
+            allocator.FreeDeviceMemory(poolIndex / 2, block.Size, block.Memory, block.Mapped);
+        }
+    }
+
+    leaked += static_cast<uint32_t>(allocator.m_Dedicated.size());
+    if (leaked > 0)
+        std::cerr << "Device memory allocator shut down with " << leaked << " allocations left\n";
+
+    for (const DedicatedMemory& dedicated : allocator.m_Dedicated)
+        allocator.FreeDeviceMemory(dedicated.MemoryType, dedicated.Size, dedicated.Memory, dedicated.Mapped);
+
+    allocator.m_Pools.clear();
+    allocator.m_Dedicated.clear();
+    allocator.m_Stats.clear();
+    allocator.m_HeapReservedBytes.clear();
+    allocator.m_PeakHeapReservedBytes.clear();
+    allocator.m_DeviceMemoryCount = 0;
+    allocator.m_GetMemoryProperties2 = nullptr;
+    allocator.m_PhysicalDevice = VK_NULL_HANDLE;
+    allocator.m_Device = VK_NULL_HANDLE;
+}
+
+MemoryAllocation VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                                                 MemoryResourceKind kind, MemoryCategory category, bool dedicated)
+{
+    MemoryAllocation allocation{};
+    allocation.MemoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+    allocation.Kind = kind;
+    allocation.Category = category;
+
+    const VkMemoryType& type = m_MemoryProperties.memoryTypes[allocation.MemoryType];
+    // Small heaps, integrated GPUs and software drivers among them, get smaller blocks
+    const VkDeviceSize blockSize = std::min(m_BlockSize, m_MemoryProperties.memoryHeaps[type.heapIndex].size / 8);
+
+    // Host visible allocations start and end on nonCoherentAtomSize, so a flush or invalidate widened to whole
+    // atoms never touches a neighbouring suballocation
+    VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+    allocation.Size = requirements.size;
+    if (type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        alignment = std::max(alignment, m_NonCoherentAtomSize);
+        allocation.Size = AlignUp(allocation.Size, m_NonCoherentAtomSize);
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    assert(!m_Pools.empty() && "VulkanMemoryAllocator used before Initialize");
+
+    MemoryTypeStats& stats = m_Stats[allocation.MemoryType];
+    if (!dedicated && allocation.Size <= blockSize / 2)
+    {
+        Pool& pool = GetPool(allocation.MemoryType, kind);
+
+        // Older blocks fill up before new ones are touched
+        uint32_t blockIndex = MemoryAllocation::DedicatedBlock;
+        for (uint32_t i = 0; i < pool.Blocks.size() && blockIndex == MemoryAllocation::DedicatedBlock; i++)
+        {
+            if (pool.Blocks[i].Memory != VK_NULL_HANDLE && TryAllocateFromBlock(pool.Blocks[i], allocation.Size, alignment, allocation.Offset))
+                blockIndex = i;
+        }
+
+        if (blockIndex == MemoryAllocation::DedicatedBlock)
+        {
+            blockIndex = CreateBlock(pool, allocation.MemoryType, blockSize);
+            if (blockIndex != MemoryAllocation::DedicatedBlock)
+                TryAllocateFromBlock(pool.Blocks[blockIndex], allocation.Size, alignment, allocation.Offset);
+        }
+
+        // A failed block allocation falls through to a dedicated one of the exact size, which may still fit
+        if (blockIndex != MemoryAllocation::DedicatedBlock)
+        {
+            Block& block = pool.Blocks[blockIndex];
+            block.AllocationCount++;
+            block.UsedBytes += allocation.Size;
+            allocation.Memory = block.Memory;
+            allocation.Block = blockIndex;
+            allocation.Mapped = block.Mapped ? static_cast<char*>(block.Mapped) + allocation.Offset : nullptr;
+
+            stats.AllocationCount++;
+            stats.UsedBytes += allocation.Size;
+            TrackAllocation(allocation, true);
+            ValidatePool(pool);
+            return allocation;
+        }
+    }
+
+    allocation.Offset = 0;
+    const VkResult result = AllocateDeviceMemory(allocation.MemoryType, allocation.Size, allocation.Memory, allocation.Mapped);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error(std::string("Failed to allocate device memory: ") + VKResultToString(result));
+
+    m_Dedicated.push_back({allocation.Memory, allocation.Size, allocation.Mapped, allocation.MemoryType});
+    stats.DedicatedCount++;
+    stats.AllocationCount++;
+    stats.UsedBytes += allocation.Size;
+    TrackAllocation(allocation, true);
+    return allocation;
+}
+
+void VulkanMemoryAllocator::Free(MemoryAllocation& allocation)
+{
+    if (!allocation.IsValid())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // Shutdown already released the memory, the owning resource outlived the allocator
+    if (m_Pools.empty())
+    {
+        std::cerr << "Device memory freed after the allocator shut down\n";
+        assert(false && "VulkanMemoryAllocator::Free called after Shutdown");
+        allocation = {};
+        return;
+    }
+
+    MemoryTypeStats& stats = m_Stats[allocation.MemoryType];
+    stats.AllocationCount--;
+    stats.UsedBytes -= allocation.Size;
+    TrackAllocation(allocation, false);
+
+    if (allocation.IsDedicated())
+    {
+        auto dedicated = std::find_if(m_Dedicated.begin(), m_Dedicated.end(), [&allocation](const DedicatedMemory& memory)
+        {
+            return memory.Memory == allocation.Memory;
+        });
+        assert(dedicated != m_Dedicated.end() && "Dedicated allocation not owned by this allocator");
+        if (dedicated != m_Dedicated.end())
+        {
+            *dedicated = m_Dedicated.back();
+            m_Dedicated.pop_back();
+        }
+
+        stats.DedicatedCount--;
+        FreeDeviceMemory(allocation.MemoryType, allocation.Size, allocation.Memory, allocation.Mapped);
+        allocation = {};
+        return;
+    }
+
+    Pool& pool = GetPool(allocation.MemoryType, allocation.Kind);
+    Block& block = pool.Blocks[allocation.Block];
+    auto& freeRanges = block.FreeRanges;
+    auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), allocation.Offset,
+                                 [](const FreeRange& range, VkDeviceSize offset) { return range.Offset < offset; });
+    auto it = freeRanges.insert(next, {allocation.Offset, allocation.Size});
+
+    // Merge with the following range, then with the preceding one
+    if (auto following = std::next(it); following != freeRanges.end() && it->Offset + it->Size == following->Offset)
+    {
+        it->Size += following->Size;
+        freeRanges.erase(following);
+    }
+    if (it != freeRanges.begin())
+    {
+        auto preceding = std::prev(it);
+        if (preceding->Offset + preceding->Size == it->Offset)
+        {
+            preceding->Size += it->Size;
+            freeRanges.erase(it);
+        }
+    }
+
+    block.UsedBytes -= allocation.Size;
+
+    // Keep one empty block per pool around so a resource that is freed and recreated doesn't reallocate it
+    if (--block.AllocationCount == 0)
+    {
+        const bool hasOtherBlock = std::any_of(pool.Blocks.begin(), pool.Blocks.end(), [&block](const Block& other)
+        {
+            return &other != &block && other.Memory != VK_NULL_HANDLE;
+        });
+
+        if (hasOtherBlock)
+        {
+            stats.BlockCount--;
+            FreeDeviceMemory(allocation.MemoryType, block.Size, block.Memory, block.Mapped);
+            block = {};
+        }
+    }
+
+    ValidatePool(pool);
+    allocation = {};
+}
+
+MemoryAllocation VulkanMemoryAllocator::AllocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties, MemoryCategory category)
+{
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(m_Device, buffer, &requirements);
+
+    MemoryAllocation allocation = Allocate(requirements, properties, MemoryResourceKind::Linear, category);
+    VK_CHECK_RESULT(vkBindBufferMemory(m_Device, buffer, allocation.Memory, allocation.Offset));
+    return allocation;
+}
+
+MemoryAllocation VulkanMemoryAllocator::AllocateForImage(VkImage image, VkMemoryPropertyFlags properties, VkImageTiling tiling,
+                                                         MemoryCategory category, bool dedicated)
+{
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(m_Device, image, &requirements);
+
+    const MemoryResourceKind kind = tiling == VK_IMAGE_TILING_LINEAR ? MemoryResourceKind::Linear : MemoryResourceKind::Optimal;
+    MemoryAllocation allocation = Allocate(requirements, properties, kind, category, dedicated);
+    VK_CHECK_RESULT(vkBindImageMemory(m_Device, image, allocation.Memory, allocation.Offset));
+    return allocation;
+}
+
+VkResult VulkanMemoryAllocator::Flush(const MemoryAllocation& allocation, VkDeviceSize size, VkDeviceSize offset)
+{
+    if (!allocation.Mapped || (m_MemoryProperties.memoryTypes[allocation.MemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        return VK_SUCCESS;
+
+    const VkMappedMemoryRange range = GetMappedRange(allocation, size, offset);
+    return vkFlushMappedMemoryRanges(m_Device, 1, &range);
+}
+
+VkResult VulkanMemoryAllocator::Flush(const MemoryAllocation& allocation, const std::vector<MemoryRange>& ranges)
+{
+    if (ranges.empty() || !allocation.Mapped || (m_MemoryProperties.memoryTypes[allocation.MemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        return VK_SUCCESS;
+
+    std::vector<VkMappedMemoryRange> mappedRanges;
+    mappedRanges.reserve(ranges.size());
+    for (const MemoryRange& range : ranges)
+        mappedRanges.push_back(GetMappedRange(allocation, range.Size, range.Offset));
+
+    return vkFlushMappedMemoryRanges(m_Device, static_cast<uint32_t>(mappedRanges.size()), mappedRanges.data());
+}
+
+VkResult VulkanMemoryAllocator::Invalidate(const MemoryAllocation& allocation, VkDeviceSize size, VkDeviceSize offset)
+{
+    if (!allocation.Mapped || (m_MemoryProperties.memoryTypes[allocation.MemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        return VK_SUCCESS;
+
+    const VkMappedMemoryRange range = GetMappedRange(allocation, size, offset);
+    return vkInvalidateMappedMemoryRanges(m_Device, 1, &range);
+}
+
+uint32_t VulkanMemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+MemoryStats VulkanMemoryAllocator::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    MemoryStats stats{};
+    stats.Types = m_Stats;
+    stats.Categories = m_Categories;
+    stats.HasMemoryBudget = m_GetMemoryProperties2 != nullptr;
+    stats.DeviceMemoryCount = m_DeviceMemoryCount;
+    stats.PeakDeviceMemoryCount = m_PeakDeviceMemoryCount;
+    for (const MemoryTypeStats& type : m_Stats)
+    {
+        stats.AllocationCount += type.AllocationCount;
+        stats.ReservedBytes += type.ReservedBytes;
+        stats.UsedBytes += type.UsedBytes;
+    }
+
+    if (!m_Pools.empty())
+        QueryHeapBudgets(stats.Heaps);
+    return stats;
+}
+
+void VulkanMemoryAllocator::WriteStatsJson(std::ostream& out)
+{
+    const MemoryStats stats = GetStats();
+
+    out << "{\n";
+    out << "  \"hasMemoryBudget\": " << (stats.HasMemoryBudget ? "true" : "false") << ",\n";
+    out << "  \"deviceMemoryCount\": " << stats.DeviceMemoryCount << ",\n";
+    out << "  \"peakDeviceMemoryCount\": " << stats.PeakDeviceMemoryCount << ",\n";
+    out << "  \"maxMemoryAllocationCount\": " << m_MaxMemoryAllocationCount << ",\n";
+    out << "  \"allocationCount\": " << stats.AllocationCount << ",\n";
+    out << "  \"reservedBytes\": " << stats.ReservedBytes << ",\n";
+    out << "  \"usedBytes\": " << stats.UsedBytes << ",\n";
+    out << "  \"descriptorPools\": { \"livePoolCount\": " << VulkanDescriptorPool::GetLivePoolCount()
+        << ", \"reservedSetCount\": " << VulkanDescriptorPool::GetReservedSetCount() << " },\n";
+
+    out << "  \"categories\": {\n";
+    for (size_t i = 0; i < stats.Categories.size(); i++)
+    {
+        const MemoryCategoryStats& category = stats.Categories[i];
+        out << "    \"" << MemoryCategoryToString(static_cast<MemoryCategory>(i)) << "\": { "
+            << "\"allocationCount\": " << category.AllocationCount << ", "
+            << "\"peakAllocationCount\": " << category.PeakAllocationCount << ", "
+            << "\"usedBytes\": " << category.UsedBytes << ", "
+            << "\"peakUsedBytes\": " << category.PeakUsedBytes << ", "
+            << "\"hostVisibleBytes\": " << category.HostVisibleBytes << " }"
+            << (i + 1 < stats.Categories.size() ? "," : "") << "\n";
+    }
+    out << "  },\n";
+
+    out << "  \"heaps\": [\n";
+    for (size_t i = 0; i < stats.Heaps.size(); i++)
+    {
+        const MemoryHeapBudget& heap = stats.Heaps[i];
+        out << "    { \"index\": " << i << ", "
+            << "\"deviceLocal\": " << ((heap.Flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false") << ", "
+            << "\"size\": " << heap.Size << ", "
+            << "\"budget\": " << heap.Budget << ", "
+            << "\"usage\": " << heap.Usage << ", "
+            << "\"reservedBytes\": " << heap.ReservedBytes << ", "
+            << "\"peakReservedBytes\": " << heap.PeakReservedBytes << " }"
+            << (i + 1 < stats.Heaps.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+
+    out << "  \"memoryTypes\": [\n";
+    for (size_t i = 0; i < stats.Types.size(); i++)
+    {
+        const MemoryTypeStats& type = stats.Types[i];
+        out << "    { \"index\": " << i << ", "
+            << "\"heap\": " << type.Heap << ", "
+            << "\"propertyFlags\": " << type.Properties << ", "
+            << "\"blockCount\": " << type.BlockCount << ", "
+            << "\"dedicatedCount\": " << type.DedicatedCount << ", "
+            << "\"allocationCount\": " << type.AllocationCount << ", "
+            << "\"reservedBytes\": " << type.ReservedBytes << ", "
+            << "\"usedBytes\": " << type.UsedBytes << " }"
+            << (i + 1 < stats.Types.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool VulkanMemoryAllocator::DumpStatsJson(const std::string& filepath)
+{
+    std::ofstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open " << filepath << " for writing memory stats\n";
+        return false;
+    }
+
+    WriteStatsJson(file);
+    return file.good();
+}
+
+VulkanMemoryAllocator::Pool& VulkanMemoryAllocator::GetPool(uint32_t memoryType, MemoryResourceKind kind)
+{
+    return m_Pools[memoryType * 2 + static_cast<uint32_t>(kind)];
+}
+
+bool VulkanMemoryAllocator::TryAllocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+{
+    // Best fit, the range left over smallest wins
+    auto best = block.FreeRanges.end();
+    VkDeviceSize bestLeftover = ~0ull;
+    for (auto it = block.FreeRanges.begin(); it != block.FreeRanges.end(); ++it)
+    {
+        const VkDeviceSize padding = AlignUp(it->Offset, alignment) - it->Offset;
+        if (it->Size < padding + size)
+            continue;
+
+        const VkDeviceSize leftover = it->Size - padding - size;
+        if (leftover < bestLeftover)
+        {
+            best = it;
+            bestLeftover = leftover;
+        }
+    }
+
+    if (best == block.FreeRanges.end())
+        return false;
+
+    const FreeRange range = *best;
+    offset = AlignUp(range.Offset, alignment);
+
+    // Whatever is left on either side of the allocation stays free
+    const FreeRange front{range.Offset, offset - range.Offset};
+    const FreeRange back{offset + size, range.Offset + range.Size - offset - size};
+    best = block.FreeRanges.erase(best);
+    if (back.Size > 0)
+        best = block.FreeRanges.insert(best, back);
+    if (front.Size > 0)
+        block.FreeRanges.insert(best, front);
+    return true;
+}
+
+uint32_t VulkanMemoryAllocator::CreateBlock(Pool& pool, uint32_t memoryType, VkDeviceSize size)
+{
+    Block block{};
+    block.Size = size;
+    if (AllocateDeviceMemory(memoryType, size, block.Memory, block.Mapped) != VK_SUCCESS)
+        return MemoryAllocation::DedicatedBlock;
+
+    block.FreeRanges.push_back({0, size});
+    m_Stats[memoryType].BlockCount++;
+
+    // Reuse the slot of a freed block
+    for (uint32_t i = 0; i < pool.Blocks.size(); i++)
+    {
+        if (pool.Blocks[i].Memory == VK_NULL_HANDLE)
+        {
+            pool.Blocks[i] = std::move(block);
+            return i;
+        }
+    }
+
+    pool.Blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(pool.Blocks.size() - 1);
+}
+
+VkResult VulkanMemoryAllocator::AllocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory& memory, void*& mapped)
+{
+    VkDevice device = m_Device;
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+    if (result != VK_SUCCESS)
+        return result;
+
+    mapped = nullptr;
+    if (m_MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        result = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+        if (result != VK_SUCCESS)
+        {
+            vkFreeMemory(device, memory, nullptr);
+            memory = VK_NULL_HANDLE;
+            return result;
+        }
+    }
+
+    const uint32_t heap = m_MemoryProperties.memoryTypes[memoryType].heapIndex;
+    m_DeviceMemoryCount++;
+    m_PeakDeviceMemoryCount = std::max(m_PeakDeviceMemoryCount, m_DeviceMemoryCount);
+    m_Stats[memoryType].ReservedBytes += size;
+    m_HeapReservedBytes[heap] += size;
+    m_PeakHeapReservedBytes[heap] = std::max(m_PeakHeapReservedBytes[heap], m_HeapReservedBytes[heap]);
+    return VK_SUCCESS;
+}
+
+void VulkanMemoryAllocator::FreeDeviceMemory(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory memory, void* mapped)
+{
+    VkDevice device = m_Device;
+    if (mapped)
+        vkUnmapMemory(device, memory);
+    vkFreeMemory(device, memory, nullptr);
+
+    m_DeviceMemoryCount--;
+    m_Stats[memoryType].ReservedBytes -= size;
+    m_HeapReservedBytes[m_MemoryProperties.memoryTypes[memoryType].heapIndex] -= size;
+}
+
+VkMappedMemoryRange VulkanMemoryAllocator::GetMappedRange(const MemoryAllocation& allocation, VkDeviceSize size, VkDeviceSize offset)
+{
+    VkDeviceSize memorySize = allocation.Size;
+    if (!allocation.IsDedicated())
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        memorySize = GetPool(allocation.MemoryType, allocation.Kind).Blocks[allocation.Block].Size;
+    }
+
+    const VkDeviceSize begin = allocation.Offset + offset;
+    const VkDeviceSize end = size == VK_WHOLE_SIZE ? allocation.Offset + allocation.Size : begin + size;
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.Memory;
+    range.offset = AlignDown(begin, m_NonCoherentAtomSize);
+    range.size = std::min(AlignUp(end, m_NonCoherentAtomSize), memorySize) - range.offset;
+    return range;
+}
+
+void VulkanMemoryAllocator::TrackAllocation(const MemoryAllocation& allocation, bool allocated)
+{
+    MemoryCategoryStats& category = m_Categories[static_cast<size_t>(allocation.Category)];
+    const bool hostVisible = m_MemoryProperties.memoryTypes[allocation.MemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+    if (allocated)
+    {
+        category.AllocationCount++;
+        category.UsedBytes += allocation.Size;
+        category.PeakAllocationCount = std::max(category.PeakAllocationCount, category.AllocationCount);
+        category.PeakUsedBytes = std::max(category.PeakUsedBytes, category.UsedBytes);
+        if (hostVisible)
+            category.HostVisibleBytes += allocation.Size;
+    }
+    else
+    {
+        category.AllocationCount--;
+        category.UsedBytes -= allocation.Size;
+        if (hostVisible)
+            category.HostVisibleBytes -= allocation.Size;
+    }
+}
+
+void VulkanMemoryAllocator::QueryHeapBudgets(std::vector<MemoryHeapBudget>& heaps) const
+{
+    const uint32_t heapCount = m_MemoryProperties.memoryHeapCount;
+    heaps.resize(heapCount);
+    for (uint32_t i = 0; i < heapCount; i++)
+    {
+        heaps[i].Size = m_MemoryProperties.memoryHeaps[i].size;
+        heaps[i].Flags = m_MemoryProperties.memoryHeaps[i].flags;
+        heaps[i].ReservedBytes = m_HeapReservedBytes[i];
+        heaps[i].PeakReservedBytes = m_PeakHeapReservedBytes[i];
+        heaps[i].Budget = heaps[i].Size / 100 * FallbackBudgetPercent;
+        heaps[i].Usage = heaps[i].ReservedBytes;
+    }
+
+    if (!m_GetMemoryProperties2)
+        return;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties.pNext = &budget;
+    m_GetMemoryProperties2(m_PhysicalDevice, &properties);
+
+    for (uint32_t i = 0; i < heapCount; i++)
+    {
+        heaps[i].Budget = budget.heapBudget[i];
+        heaps[i].Usage = budget.heapUsage[i];
+    }
+}
+
+void VulkanMemoryAllocator::ValidatePool(const Pool& pool) const
+{
+#ifndef NDEBUG
+    uint32_t emptyBlockCount = 0;
+    for (const Block& block : pool.Blocks)
+    {
+        if (block.Memory == VK_NULL_HANDLE)
+        {
+            assert(block.FreeRanges.empty() && block.AllocationCount == 0 && "Freed block slot still holds ranges");
+            continue;
+        }
+
+        VkDeviceSize freeBytes = 0;
+        for (size_t i = 0; i < block.FreeRanges.size(); i++)
+        {
+            const FreeRange& range = block.FreeRanges[i];
+            assert(range.Size > 0 && range.Offset + range.Size <= block.Size && "Free range outside of its block");
+            if (i > 0)
+            {
+                const FreeRange& previous = block.FreeRanges[i - 1];
+                assert(previous.Offset + previous.Size <= range.Offset && "Free ranges unsorted or overlapping");
+                assert(previous.Offset + previous.Size != range.Offset && "Neighbouring free ranges not coalesced");
+            }
+            freeBytes += range.Size;
+        }
+
+        assert(freeBytes + block.UsedBytes == block.Size && "Free and allocated bytes don't add up to the block size");
+        if (block.AllocationCount == 0)
+        {
+            assert(block.UsedBytes == 0 && block.FreeRanges.size() == 1 && "Empty block not coalesced into one range");
+            emptyBlockCount++;
+        }
+    }
+
+    assert(emptyBlockCount <= 1 && "Pool keeps more than one empty block");
+#endif
+}
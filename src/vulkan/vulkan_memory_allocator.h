@@ -0,0 +1,209 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Buffers and linearly tiled images are linear resources, optimally tiled images are not. The two never share a
+// block, so neighbouring suballocations can't violate bufferImageGranularity.
+enum class MemoryResourceKind : uint32_t { Linear, Optimal };
+
+// What an allocation is used for, every allocation is tagged with one for the telemetry
+enum class MemoryCategory : uint32_t { Geometry, Textures, Attachments, Uniforms, Staging, Other, Count };
+const char* MemoryCategoryToString(MemoryCategory category);
+
+// Range of a VkDeviceMemory handed out by the VulkanMemoryAllocator
+struct MemoryAllocation
+{
+    static constexpr uint32_t DedicatedBlock = ~0u;
+
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    VkDeviceSize Offset = 0;
+    VkDeviceSize Size = 0;
+    uint32_t MemoryType = 0;
+    MemoryResourceKind Kind = MemoryResourceKind::Linear;
+    MemoryCategory Category = MemoryCategory::Other;
+    uint32_t Block = DedicatedBlock;
+    // Start of the allocation when its memory is host visible, blocks stay mapped for their whole lifetime
+    void* Mapped = nullptr;
+
+    bool IsValid() const { return Memory != VK_NULL_HANDLE; }
+    bool IsDedicated() const { return Block == DedicatedBlock; }
+};
+
+// Byte range of an allocation, relative to its start
+struct MemoryRange
+{
+    VkDeviceSize Offset = 0;
+    VkDeviceSize Size = 0;
+};
+
+struct MemoryTypeStats
+{
+    VkMemoryPropertyFlags Properties = 0;
+    uint32_t Heap = 0;
+    uint32_t BlockCount = 0;
+    uint32_t DedicatedCount = 0;
+    uint32_t AllocationCount = 0;
+    // Bytes of VkDeviceMemory owned, blocks plus dedicated allocations
+    VkDeviceSize ReservedBytes = 0;
+    // Bytes handed out, alignment padding included
+    VkDeviceSize UsedBytes = 0;
+};
+
+struct MemoryCategoryStats
+{
+    uint32_t AllocationCount = 0;
+    uint32_t PeakAllocationCount = 0;
+    VkDeviceSize UsedBytes = 0;
+    VkDeviceSize PeakUsedBytes = 0;
+    // Part of UsedBytes the host can map
+    VkDeviceSize HostVisibleBytes = 0;
+};
+
+struct MemoryHeapBudget
+{
+    VkDeviceSize Size = 0;
+    VkMemoryHeapFlags Flags = 0;
+    // From VK_EXT_memory_budget when the device has it, otherwise 80% of the heap and this allocator's blocks
+    VkDeviceSize Budget = 0;
+    VkDeviceSize Usage = 0;
+    // VkDeviceMemory this allocator owns in the heap, a subset of Usage
+    VkDeviceSize ReservedBytes = 0;
+    VkDeviceSize PeakReservedBytes = 0;
+};
+
+struct MemoryStats
+{
+    // Indexed by memory type
+    std::vector<MemoryTypeStats> Types;
+    // Indexed by heap
+    std::vector<MemoryHeapBudget> Heaps;
+    std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::Count)> Categories{};
+    bool HasMemoryBudget = false;
+    uint32_t DeviceMemoryCount = 0;
+    uint32_t PeakDeviceMemoryCount = 0;
+    uint32_t AllocationCount = 0;
+    VkDeviceSize ReservedBytes = 0;
+    VkDeviceSize UsedBytes = 0;
+
+    const MemoryCategoryStats& GetCategory(MemoryCategory category) const { return Categories[static_cast<size_t>(category)]; }
+};
+
+// Reserves large blocks of device memory per memory type and suballocates buffers and images from them, so the
+// number of vkAllocateMemory calls stays far below maxMemoryAllocationCount. Each block keeps an offset sorted
+// free list, allocations take the smallest range that fits and freed ranges coalesce with their neighbours.
+// Resources of half a block or more, and anything asked to be dedicated (attachments that are recreated on
+// resize), get a VkDeviceMemory of their own. Usage is tracked per memory type, heap and MemoryCategory with
+// high-water marks, heap budgets come from VK_EXT_memory_budget when the device supports it. Thread safe.
+class VulkanMemoryAllocator
+{
+public:
+    static VulkanMemoryAllocator& Get()
+    {
+        static VulkanMemoryAllocator allocator;
+        return allocator;
+    }
+
+    // After the device is created. Takes its handles instead of reading VulkanContext, so headless tools and tests
+    // can run the allocator on a device of their own.
+    static void Initialize(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, bool supportsMemoryBudget,
+                           VkDeviceSize blockSize = 64ull * 1024 * 1024);
+    // Frees every block and dedicated allocation, resources still holding an allocation must be destroyed first
+    static void Shutdown();
+
+    MemoryAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                              MemoryResourceKind kind, MemoryCategory category, bool dedicated = false);
+    void Free(MemoryAllocation& allocation);
+
+    // Allocate and bind, throw std::runtime_error when no memory type fits or the device is out of memory
+    MemoryAllocation AllocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties, MemoryCategory category);
+    MemoryAllocation AllocateForImage(VkImage image, VkMemoryPropertyFlags properties, VkImageTiling tiling,
+                                      MemoryCategory category, bool dedicated = false);
+
+    // Offset is relative to the allocation. Ranges are widened to nonCoherentAtomSize, coherent memory is skipped.
+    VkResult Flush(const MemoryAllocation& allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    VkResult Invalidate(const MemoryAllocation& allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    // Flushes every range in one call
+    VkResult Flush(const MemoryAllocation& allocation, const std::vector<MemoryRange>& ranges);
+
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return m_MemoryProperties; }
+    VkDeviceSize GetBlockSize() const { return m_BlockSize; }
+    // Queries the heap budgets on every call, cheap enough for once a frame
+    MemoryStats GetStats();
+    void WriteStatsJson(std::ostream& out);
+    // Returns false if the file can't be written
+    bool DumpStatsJson(const std::string& filepath);
+
+private:
+    struct FreeRange
+    {
+        VkDeviceSize Offset;
+        VkDeviceSize Size;
+    };
+
+    struct Block
+    {
+        VkDeviceMemory Memory = VK_NULL_HANDLE;
+        VkDeviceSize Size = 0;
+        void* Mapped = nullptr;
+        uint32_t AllocationCount = 0;
+        // Sum of the allocation sizes, alignment padding stays in the free list
+        VkDeviceSize UsedBytes = 0;
+        // Sorted by offset and coalesced on free
+        std::vector<FreeRange> FreeRanges;
+    };
+
+    // Blocks of one memory type holding one kind of resource. Freed blocks leave an empty slot so indices stay valid.
+    struct Pool
+    {
+        std::vector<Block> Blocks;
+    };
+
+    // Live VkDeviceMemory of a dedicated allocation, kept so Shutdown can release what was never freed
+    struct DedicatedMemory
+    {
+        VkDeviceMemory Memory;
+        VkDeviceSize Size;
+        void* Mapped;
+        uint32_t MemoryType;
+    };
+
+    VulkanMemoryAllocator() = default;
+
+    Pool& GetPool(uint32_t memoryType, MemoryResourceKind kind);
+    bool TryAllocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    uint32_t CreateBlock(Pool& pool, uint32_t memoryType, VkDeviceSize size);
+    VkResult AllocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory& memory, void*& mapped);
+    void FreeDeviceMemory(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory memory, void* mapped);
+    VkMappedMemoryRange GetMappedRange(const MemoryAllocation& allocation, VkDeviceSize size, VkDeviceSize offset);
+    void TrackAllocation(const MemoryAllocation& allocation, bool allocated);
+    void QueryHeapBudgets(std::vector<MemoryHeapBudget>& heaps) const;
+    // Debug builds check the free lists of a pool after every change, compiled out with NDEBUG
+    void ValidatePool(const Pool& pool) const;
+
+    VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
+    VkDevice m_Device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+    VkDeviceSize m_BlockSize = 0;
+    VkDeviceSize m_NonCoherentAtomSize = 1;
+    uint32_t m_MaxMemoryAllocationCount = 0;
+    // Two per memory type, see MemoryResourceKind
+    std::vector<Pool> m_Pools;
+    std::vector<DedicatedMemory> m_Dedicated;
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR m_GetMemoryProperties2 = nullptr;
+    std::vector<MemoryTypeStats> m_Stats;
+    // Indexed by heap
+    std::vector<VkDeviceSize> m_HeapReservedBytes;
+    std::vector<VkDeviceSize> m_PeakHeapReservedBytes;
+    std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::Count)> m_Categories{};
+    uint32_t m_DeviceMemoryCount = 0;
+    uint32_t m_PeakDeviceMemoryCount = 0;
+    std::mutex m_Mutex;
+};
@@ -0,0 +1,274 @@
+#include "vulkan_mesh_cache.h"
+#include "core/engine_utils.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr uint64_t SectionAlignment = 16;
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+std::string VulkanMeshCache::GetCachePath(const std::string& sourcePath)
+{
+    return sourcePath + ".coomesh";
+}
+
+uint32_t VulkanMeshCache::GetBuildFlags(const ModelLoadOptions& options)
+{
+    uint32_t flags = BuildFlagNone;
+    if (options.OptimizeMesh) flags |= BuildFlagOptimized;
+    if (options.PackVertices) flags |= BuildFlagPacked;
+    if (options.BuildMeshlets) flags |= BuildFlagMeshlets;
+    if (options.GenerateLods) flags |= BuildFlagLods;
+    return flags;
+}
+
+bool VulkanMeshCache::Write(const std::string& cachePath, const std::string& sourcePath, const VulkanModel::Builder& builder, uint32_t buildFlags)
+{
+    Header header{};
+    header.Magic = Magic;
+    header.Version = Version;
+    header.VertexStride = VulkanModel::GetVertexStride(builder.Format);
+    header.BuildFlags = buildFlags;
+    if (!EngineUtils::GetFileStamp(sourcePath, header.SourceSize, header.SourceWriteTime))
+        return false;
+
+    struct Payload
+    {
+        const void* Data;
+        uint64_t Size;
+    };
+
+    std::vector<Section> sections;
+    std::vector<Payload> payloads;
+
+    auto addSection = [&](SectionType type, uint32_t elementSize, const void* data, uint64_t count)
+    {
+        sections.push_back({type, elementSize, 0, count});
+        payloads.push_back({data, elementSize * count});
+    };
+
+    if (builder.Format == VertexFormat::Standard)
+    {
+        addSection(SectionType::Vertices, sizeof(VulkanModel::Vertex), builder.Vertices.data(), builder.Vertices.size());
+    }
+    else
+    {
+        addSection(SectionType::Vertices, sizeof(VulkanModel::PackedVertex), builder.PackedVertices.data(), builder.PackedVertices.size());
+        addSection(SectionType::Quantization, sizeof(VulkanModel::QuantizationParams), &builder.Quantization, 1);
+        if (builder.Format == VertexFormat::PackedColor)
+            addSection(SectionType::Colors, sizeof(uint32_t), builder.PackedColors.data(), builder.PackedColors.size());
+    }
+
+    if (!builder.Meshlets.empty())
+        addSection(SectionType::Meshlets, sizeof(MeshOptimizer::Meshlet), builder.Meshlets.data(), builder.Meshlets.size());
+    addSection(SectionType::Lods, sizeof(VulkanModel::MeshLod), builder.Lods.data(), builder.Lods.size());
+    addSection(SectionType::Bounds, sizeof(MeshBounds), &builder.Bounds, 1);
+    addSection(SectionType::SubmeshBounds, sizeof(MeshBounds), builder.SubmeshBounds.data(), builder.SubmeshBounds.size());
+
+    const MeshOptimizer::VertexCacheStatistics cacheStats[2] = {builder.CacheStatsBefore, builder.CacheStatsAfter};
+    addSection(SectionType::VertexCacheStats, sizeof(MeshOptimizer::VertexCacheStatistics), cacheStats, 2);
+
+    std::vector<uint16_t> narrowedIndices;
+    if (builder.IndexType == VK_INDEX_TYPE_UINT16)
+    {
+        narrowedIndices.resize(builder.Indices.size());
+        VulkanModel::WriteIndices(builder.Indices.data(), builder.Indices.size(), VK_INDEX_TYPE_UINT16, narrowedIndices.data());
+        addSection(SectionType::Indices, sizeof(uint16_t), narrowedIndices.data(), narrowedIndices.size());
+    }
+    else
+    {
+        addSection(SectionType::Indices, sizeof(uint32_t), builder.Indices.data(), builder.Indices.size());
+    }
+
+    header.SectionCount = static_cast<uint32_t>(sections.size());
+
+    uint64_t offset = AlignUp(sizeof(Header) + sizeof(Section) * sections.size(), SectionAlignment);
+    for (auto& section : sections)
+    {
+        section.Offset = offset;
+        offset = AlignUp(offset + section.ElementSize * section.Count, SectionAlignment);
+    }
+
+    // Write to a temporary file first so a crash mid-write never leaves a truncated cache behind
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+        if (!file.is_open())
+        {
+            std::cerr << "Unable to write mesh cache: " << cachePath << "\n";
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(sections.data()), static_cast<std::streamsize>(sizeof(Section) * sections.size()));
+
+        static constexpr char padding[SectionAlignment]{};
+        for (size_t i = 0; i < sections.size(); i++)
+        {
+            auto position = static_cast<uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(sections[i].Offset - position));
+            if (payloads[i].Size > 0)
+                file.write(static_cast<const char*>(payloads[i].Data), static_cast<std::streamsize>(payloads[i].Size));
+        }
+
+        if (!file.good())
+        {
+            file.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+    if (ec)
+    {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanMeshCache::Open(const std::string& cachePath, const std::string& sourcePath, uint32_t buildFlags)
+{
+    m_VertexFormat = VertexFormat::Standard;
+    m_Quantization = {};
+    m_Vertices = nullptr;
+    m_Colors = nullptr;
+    m_Indices = nullptr;
+    m_IndexType = VK_INDEX_TYPE_UINT32;
+    m_Meshlets = nullptr;
+    m_MeshletCount = 0;
+    m_Lods = nullptr;
+    m_LodCount = 0;
+    m_Bounds = {};
+    m_SubmeshBounds = nullptr;
+    m_SubmeshCount = 0;
+    m_CacheStatsBefore = {};
+    m_CacheStatsAfter = {};
+    m_VertexCount = m_IndexCount = 0;
+
+    if (!m_File.Open(cachePath))
+        return false;
+
+    if (m_File.Size() < sizeof(Header))
+    {
+        m_File.Close();
+        return false;
+    }
+
+    const bool packed = (buildFlags & BuildFlagPacked) != 0;
+    const uint32_t vertexStride = packed ? sizeof(VulkanModel::PackedVertex) : sizeof(VulkanModel::Vertex);
+
+    const Header& header = *m_File.As<Header>();
+    const bool headerValid =
+        header.Magic == Magic &&
+        header.Version == Version &&
+        header.VertexStride == vertexStride &&
+        header.BuildFlags == buildFlags &&
+        sizeof(Header) + sizeof(Section) * static_cast<uint64_t>(header.SectionCount) <= m_File.Size();
+
+    uint64_t sourceSize = 0;
+    int64_t sourceWriteTime = 0;
+    // A missing source is fine, the cache can be shipped on its own
+    const bool sourceMatches =
+        !EngineUtils::GetFileStamp(sourcePath, sourceSize, sourceWriteTime) ||
+        (sourceSize == header.SourceSize && sourceWriteTime == header.SourceWriteTime);
+
+    if (!headerValid || !sourceMatches)
+    {
+        m_File.Close();
+        return false;
+    }
+
+    const Section* vertices = FindSection(SectionType::Vertices, vertexStride);
+    const Section* indices = FindSection(SectionType::Indices, sizeof(uint16_t));
+    if (indices == nullptr)
+        indices = FindSection(SectionType::Indices, sizeof(uint32_t));
+    const Section* quantization = packed ? FindSection(SectionType::Quantization, sizeof(VulkanModel::QuantizationParams)) : nullptr;
+    const Section* colors = packed ? FindSection(SectionType::Colors, sizeof(uint32_t)) : nullptr;
+    const Section* lods = FindSection(SectionType::Lods, sizeof(VulkanModel::MeshLod));
+    const Section* bounds = FindSection(SectionType::Bounds, sizeof(MeshBounds));
+    const Section* submeshBounds = FindSection(SectionType::SubmeshBounds, sizeof(MeshBounds));
+    if (vertices == nullptr || indices == nullptr || lods == nullptr || bounds == nullptr || bounds->Count != 1 || submeshBounds == nullptr ||
+        (packed && (quantization == nullptr || quantization->Count != 1)) ||
+        (colors != nullptr && colors->Count != vertices->Count))
+    {
+        m_File.Close();
+        return false;
+    }
+
+    if (packed)
+    {
+        m_VertexFormat = colors != nullptr ? VertexFormat::PackedColor : VertexFormat::Packed;
+        m_Quantization = *m_File.As<VulkanModel::QuantizationParams>(quantization->Offset);
+        m_Colors = colors != nullptr ? m_File.As<uint32_t>(colors->Offset) : nullptr;
+    }
+
+    m_Vertices = m_File.Data() + vertices->Offset;
+    m_VertexCount = static_cast<uint32_t>(vertices->Count);
+    m_Indices = m_File.Data() + indices->Offset;
+    m_IndexCount = static_cast<uint32_t>(indices->Count);
+    m_IndexType = indices->ElementSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+    m_Lods = m_File.As<VulkanModel::MeshLod>(lods->Offset);
+    m_LodCount = static_cast<uint32_t>(lods->Count);
+    m_Bounds = *m_File.As<MeshBounds>(bounds->Offset);
+    m_SubmeshBounds = m_File.As<MeshBounds>(submeshBounds->Offset);
+    m_SubmeshCount = static_cast<uint32_t>(submeshBounds->Count);
+
+    const Section* cacheStats = FindSection(SectionType::VertexCacheStats, sizeof(MeshOptimizer::VertexCacheStatistics));
+    if (cacheStats != nullptr && cacheStats->Count == 2)
+    {
+        const auto* stats = m_File.As<MeshOptimizer::VertexCacheStatistics>(cacheStats->Offset);
+        m_CacheStatsBefore = stats[0];
+        m_CacheStatsAfter = stats[1];
+    }
+
+    if ((buildFlags & BuildFlagMeshlets) != 0)
+    {
+        if (const Section* meshlets = FindSection(SectionType::Meshlets, sizeof(MeshOptimizer::Meshlet)))
+        {
+            m_Meshlets = m_File.As<MeshOptimizer::Meshlet>(meshlets->Offset);
+            m_MeshletCount = static_cast<uint32_t>(meshlets->Count);
+        }
+    }
+    return true;
+}
+
+const VulkanMeshCache::Section* VulkanMeshCache::FindSection(SectionType type, uint32_t elementSize) const
+{
+    const Header& header = *m_File.As<Header>();
+    const auto* sections = m_File.As<Section>(sizeof(Header));
+
+    for (uint32_t i = 0; i < header.SectionCount; i++)
+    {
+        const Section& section = sections[i];
+        if (section.Type != type)
+            continue;
+
+        const bool inBounds =
+            section.ElementSize == elementSize &&
+            section.Offset % SectionAlignment == 0 &&
+            section.Count <= UINT32_MAX &&
+            section.Offset <= m_File.Size() &&
+            section.ElementSize * section.Count <= m_File.Size() - section.Offset;
+
+        return inBounds ? &section : nullptr;
+    }
+
+    return nullptr;
+}
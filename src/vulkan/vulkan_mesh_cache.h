@@ -0,0 +1,110 @@
+#pragma once
+
+#include "core/mapped_file.h"
+#include "vulkan_model.h"
+
+#include <string>
+
+// Versioned binary container for a fully processed model (deduplicated vertices, indices and tangents).
+// Packed models store PackedVertex data, their quantization parameters and an optional color stream.
+// Written next to the source file on first load and memory mapped on every load after that.
+class VulkanMeshCache
+{
+public:
+    static constexpr uint32_t Magic = 0x4D4F4F43; // "COOM"
+    static constexpr uint32_t Version = 8;
+
+    // Options that change the cached contents, a cache built with different flags is treated as stale
+    enum BuildFlagBits : uint32_t
+    {
+        BuildFlagNone = 0,
+        BuildFlagOptimized = 1 << 0,
+        BuildFlagPacked = 1 << 1,
+        BuildFlagMeshlets = 1 << 2,
+        BuildFlagLods = 1 << 3
+    };
+
+    enum class SectionType : uint32_t
+    {
+        Vertices = 0,
+        Indices,
+        Quantization,
+        Colors,
+        Meshlets,
+        Lods,
+        Bounds,
+        SubmeshBounds,
+        VertexCacheStats
+    };
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t SourceSize;
+        int64_t SourceWriteTime;
+        uint32_t VertexStride;
+        uint32_t BuildFlags;
+        uint32_t SectionCount;
+        uint32_t Reserved;
+    };
+
+    struct Section
+    {
+        SectionType Type;
+        uint32_t ElementSize;
+        uint64_t Offset;
+        uint64_t Count;
+    };
+
+    static std::string GetCachePath(const std::string& sourcePath);
+    static uint32_t GetBuildFlags(const ModelLoadOptions& options);
+    static bool Write(const std::string& cachePath, const std::string& sourcePath, const VulkanModel::Builder& builder, uint32_t buildFlags);
+
+    // Maps the cache and validates it against the source file. Returns false when the cache is missing or stale.
+    bool Open(const std::string& cachePath, const std::string& sourcePath, uint32_t buildFlags);
+    void Close() { m_File.Close(); }
+    bool IsOpen() const { return m_File.IsOpen(); }
+
+    VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+    const VulkanModel::QuantizationParams& GetQuantization() const { return m_Quantization; }
+    const void* GetVertexData() const { return m_Vertices; }
+    uint32_t GetVertexCount() const { return m_VertexCount; }
+    const uint32_t* GetColors() const { return m_Colors; }
+    // Indices are stored in their upload type, 16 or 32 bit
+    const void* GetIndices() const { return m_Indices; }
+    uint32_t GetIndexCount() const { return m_IndexCount; }
+    VkIndexType GetIndexType() const { return m_IndexType; }
+    const MeshOptimizer::Meshlet* GetMeshlets() const { return m_Meshlets; }
+    uint32_t GetMeshletCount() const { return m_MeshletCount; }
+    const VulkanModel::MeshLod* GetLods() const { return m_Lods; }
+    uint32_t GetLodCount() const { return m_LodCount; }
+    const MeshBounds& GetBounds() const { return m_Bounds; }
+    const MeshBounds* GetSubmeshBounds() const { return m_SubmeshBounds; }
+    uint32_t GetSubmeshCount() const { return m_SubmeshCount; }
+    // Recorded by Optimize when the cache was built, zeroed for unoptimized meshes
+    const MeshOptimizer::VertexCacheStatistics& GetCacheStatsBefore() const { return m_CacheStatsBefore; }
+    const MeshOptimizer::VertexCacheStatistics& GetCacheStatsAfter() const { return m_CacheStatsAfter; }
+
+private:
+    const Section* FindSection(SectionType type, uint32_t elementSize) const;
+
+    MappedFile m_File;
+    VertexFormat m_VertexFormat = VertexFormat::Standard;
+    VulkanModel::QuantizationParams m_Quantization{};
+    const void* m_Vertices = nullptr;
+    uint32_t m_VertexCount = 0;
+    const uint32_t* m_Colors = nullptr;
+    const void* m_Indices = nullptr;
+    uint32_t m_IndexCount = 0;
+    VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+    const MeshOptimizer::Meshlet* m_Meshlets = nullptr;
+    uint32_t m_MeshletCount = 0;
+    const VulkanModel::MeshLod* m_Lods = nullptr;
+    uint32_t m_LodCount = 0;
+    MeshBounds m_Bounds{};
+    const MeshBounds* m_SubmeshBounds = nullptr;
+    uint32_t m_SubmeshCount = 0;
+    MeshOptimizer::VertexCacheStatistics m_CacheStatsBefore{};
+    MeshOptimizer::VertexCacheStatistics m_CacheStatsAfter{};
+};
@@ -1,119 +1,662 @@
 #include "vulkan_model.h"
 #include "core/engine_utils.h"
+#include "core/flat_hash_map.h"
+#include "core/mesh_optimizer.h"
+#include "core/obj_reader.h"
+#include "core/thread_pool.h"
 #include "vulkan_buffer.h"
+#include "vulkan_geometry_pool.h"
+#include "vulkan_mesh_cache.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    // Vertices are welded by their exact bits, MakeVertex folds -0 into +0 so bitwise equality matches operator==
+    static_assert(sizeof(VulkanModel::Vertex) == 14 * sizeof(float), "Vertex must not contain padding to be hashed bytewise");
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
-
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+    struct VertexBitwiseHash
+    {
+        uint64_t operator()(const VulkanModel::Vertex& vertex) const noexcept
+        {
+            return EngineUtils::HashBytes(&vertex, sizeof(VulkanModel::Vertex));
+        }
+    };
 
-namespace std
-{
-    template<>
-    struct hash<VulkanModel::Vertex>
+    struct VertexBitwiseEqual
     {
-        size_t operator()(const VulkanModel::Vertex& vertex) const noexcept
+        bool operator()(const VulkanModel::Vertex& a, const VulkanModel::Vertex& b) const noexcept
         {
-            size_t seed = 0;
-            EngineUtils::HashCombine(seed, vertex.Position, vertex.Color, vertex.Normal, vertex.UV);
-            return seed;
+            return std::memcmp(&a, &b, sizeof(VulkanModel::Vertex)) == 0;
         }
     };
-}
 
-void VulkanModel::Builder::LoadModel(const std::string &filePath)
-{
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
+    constexpr size_t DeduplicationGrainSize = 64 * 1024;
+    constexpr size_t PackingGrainSize = 16 * 1024;
+
+    // Tangent generation: smaller meshes are not worth the accumulator allocations, and the accumulators
+    // are capped so wide machines don't multiply the memory of very large meshes
+    constexpr size_t MinTrianglesPerTangentChunk = 16 * 1024;
+    constexpr size_t MaxTangentAccumulatorBytes = 128 * 1024 * 1024;
+    constexpr size_t TangentGrainSize = 16 * 1024;
+    // Vertices orthonormalized together as a structure of arrays, wide enough for one AVX register
+    constexpr size_t TangentBatchSize = 8;
+    // Smallest cosine between a parallel tangent and its serial reference that still counts as a match
+    constexpr float TangentMatchTolerance = 0.999f;
+
+    // LOD generation: each level targets half the triangles of the previous one and is kept only when it
+    // actually removes enough triangles without deviating more than MaxLodError of the mesh diameter
+    constexpr float MaxLodError = 0.05f;
+    constexpr float MinLodReduction = 0.85f;
+    constexpr size_t MinLodIndexCount = 64 * 3;
+
+    uint16_t QuantizeUnorm16(float value)
+    {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    int16_t QuantizeSnorm16(float value)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    // Triangles of a shape reference source positions directly, so this works before deduplication and
+    // optimization reorder them
+    std::vector<MeshBounds> ComputeShapeBounds(const ObjData& objData)
+    {
+        std::vector<MeshBounds> shapeBounds;
+        shapeBounds.reserve(objData.Shapes.size());
+        for (const ObjShape& shape : objData.Shapes)
+        {
+            shapeBounds.push_back(ComputeMeshBounds(shape.IndexCount, [&](size_t i)
+            {
+                const size_t position = static_cast<size_t>(objData.Indices[shape.FirstIndex + i].Position) * 3;
+                return glm::vec3(objData.Positions[position], objData.Positions[position + 1], objData.Positions[position + 2]);
+            }));
+        }
+        return shapeBounds;
+    }
+
+    uint8_t QuantizeUnorm8(float value)
+    {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    // Round to nearest even, overflow goes to infinity and tiny values flush through the subnormal range
+    uint16_t FloatToHalf(float value)
+    {
+        const uint32_t bits = std::bit_cast<uint32_t>(value);
+        const uint32_t sign = (bits >> 16) & 0x8000u;
+        const uint32_t biasedExponent = (bits >> 23) & 0xFFu;
+        uint32_t mantissa = bits & 0x7FFFFFu;
+
+        if (biasedExponent == 0xFFu)
+            return static_cast<uint16_t>(sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u));
+
+        const int32_t exponent = static_cast<int32_t>(biasedExponent) - 127 + 15;
+        if (exponent >= 31)
+            return static_cast<uint16_t>(sign | 0x7C00u);
+
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return static_cast<uint16_t>(sign);
+
+            mantissa |= 0x800000u;
+            const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+            const uint32_t halfway = 1u << (shift - 1u);
+            if (remainder > halfway || (remainder == halfway && (half & 1u)))
+                half++;
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        const uint32_t remainder = mantissa & 0x1FFFu;
+        // A carry out of the mantissa correctly bumps the exponent
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Projects the unit vector onto an octahedron and unfolds the lower half over the upper one
+    glm::vec2 EncodeOctahedral(const glm::vec3& v)
+    {
+        const float l1Norm = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+        if (!(l1Norm > 0.0f))
+            return glm::vec2{0.0f};
+
+        glm::vec2 encoded{v.x / l1Norm, v.y / l1Norm};
+        if (v.z < 0.0f)
+        {
+            encoded = glm::vec2{
+                (1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f)};
+        }
+        return encoded;
+    }
+
+    VulkanModel::Vertex MakeVertex(const ObjData& objData, const ObjIndex& index)
+    {
+        VulkanModel::Vertex vertex{};
+
+        // Adding +0 turns -0 into +0 and leaves every other value unchanged
+        const float* position = &objData.Positions[3 * index.Position];
+        vertex.Position = glm::vec3(position[0], position[1], position[2]) + 0.0f;
+
+        if (objData.Colors.empty())
+        {
+            vertex.Color = {1.0f, 1.0f, 1.0f};
+        }
+        else
+        {
+            const float* color = &objData.Colors[3 * index.Position];
+            vertex.Color = glm::vec3(color[0], color[1], color[2]) + 0.0f;
+        }
+
+        if (index.Normal >= 0)
+        {
+            const float* normal = &objData.Normals[3 * index.Normal];
+            vertex.Normal = glm::vec3(normal[0], normal[1], normal[2]) + 0.0f;
+        }
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filePath.c_str()))
+        if (index.TexCoord >= 0)
+        {
+            const float* uv = &objData.TexCoords[2 * index.TexCoord];
+            vertex.UV = glm::vec2(uv[0], uv[1]) + 0.0f;
+        }
+
+        return vertex;
+    }
+
+    // Unnormalized tangent of one triangle, weighted by its UV mapping
+    glm::vec3 ComputeTriangleTangent(const VulkanModel::Vertex& v0, const VulkanModel::Vertex& v1, const VulkanModel::Vertex& v2)
     {
-        throw std::runtime_error(warn + err);
+        // Edge vectors
+        const glm::vec3 edge1 = v1.Position - v0.Position;
+        const glm::vec3 edge2 = v2.Position - v0.Position;
+
+        // UV delta
+        const glm::vec2 deltaUV1 = v1.UV - v0.UV;
+        const glm::vec2 deltaUV2 = v2.UV - v0.UV;
+
+        const float f = 1.0f / glm::max(0.001f, (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y));
+
+        glm::vec3 tangent;
+        tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
+        tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
+        tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+        return tangent;
+    }
+
+    // Opt-in, set COO_MESH_STATS to log the vertex cache gains of every optimized model as it loads
+    void ReportCacheStats(const std::string& filePath, const MeshOptimizer::VertexCacheStatistics& before,
+                          const MeshOptimizer::VertexCacheStatistics& after)
+    {
+        static const bool enabled = std::getenv("COO_MESH_STATS") != nullptr;
+        if (!enabled || after.VerticesTransformed == 0)
+            return;
+
+        // Loads run on worker threads, one write per line keeps the lines whole
+        std::ostringstream line;
+        line << filePath << ": ACMR " << before.ACMR << " -> " << after.ACMR
+             << ", ATVR " << before.ATVR << " -> " << after.ATVR << "\n";
+        std::cout << line.str();
     }
+}
+
+void VulkanModel::Builder::LoadModel(const std::string &filePath, const ModelLoadOptions& options)
+{
+    ObjData objData = ObjReader::Read(filePath);
 
     Vertices.clear();
     Indices.clear();
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
 
-    for (const auto &shape: shapes)
+    Format = VertexFormat::Standard;
+    HasColors = !objData.Colors.empty();
+    PackedVertices.clear();
+    PackedColors.clear();
+    Quantization = {};
+    Meshlets.clear();
+    Lods.clear();
+    Bounds = {};
+    SubmeshBounds = ComputeShapeBounds(objData);
+    CacheStatsBefore = {};
+    CacheStatsAfter = {};
+
+    Deduplicate(objData, Vertices, Indices);
+    ComputeTangentBasis(Vertices, Indices);
+
+    if (options.VerifyTangents)
+    {
+        if (const size_t mismatches = VerifyTangentBasis(Vertices, Indices); mismatches > 0)
+            std::cerr << filePath << ": " << mismatches << " tangents differ from the serial reference\n";
+    }
+
+    if (options.OptimizeMesh)
+    {
+        Optimize();
+    }
+
+    Bounds = ComputeMeshBounds(Vertices.size(), [&](size_t i) { return Vertices[i].Position; });
+    Lods = {{0, static_cast<uint32_t>(Indices.size()), 0.0f}};
+
+    if (options.BuildMeshlets)
     {
-        for (const auto &index: shape.mesh.indices)
+        BuildMeshlets();
+    }
+
+    if (options.GenerateLods)
+    {
+        GenerateLods();
+    }
+
+    if (options.PackVertices)
+    {
+        Pack();
+    }
+
+    IndexType = SelectIndexType(Vertices.size());
+}
+
+void VulkanModel::Builder::Optimize()
+{
+    if (Indices.empty()) return;
+
+    CacheStatsBefore = MeshOptimizer::AnalyzeVertexCache(Indices, Vertices.size());
+
+    MeshOptimizer::OptimizeVertexCache(Indices, Vertices.size());
+    MeshOptimizer::OptimizeOverdraw(Indices, Vertices.data(), Vertices.size(), sizeof(Vertex));
+    size_t vertexCount = MeshOptimizer::OptimizeVertexFetch(Vertices.data(), Vertices.size(), sizeof(Vertex), Indices);
+    Vertices.resize(vertexCount);
+
+    CacheStatsAfter = MeshOptimizer::AnalyzeVertexCache(Indices, Vertices.size());
+}
+
+void VulkanModel::Builder::BuildMeshlets()
+{
+    if (Lods.size() > 1)
+        throw std::runtime_error("Meshlets must be built before LODs are appended to the index buffer");
+
+    Meshlets = MeshOptimizer::BuildMeshlets(Indices, Vertices.data(), Vertices.size(), sizeof(Vertex));
+}
+
+void VulkanModel::Builder::GenerateLods()
+{
+    const uint32_t baseIndexCount = Lods.empty() ? static_cast<uint32_t>(Indices.size()) : Lods[0].IndexCount;
+    const std::vector<uint32_t> baseIndices(Indices.begin(), Indices.begin() + baseIndexCount);
+
+    Indices.resize(baseIndexCount);
+    Lods = {{0, baseIndexCount, 0.0f}};
+
+    const float maxError = Bounds.Sphere.Radius * 2.0f * MaxLodError;
+    size_t targetIndexCount = baseIndexCount;
+    for (uint32_t level = 1; level < MaxLodCount; level++)
+    {
+        targetIndexCount /= 2;
+        if (targetIndexCount < MinLodIndexCount)
+            break;
+
+        // Every level is simplified from LOD 0 so errors are measured against the original surface
+        float error = 0.0f;
+        std::vector<uint32_t> lodIndices = MeshOptimizer::Simplify(
+            baseIndices, Vertices.data(), Vertices.size(), sizeof(Vertex), targetIndexCount, maxError, &error);
+        if (static_cast<float>(lodIndices.size()) > static_cast<float>(Lods.back().IndexCount) * MinLodReduction)
+            break;
+
+        MeshOptimizer::OptimizeVertexCache(lodIndices, Vertices.size());
+
+        Lods.push_back({static_cast<uint32_t>(Indices.size()), static_cast<uint32_t>(lodIndices.size()), std::max(error, Lods.back().Error)});
+        Indices.insert(Indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+}
+
+void VulkanModel::Builder::Pack()
+{
+    Format = HasColors ? VertexFormat::PackedColor : VertexFormat::Packed;
+    PackedVertices.resize(Vertices.size());
+    PackedColors.resize(HasColors ? Vertices.size() : 0);
+
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+    if (!Vertices.empty())
+    {
+        boundsMin = boundsMax = Vertices[0].Position;
+        for (const auto& vertex : Vertices)
+        {
+            boundsMin = glm::min(boundsMin, vertex.Position);
+            boundsMax = glm::max(boundsMax, vertex.Position);
+        }
+    }
+
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const glm::vec3 invExtent{
+        extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 1.0f / extent.z : 0.0f};
+
+    Quantization.PositionOffset = boundsMin;
+    Quantization.PositionScale = extent;
+
+    ThreadPool::Get().ParallelFor(Vertices.size(), PackingGrainSize, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
         {
-            Vertex vertex{};
+            const Vertex& vertex = Vertices[i];
+            PackedVertex& packed = PackedVertices[i];
+
+            const glm::vec3 position = (vertex.Position - boundsMin) * invExtent;
+            packed.Position[0] = QuantizeUnorm16(position.x);
+            packed.Position[1] = QuantizeUnorm16(position.y);
+            packed.Position[2] = QuantizeUnorm16(position.z);
+            // Generated tangents are always right handed
+            packed.Position[3] = 65535;
+
+            const glm::vec2 normal = EncodeOctahedral(vertex.Normal);
+            packed.Normal[0] = QuantizeSnorm16(normal.x);
+            packed.Normal[1] = QuantizeSnorm16(normal.y);
+
+            const glm::vec2 tangent = EncodeOctahedral(vertex.Tangent);
+            packed.Tangent[0] = QuantizeSnorm16(tangent.x);
+            packed.Tangent[1] = QuantizeSnorm16(tangent.y);
+
+            packed.UV[0] = FloatToHalf(vertex.UV.x);
+            packed.UV[1] = FloatToHalf(vertex.UV.y);
 
-            if (index.vertex_index >= 0)
+            if (HasColors)
             {
-                vertex.Position =
-                {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2],
-                };
-
-                vertex.Color = {
-                    attrib.colors[3 * index.vertex_index + 0],
-                    attrib.colors[3 * index.vertex_index + 1],
-                    attrib.colors[3 * index.vertex_index + 2],
-                };
+                PackedColors[i] =
+                    static_cast<uint32_t>(QuantizeUnorm8(vertex.Color.x)) |
+                    static_cast<uint32_t>(QuantizeUnorm8(vertex.Color.y)) << 8 |
+                    static_cast<uint32_t>(QuantizeUnorm8(vertex.Color.z)) << 16 |
+                    0xFF000000u;
             }
+        }
+    });
+}
+
+void VulkanModel::Builder::Deduplicate(const ObjData& objData, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    // Face corners are sharded by vertex hash so every shard can be deduplicated independently.
+    // Unique vertices are then numbered in order of first use, which gives the exact same
+    // vertex and index order as a serial pass over the corners.
+    ThreadPool& pool = ThreadPool::Get();
+
+    const size_t cornerCount = objData.Indices.size();
+    if (cornerCount == 0) return;
+
+    size_t shardCount = 1;
+    while (shardCount < static_cast<size_t>(pool.GetConcurrency()) * 2) shardCount <<= 1;
+    const uint32_t shardShift = 64 - static_cast<uint32_t>(std::countr_zero(shardCount));
+    auto shardOf = [shardCount, shardShift](uint64_t hash) -> size_t
+    {
+        // Top bits pick the shard, the shard's table probes with the low bits
+        return shardCount == 1 ? 0 : static_cast<size_t>(hash >> shardShift);
+    };
 
-            if (index.normal_index >= 0)
+    const size_t blockCount = std::clamp<size_t>(cornerCount / DeduplicationGrainSize, 1, static_cast<size_t>(pool.GetConcurrency()) * 4);
+    const size_t blockSize = (cornerCount + blockCount - 1) / blockCount;
+    auto forEachBlock = [&](const std::function<void(size_t block, size_t begin, size_t end)>& fn)
+    {
+        pool.ParallelFor(blockCount, 1, [&](size_t first, size_t last)
+        {
+            for (size_t block = first; block < last; block++)
             {
-                vertex.Normal =
-                {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2],
-                };
+                fn(block, block * blockSize, std::min(cornerCount, (block + 1) * blockSize));
             }
+        });
+    };
+
+    // Hash every corner and count how many land in each shard per block
+    std::vector<uint64_t> cornerHashes(cornerCount);
+    std::vector<uint32_t> shardCounts(blockCount * shardCount, 0);
+    forEachBlock([&](size_t block, size_t begin, size_t end)
+    {
+        VertexBitwiseHash hasher{};
+        for (size_t corner = begin; corner < end; corner++)
+        {
+            cornerHashes[corner] = hasher(MakeVertex(objData, objData.Indices[corner]));
+            shardCounts[block * shardCount + shardOf(cornerHashes[corner])]++;
+        }
+    });
 
-            if (index.texcoord_index >= 0)
+    // Scatter corner ids into per-shard lists, keeping them in ascending order within each shard
+    std::vector<size_t> shardBegin(shardCount + 1, 0);
+    std::vector<size_t> scatterOffsets(blockCount * shardCount);
+    {
+        size_t offset = 0;
+        for (size_t shard = 0; shard < shardCount; shard++)
+        {
+            shardBegin[shard] = offset;
+            for (size_t block = 0; block < blockCount; block++)
             {
-                vertex.UV =
-                {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    attrib.texcoords[2 * index.texcoord_index + 1],
-                };
+                scatterOffsets[block * shardCount + shard] = offset;
+                offset += shardCounts[block * shardCount + shard];
             }
+        }
+        shardBegin[shardCount] = offset;
+    }
+
+    std::vector<uint32_t> shardCorners(cornerCount);
+    forEachBlock([&](size_t block, size_t begin, size_t end)
+    {
+        size_t* offsets = &scatterOffsets[block * shardCount];
+        for (size_t corner = begin; corner < end; corner++)
+        {
+            shardCorners[offsets[shardOf(cornerHashes[corner])]++] = static_cast<uint32_t>(corner);
+        }
+    });
 
-            if (uniqueVertices.count(vertex) == 0)
+    // Deduplicate each shard on its own
+    std::vector<uint32_t> cornerLocalIds(cornerCount);
+    std::vector<std::vector<uint32_t>> shardFirstCorners(shardCount);
+    pool.ParallelFor(shardCount, 1, [&](size_t first, size_t last)
+    {
+        for (size_t shard = first; shard < last; shard++)
+        {
+            // Sized for every corner being unique, so the table never rehashes
+            FlatHashMap<Vertex, uint32_t, VertexBitwiseHash, VertexBitwiseEqual> uniqueVertices{shardBegin[shard + 1] - shardBegin[shard]};
+            std::vector<uint32_t>& firstCorners = shardFirstCorners[shard];
+
+            for (size_t i = shardBegin[shard]; i < shardBegin[shard + 1]; i++)
             {
-                uniqueVertices[vertex] = static_cast<uint32_t>(Vertices.size());
-                Vertices.push_back(vertex);
+                uint32_t corner = shardCorners[i];
+                auto [localId, inserted] = uniqueVertices.TryEmplaceHashed(
+                    MakeVertex(objData, objData.Indices[corner]), cornerHashes[corner], static_cast<uint32_t>(firstCorners.size()));
+                if (inserted)
+                    firstCorners.push_back(corner);
+
+                cornerLocalIds[corner] = *localId;
             }
-            Indices.push_back(uniqueVertices[vertex]);
         }
+    });
+
+    // Number the unique vertices by the position of their first corner
+    std::vector<uint32_t> cornerGlobalIds(cornerCount, 0);
+    pool.ParallelFor(shardCount, 1, [&](size_t first, size_t last)
+    {
+        for (size_t shard = first; shard < last; shard++)
+            for (uint32_t corner : shardFirstCorners[shard])
+                cornerGlobalIds[corner] = 1;
+    });
+
+    std::vector<uint32_t> blockUniqueCounts(blockCount, 0);
+    forEachBlock([&](size_t block, size_t begin, size_t end)
+    {
+        uint32_t count = 0;
+        for (size_t corner = begin; corner < end; corner++)
+            count += cornerGlobalIds[corner];
+        blockUniqueCounts[block] = count;
+    });
+
+    uint32_t uniqueCount = 0;
+    for (uint32_t& count : blockUniqueCounts)
+    {
+        uint32_t blockFirst = uniqueCount;
+        uniqueCount += count;
+        count = blockFirst;
     }
 
-    ComputeTangentBasis(Vertices, Indices);
+    forEachBlock([&](size_t block, size_t begin, size_t end)
+    {
+        uint32_t nextId = blockUniqueCounts[block];
+        for (size_t corner = begin; corner < end; corner++)
+        {
+            if (cornerGlobalIds[corner])
+                cornerGlobalIds[corner] = nextId++;
+        }
+    });
+
+    // Emit vertices and rewrite every corner to its global id
+    vertices.resize(uniqueCount);
+    std::vector<std::vector<uint32_t>> shardGlobalIds(shardCount);
+    pool.ParallelFor(shardCount, 1, [&](size_t first, size_t last)
+    {
+        for (size_t shard = first; shard < last; shard++)
+        {
+            const std::vector<uint32_t>& firstCorners = shardFirstCorners[shard];
+            std::vector<uint32_t>& globalIds = shardGlobalIds[shard];
+            globalIds.resize(firstCorners.size());
+
+            for (size_t localId = 0; localId < firstCorners.size(); localId++)
+            {
+                uint32_t corner = firstCorners[localId];
+                globalIds[localId] = cornerGlobalIds[corner];
+                vertices[globalIds[localId]] = MakeVertex(objData, objData.Indices[corner]);
+            }
+        }
+    });
+
+    indices.resize(cornerCount);
+    forEachBlock([&](size_t, size_t begin, size_t end)
+    {
+        for (size_t corner = begin; corner < end; corner++)
+        {
+            indices[corner] = shardGlobalIds[shardOf(cornerHashes[corner])][cornerLocalIds[corner]];
+        }
+    });
 }
 
 void VulkanModel::Builder::ComputeTangentBasis(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
 {
-    for (size_t i = 0; i < indices.size(); i += 3)
+    const size_t triangleCount = indices.size() / 3;
+    const size_t vertexCount = vertices.size();
+
+    ThreadPool& pool = ThreadPool::Get();
+    size_t chunkCount = std::min<size_t>(pool.GetConcurrency(), triangleCount / MinTrianglesPerTangentChunk);
+    if (vertexCount > 0)
+        chunkCount = std::min(chunkCount, MaxTangentAccumulatorBytes / (vertexCount * sizeof(glm::vec3)));
+
+    if (chunkCount < 2)
     {
-        Vertex& v0 = vertices[indices[i]];
-        Vertex& v1 = vertices[indices[i + 1]];
-        Vertex& v2 = vertices[indices[i + 2]];
+        ComputeTangentBasisSerial(vertices, indices);
+        return;
+    }
 
-        // Edge vectors
-        glm::vec3 edge1 = v1.Position - v0.Position;
-        glm::vec3 edge2 = v2.Position - v0.Position;
+    // Every chunk of triangles sums into its own accumulator, so no two threads write the same vertex
+    std::vector<std::vector<glm::vec3>> accumulators(chunkCount);
+    pool.ParallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk)
+    {
+        for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+        {
+            std::vector<glm::vec3>& accumulator = accumulators[chunk];
+            accumulator.assign(vertexCount, glm::vec3(0.0f));
 
-        // UV delta
-        glm::vec2 deltaUV1 = v1.UV - v0.UV;
-        glm::vec2 deltaUV2 = v2.UV - v0.UV;
+            const size_t begin = triangleCount * chunk / chunkCount;
+            const size_t end = triangleCount * (chunk + 1) / chunkCount;
+            for (size_t triangle = begin; triangle < end; triangle++)
+            {
+                const uint32_t i0 = indices[triangle * 3 + 0];
+                const uint32_t i1 = indices[triangle * 3 + 1];
+                const uint32_t i2 = indices[triangle * 3 + 2];
+
+                const glm::vec3 tangent = ComputeTriangleTangent(vertices[i0], vertices[i1], vertices[i2]);
+                accumulator[i0] += tangent;
+                accumulator[i1] += tangent;
+                accumulator[i2] += tangent;
+            }
+        }
+    });
 
-        float f = 1.0f / glm::max(0.001f, (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y));
+    // Reduce the accumulators and run Gram-Schmidt on batches of vertices laid out as a structure of arrays,
+    // which the compiler turns into packed SIMD math
+    pool.ParallelFor(vertexCount, TangentGrainSize, [&](size_t begin, size_t end)
+    {
+        for (size_t first = begin; first < end; first += TangentBatchSize)
+        {
+            const size_t count = std::min(TangentBatchSize, end - first);
 
-        glm::vec3 tangent;
-        tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-        tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-        tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+            // Unused lanes hold a valid basis so they never produce NaNs
+            alignas(32) float tx[TangentBatchSize] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+            alignas(32) float ty[TangentBatchSize]{}, tz[TangentBatchSize]{};
+            alignas(32) float nx[TangentBatchSize]{}, ny[TangentBatchSize]{}, nz[TangentBatchSize]{};
+
+            for (size_t lane = 0; lane < count; lane++)
+            {
+                const Vertex& vertex = vertices[first + lane];
+                glm::vec3 tangent = vertex.Tangent;
+                for (const auto& accumulator : accumulators)
+                    tangent += accumulator[first + lane];
+
+                tx[lane] = tangent.x; ty[lane] = tangent.y; tz[lane] = tangent.z;
+                nx[lane] = vertex.Normal.x; ny[lane] = vertex.Normal.y; nz[lane] = vertex.Normal.z;
+            }
+
+            for (size_t lane = 0; lane < TangentBatchSize; lane++)
+            {
+                const float d = nx[lane] * tx[lane] + ny[lane] * ty[lane] + nz[lane] * tz[lane];
+                tx[lane] -= nx[lane] * d;
+                ty[lane] -= ny[lane] * d;
+                tz[lane] -= nz[lane] * d;
+
+                const float invLength = 1.0f / std::sqrt(tx[lane] * tx[lane] + ty[lane] * ty[lane] + tz[lane] * tz[lane]);
+                tx[lane] *= invLength;
+                ty[lane] *= invLength;
+                tz[lane] *= invLength;
+            }
+
+            for (size_t lane = 0; lane < count; lane++)
+                vertices[first + lane].Tangent = glm::vec3(tx[lane], ty[lane], tz[lane]);
+        }
+    });
+}
+
+size_t VulkanModel::Builder::VerifyTangentBasis(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    std::vector<Vertex> reference = vertices;
+    for (auto& vertex : reference)
+        vertex.Tangent = glm::vec3(0.0f);
+    ComputeTangentBasisSerial(reference, indices);
+
+    // Summation order only moves the result by float rounding, degenerate tangents that normalize to NaN are skipped
+    size_t mismatches = 0;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const glm::vec3& expected = reference[i].Tangent;
+        if (std::isfinite(expected.x) && std::isfinite(expected.y) && std::isfinite(expected.z) &&
+            !(glm::dot(expected, vertices[i].Tangent) > TangentMatchTolerance))
+            mismatches++;
+    }
+    return mismatches;
+}
+
+void VulkanModel::Builder::ComputeTangentBasisSerial(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        Vertex& v0 = vertices[indices[i]];
+        Vertex& v1 = vertices[indices[i + 1]];
+        Vertex& v2 = vertices[indices[i + 2]];
 
+        const glm::vec3 tangent = ComputeTriangleTangent(v0, v1, v2);
         v0.Tangent += tangent;
         v1.Tangent += tangent;
         v2.Tangent += tangent;
@@ -127,104 +670,263 @@ void VulkanModel::Builder::ComputeTangentBasis(std::vector<Vertex>& vertices, co
 }
 
 VulkanModel::VulkanModel(const Builder& builder)
+    : m_VertexFormat(builder.Format), m_Quantization(builder.Quantization), m_Meshlets(builder.Meshlets),
+      m_Lods(builder.Lods), m_Bounds(builder.Bounds), m_SubmeshBounds(builder.SubmeshBounds),
+      m_CacheStatsBefore(builder.CacheStatsBefore), m_CacheStatsAfter(builder.CacheStatsAfter)
 {
-    CreateVertexBuffer(builder.Vertices);
-    CreateIndexBuffer(builder.Indices);
+    if (m_VertexFormat == VertexFormat::Standard)
+    {
+        UploadVertices(builder.Vertices.data(), static_cast<uint32_t>(builder.Vertices.size()));
+    }
+    else
+    {
+        UploadVertices(builder.PackedVertices.data(), static_cast<uint32_t>(builder.PackedVertices.size()));
+        if (m_VertexFormat == VertexFormat::PackedColor)
+            UploadColors(builder.PackedColors.data());
+    }
+
+    if (builder.IndexType == VK_INDEX_TYPE_UINT16)
+    {
+        std::vector<uint16_t> indices(builder.Indices.size());
+        WriteIndices(builder.Indices.data(), builder.Indices.size(), VK_INDEX_TYPE_UINT16, indices.data());
+        UploadIndices(indices.data(), static_cast<uint32_t>(indices.size()), VK_INDEX_TYPE_UINT16);
+    }
+    else
+    {
+        UploadIndices(builder.Indices.data(), static_cast<uint32_t>(builder.Indices.size()), VK_INDEX_TYPE_UINT32);
+    }
 }
 
-std::shared_ptr<VulkanModel> VulkanModel::CreateModelFromFile(const std::string &filePath)
+VulkanModel::VulkanModel(const VulkanMeshCache& meshCache)
+    : m_VertexFormat(meshCache.GetVertexFormat()), m_Quantization(meshCache.GetQuantization()),
+      m_Meshlets(meshCache.GetMeshlets(), meshCache.GetMeshlets() + meshCache.GetMeshletCount()),
+      m_Lods(meshCache.GetLods(), meshCache.GetLods() + meshCache.GetLodCount()), m_Bounds(meshCache.GetBounds()),
+      m_SubmeshBounds(meshCache.GetSubmeshBounds(), meshCache.GetSubmeshBounds() + meshCache.GetSubmeshCount()),
+      m_CacheStatsBefore(meshCache.GetCacheStatsBefore()), m_CacheStatsAfter(meshCache.GetCacheStatsAfter())
 {
-    Builder builder{};
-    builder.LoadModel(filePath);
-    return std::make_shared<VulkanModel>(builder);
+    // Mapped cache pages go straight into the staging buffers, no per-vertex work
+    UploadVertices(meshCache.GetVertexData(), meshCache.GetVertexCount());
+    if (m_VertexFormat == VertexFormat::PackedColor)
+        UploadColors(meshCache.GetColors());
+
+    UploadIndices(meshCache.GetIndices(), meshCache.GetIndexCount(), meshCache.GetIndexType());
 }
 
+VulkanModel::~VulkanModel()
+{
+    auto& pool = VulkanGeometryPool::Get();
+    pool.FreeVertices(m_VertexFormat, m_VertexAllocation);
+    if (m_HasIndexBuffer)
+        pool.FreeIndices(m_IndexType, m_IndexAllocation);
+}
 
-void VulkanModel::CreateVertexBuffer(const std::vector<Vertex> &vertices)
+ModelSource::ModelSource() = default;
+ModelSource::~ModelSource() = default;
+ModelSource::ModelSource(ModelSource&&) noexcept = default;
+ModelSource& ModelSource::operator=(ModelSource&&) noexcept = default;
+
+std::shared_ptr<VulkanModel> VulkanModel::CreateModelFromFile(const std::string &filePath, const ModelLoadOptions& options)
 {
-    m_VertexCount = static_cast<uint32_t>(vertices.size());
+    return CreateModelFromSource(LoadModelSource(filePath, options));
+}
 
-    assert(m_VertexCount >= 3 && "vertex count must be at least 3");
+ModelSource VulkanModel::LoadModelSource(const std::string& filePath, const ModelLoadOptions& options)
+{
+    const std::string cachePath = VulkanMeshCache::GetCachePath(filePath);
+    const uint32_t buildFlags = VulkanMeshCache::GetBuildFlags(options);
 
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * m_VertexCount;
-    uint32_t vertexSize = sizeof(vertices[0]);
+    ModelSource source{};
+    if (options.UseMeshCache)
+    {
+        source.Cache = std::make_unique<VulkanMeshCache>();
+        if (source.Cache->Open(cachePath, filePath, buildFlags))
+        {
+            ReportCacheStats(filePath, source.Cache->GetCacheStatsBefore(), source.Cache->GetCacheStatsAfter());
+            return source;
+        }
+        source.Cache.reset();
+    }
 
-    VulkanBuffer stagingBuffer{
-        vertexSize,
-        m_VertexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    };
+    source.Builder = std::make_unique<Builder>();
+    source.Builder->LoadModel(filePath, options);
 
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer(vertices.data());
+    if (options.UseMeshCache)
+    {
+        VulkanMeshCache::Write(cachePath, filePath, *source.Builder, buildFlags);
+    }
 
-    m_VertexBuffer = std::make_unique<VulkanBuffer>(
-        vertexSize,
-        m_VertexCount,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+    ReportCacheStats(filePath, source.Builder->CacheStatsBefore, source.Builder->CacheStatsAfter);
+    return source;
+}
+
+std::shared_ptr<VulkanModel> VulkanModel::CreateModelFromSource(const ModelSource& source)
+{
+    if (source.Cache)
+        return std::make_shared<VulkanModel>(*source.Cache);
+    if (source.Builder)
+        return std::make_shared<VulkanModel>(*source.Builder);
 
-    VulkanBuffer::CopyBuffer(
-            stagingBuffer.GetBuffer(),
-            m_VertexBuffer->GetBuffer(),
-            bufferSize);
+    throw std::runtime_error("Model source holds neither a mesh cache nor a builder");
 }
 
-void VulkanModel::CreateIndexBuffer(const std::vector<uint32_t>& indices)
+
+uint32_t VulkanModel::GetVertexStride(VertexFormat format)
 {
-    m_IndexCount = static_cast<uint32_t>(indices.size());
-    m_HasIndexBuffer = m_IndexCount > 0;
-    if(!m_HasIndexBuffer) return;
+    return format == VertexFormat::Standard ? sizeof(Vertex) : sizeof(PackedVertex);
+}
 
-    VkDeviceSize bufferSize = sizeof(indices[0]) * m_IndexCount;
-    uint32_t indexSize = sizeof(indices[0]);
+VertexInputDescription VulkanModel::GetVertexInputDescription(VertexFormat format)
+{
+    if (format == VertexFormat::Standard)
+        return {Vertex::GetBindingDescriptions(), Vertex::GetAttributeDescriptions()};
 
-    VulkanBuffer stagingBuffer{
-        indexSize,
-        m_IndexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    };
+    const bool hasColor = format == VertexFormat::PackedColor;
+    return {PackedVertex::GetBindingDescriptions(hasColor), PackedVertex::GetAttributeDescriptions(hasColor)};
+}
 
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer(indices.data());
+VkIndexType VulkanModel::SelectIndexType(size_t vertexCount)
+{
+    // 0xFFFF is left out so the range stays valid should primitive restart ever be enabled
+    return vertexCount <= UINT16_MAX ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
 
-    m_IndexBuffer = std::make_unique<VulkanBuffer>(
-        indexSize,
-        m_IndexCount,
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+uint32_t VulkanModel::GetIndexSize(VkIndexType indexType)
+{
+    return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
 
-    VulkanBuffer::CopyBuffer(
-            stagingBuffer.GetBuffer(),
-            m_IndexBuffer->GetBuffer(),
-            bufferSize);
+void VulkanModel::WriteIndices(const uint32_t* indices, size_t indexCount, VkIndexType indexType, void* dst)
+{
+    if (indexType == VK_INDEX_TYPE_UINT16)
+    {
+        auto* narrowed = static_cast<uint16_t*>(dst);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            assert(indices[i] < UINT16_MAX && "index does not fit the 16 bit index type");
+            narrowed[i] = static_cast<uint16_t>(indices[i]);
+        }
+    }
+    else
+    {
+        std::memcpy(dst, indices, indexCount * sizeof(uint32_t));
+    }
+}
+
+void VulkanModel::UploadVertices(const void* vertices, uint32_t vertexCount)
+{
+    m_VertexCount = vertexCount;
+
+    assert(m_VertexCount >= 3 && "vertex count must be at least 3");
+
+    auto& pool = VulkanGeometryPool::Get();
+    m_VertexAllocation = pool.AllocateVertices(m_VertexFormat, m_VertexCount);
+    pool.UploadVertices(m_VertexFormat, m_VertexAllocation, 0, vertices);
 }
 
-void VulkanModel::Draw(VkCommandBuffer commandBuffer) const
+void VulkanModel::UploadColors(const uint32_t* colors)
+{
+    // Colors are the second stream of the vertex allocation and share its base vertex
+    VulkanGeometryPool::Get().UploadVertices(m_VertexFormat, m_VertexAllocation, 1, colors);
+}
+
+void VulkanModel::UploadIndices(const void* indices, uint32_t indexCount, VkIndexType indexType)
+{
+    m_IndexCount = indexCount;
+    m_IndexType = indexType;
+    m_HasIndexBuffer = m_IndexCount > 0;
+    if(!m_HasIndexBuffer) return;
+
+    auto& pool = VulkanGeometryPool::Get();
+    m_IndexAllocation = pool.AllocateIndices(m_IndexType, m_IndexCount);
+    pool.UploadIndices(m_IndexType, m_IndexAllocation, indices);
+}
+
+GeometryBinding VulkanModel::GetGeometryBinding() const
+{
+    GeometryBinding binding{};
+    binding.Format = m_VertexFormat;
+    binding.VertexBlock = m_VertexAllocation.Block;
+    binding.IndexType = m_IndexType;
+    binding.IndexBlock = m_HasIndexBuffer ? m_IndexAllocation.Block : GeometryAllocation::InvalidBlock;
+    return binding;
+}
+
+void VulkanModel::Draw(VkCommandBuffer commandBuffer, uint32_t lod) const
 {
     if(m_HasIndexBuffer)
     {
-        vkCmdDrawIndexed(commandBuffer, m_IndexCount, 1, 0, 0, 0);
+        if (m_Lods.empty())
+        {
+            DrawIndexRange(commandBuffer, 0, m_IndexCount);
+            return;
+        }
+
+        const MeshLod& range = m_Lods[std::min<size_t>(lod, m_Lods.size() - 1)];
+        DrawIndexRange(commandBuffer, range.FirstIndex, range.IndexCount);
     }
     else
     {
-        vkCmdDraw(commandBuffer,  m_VertexCount, 1, 0, 0);
+        vkCmdDraw(commandBuffer,  m_VertexCount, 1, m_VertexAllocation.Offset, 0);
     }
 }
 
-void VulkanModel::BindVertexInput(VkCommandBuffer commandBuffer)
+uint32_t VulkanModel::SelectLod(uint32_t currentLod, float pixelsPerUnit, float pixelThreshold, float hysteresis) const
 {
-    VkBuffer buffers[] = {m_VertexBuffer->GetBuffer()};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
-    if(m_HasIndexBuffer)
+    if (m_Lods.size() <= 1)
+        return 0;
+
+    const uint32_t lastLod = static_cast<uint32_t>(m_Lods.size()) - 1;
+    uint32_t lod = std::min(currentLod, lastLod);
+
+    while (lod < lastLod && m_Lods[lod + 1].Error * pixelsPerUnit <= pixelThreshold * (1.0f - hysteresis))
+        lod++;
+
+    while (lod > 0 && m_Lods[lod].Error * pixelsPerUnit > pixelThreshold * (1.0f + hysteresis))
+        lod--;
+
+    return lod;
+}
+
+void VulkanModel::DrawMeshlets(VkCommandBuffer commandBuffer, const glm::vec3& viewerPosition) const
+{
+    if (!m_HasIndexBuffer || m_Meshlets.empty())
+    {
+        Draw(commandBuffer);
+        return;
+    }
+
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    for (const auto& meshlet : m_Meshlets)
     {
-        vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        if (MeshOptimizer::IsMeshletBackfacing(meshlet, viewerPosition))
+            continue;
+
+        if (indexCount > 0 && firstIndex + indexCount == meshlet.FirstIndex)
+        {
+            indexCount += meshlet.IndexCount;
+            continue;
+        }
+
+        if (indexCount > 0)
+            DrawIndexRange(commandBuffer, firstIndex, indexCount);
+
+        firstIndex = meshlet.FirstIndex;
+        indexCount = meshlet.IndexCount;
     }
+
+    if (indexCount > 0)
+        DrawIndexRange(commandBuffer, firstIndex, indexCount);
+}
+
+void VulkanModel::DrawIndexRange(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount) const
+{
+    vkCmdDrawIndexed(commandBuffer, indexCount, 1, m_IndexAllocation.Offset + firstIndex, static_cast<int32_t>(m_VertexAllocation.Offset), 0);
+}
+
+void VulkanModel::BindVertexInput(VkCommandBuffer commandBuffer) const
+{
+    VulkanGeometryPool::Get().Bind(commandBuffer, GetGeometryBinding());
 }
 
 std::vector<VkVertexInputBindingDescription> VulkanModel::Vertex::GetBindingDescriptions()
@@ -248,3 +950,26 @@ std::vector<VkVertexInputAttributeDescription> VulkanModel::Vertex::GetAttribute
 
     return attributeDescriptions;
 }
+
+std::vector<VkVertexInputBindingDescription> VulkanModel::PackedVertex::GetBindingDescriptions(bool hasColor)
+{
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+    bindingDescriptions.push_back({0, sizeof(PackedVertex), VK_VERTEX_INPUT_RATE_VERTEX});
+    if (hasColor)
+        bindingDescriptions.push_back({1, sizeof(uint32_t), VK_VERTEX_INPUT_RATE_VERTEX});
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> VulkanModel::PackedVertex::GetAttributeDescriptions(bool hasColor)
+{
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+    attributeDescriptions.push_back({0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(PackedVertex, Position)});
+    if (hasColor)
+        attributeDescriptions.push_back({1, 1, VK_FORMAT_R8G8B8A8_UNORM, 0});
+    attributeDescriptions.push_back({2, 0, VK_FORMAT_R16G16_SNORM, offsetof(PackedVertex, Normal)});
+    attributeDescriptions.push_back({3, 0, VK_FORMAT_R16G16_SNORM, offsetof(PackedVertex, Tangent)});
+    attributeDescriptions.push_back({4, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(PackedVertex, UV)});
+
+    return attributeDescriptions;
+}
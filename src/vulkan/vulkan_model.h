@@ -3,11 +3,44 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include "vulkan_buffer.h"
+#include "vulkan_geometry_pool.h"
+#include "vulkan_graphics_pipeline.h"
+#include "core/mesh_optimizer.h"
 
 #include <memory>
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
+#include "core/bounds.h"
+
+class VulkanMeshCache;
+struct ModelSource;
+struct ObjData;
+
+// Vertex layouts a model can be uploaded with, each one has a matching G-Buffer pipeline
+enum class VertexFormat : uint32_t
+{
+    Standard = 0,   // VulkanModel::Vertex, 56 bytes
+    Packed,         // VulkanModel::PackedVertex, 20 bytes
+    PackedColor,    // VulkanModel::PackedVertex plus a separate 4 byte color stream
+    Count
+};
+
+struct ModelLoadOptions
+{
+    bool UseMeshCache = true;
+    // Reorder indices and vertices for post-transform cache, overdraw and vertex fetch efficiency
+    bool OptimizeMesh = true;
+    // Upload quantized PackedVertex data instead of full precision vertices
+    bool PackVertices = false;
+    // Partition the index buffer into meshlets with bounds and normal cones for cluster culling
+    bool BuildMeshlets = false;
+    // Append simplified levels of detail to the index buffer, selected per object from projected error
+    bool GenerateLods = false;
+    // Recompute tangents with the serial reference and report vertices where the parallel result differs.
+    // Runs when the model is built, a mesh cache hit skips it.
+    bool VerifyTangents = false;
+};
 
 class VulkanModel
 {
@@ -34,37 +67,160 @@ public:
         }
     };
 
+    // Positions are 16 bit unorm within the mesh bounds, normal and tangent are octahedral encoded
+    // and UVs are half floats. Vertex colors live in a separate stream and only exist when the source has them.
+    struct PackedVertex
+    {
+        uint16_t Position[4]{}; // w holds the bitangent sign, 0 = -1 and 65535 = +1
+        int16_t Normal[2]{};
+        int16_t Tangent[2]{};
+        uint16_t UV[2]{};
+
+        static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(bool hasColor);
+        static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(bool hasColor);
+    };
+
+    // Maps unorm positions back to object space, Position = Offset + Packed * Scale
+    struct QuantizationParams
+    {
+        glm::vec3 PositionOffset{0.0f};
+        glm::vec3 PositionScale{1.0f};
+    };
+
+    // Index range of one level of detail, Error is the largest object space deviation from LOD 0
+    struct MeshLod
+    {
+        uint32_t FirstIndex = 0;
+        uint32_t IndexCount = 0;
+        float Error = 0.0f;
+    };
+
+    static constexpr uint32_t MaxLodCount = 6;
+
     struct Builder
     {
         std::vector<Vertex> Vertices{};
         std::vector<uint32_t> Indices{};
+        // Type the indices are uploaded with, Indices stays 32 bit while the mesh is being processed
+        VkIndexType IndexType = VK_INDEX_TYPE_UINT32;
 
-        void LoadModel(const std::string& filePath);
+        VertexFormat Format = VertexFormat::Standard;
+        bool HasColors = false;
+        std::vector<PackedVertex> PackedVertices{};
+        std::vector<uint32_t> PackedColors{};
+        QuantizationParams Quantization{};
+        std::vector<MeshOptimizer::Meshlet> Meshlets{};
+        // Level 0 covers the original triangles, coarser levels follow it in Indices
+        std::vector<MeshLod> Lods{};
+        MeshBounds Bounds{};
+        // One per ObjData shape in file order, computed from the source positions of its triangles
+        std::vector<MeshBounds> SubmeshBounds{};
+        // Post-transform cache efficiency of LOD 0 around Optimize, left zeroed when the mesh isn't optimized
+        MeshOptimizer::VertexCacheStatistics CacheStatsBefore{};
+        MeshOptimizer::VertexCacheStatistics CacheStatsAfter{};
 
-    private:
+        void LoadModel(const std::string& filePath, const ModelLoadOptions& options = {});
+        void Optimize();
+        // Quantizes Vertices into PackedVertices (and PackedColors when the source has colors)
+        void Pack();
+        // Meshlets cover LOD 0 only, so they are built before GenerateLods appends to Indices
+        void BuildMeshlets();
+        void GenerateLods();
+
+        // Accumulates per-triangle tangents into the vertices, then orthonormalizes them against the normals.
+        // Triangles are split across the thread pool into per-chunk accumulators that are reduced per vertex.
         static void ComputeTangentBasis(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+        // Single threaded reference, also used for meshes too small to split across the thread pool
+        static void ComputeTangentBasisSerial(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+        // Runs the serial reference on a copy of computed vertices, returns how many tangents differ from it
+        static size_t VerifyTangentBasis(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+    private:
+        static void Deduplicate(const ObjData& objData, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
     };
 
     explicit VulkanModel(const Builder& builder);
-    ~VulkanModel() = default;
+    explicit VulkanModel(const VulkanMeshCache& meshCache);
+    ~VulkanModel();
 
     VulkanModel(const VulkanModel&) = delete;
 
     VulkanModel& operator=(const VulkanModel &) = delete;
 
-    static std::shared_ptr<VulkanModel> CreateModelFromFile(const std::string& filePath);
-    void BindVertexInput(VkCommandBuffer commandBuffer);
-    void Draw(VkCommandBuffer commandBuffer) const;
+    static std::shared_ptr<VulkanModel> CreateModelFromFile(const std::string& filePath, const ModelLoadOptions& options = {});
+    // CPU half of CreateModelFromFile: maps a valid mesh cache or builds the model and writes its cache.
+    // Touches no Vulkan state, so it can run on any thread.
+    static ModelSource LoadModelSource(const std::string& filePath, const ModelLoadOptions& options = {});
+    // GPU half, allocates and uploads the geometry
+    static std::shared_ptr<VulkanModel> CreateModelFromSource(const ModelSource& source);
+    static uint32_t GetVertexStride(VertexFormat format);
+    static VertexInputDescription GetVertexInputDescription(VertexFormat format);
+
+    // 16 bit indices whenever every vertex of a range is addressable with them. Batched geometry
+    // can call this per sub-range with the range's own vertex count and a base vertex offset.
+    static VkIndexType SelectIndexType(size_t vertexCount);
+    static uint32_t GetIndexSize(VkIndexType indexType);
+    // Copies indices into dst, narrowing them to 16 bit for VK_INDEX_TYPE_UINT16
+    static void WriteIndices(const uint32_t* indices, size_t indexCount, VkIndexType indexType, void* dst);
+
+    // Geometry lives in VulkanGeometryPool, models with the same binding can be drawn without rebinding
+    GeometryBinding GetGeometryBinding() const;
+    void BindVertexInput(VkCommandBuffer commandBuffer) const;
+    void Draw(VkCommandBuffer commandBuffer, uint32_t lod = 0) const;
+    // Draws the meshlets that are not back facing, consecutive visible meshlets are merged into one draw
+    void DrawMeshlets(VkCommandBuffer commandBuffer, const glm::vec3& viewerPosition) const;
+
+    // Picks the coarsest level whose error stays below the pixel threshold. pixelsPerUnit converts object space
+    // error to screen pixels, switching only past a margin around the threshold so objects don't flicker between levels.
+    uint32_t SelectLod(uint32_t currentLod, float pixelsPerUnit, float pixelThreshold = 1.0f, float hysteresis = 0.25f) const;
+
+    VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+    const QuantizationParams& GetQuantization() const { return m_Quantization; }
+    VkIndexType GetIndexType() const { return m_IndexType; }
+    const std::vector<MeshOptimizer::Meshlet>& GetMeshlets() const { return m_Meshlets; }
+    bool HasMeshlets() const { return !m_Meshlets.empty(); }
+    const std::vector<MeshLod>& GetLods() const { return m_Lods; }
+    uint32_t GetLodCount() const { return static_cast<uint32_t>(m_Lods.size()); }
+    // Object space, see MeshBounds::Transform for world space bounds
+    const MeshBounds& GetBounds() const { return m_Bounds; }
+    const std::vector<MeshBounds>& GetSubmeshBounds() const { return m_SubmeshBounds; }
+    const MeshOptimizer::VertexCacheStatistics& GetCacheStatsBefore() const { return m_CacheStatsBefore; }
+    const MeshOptimizer::VertexCacheStatistics& GetCacheStatsAfter() const { return m_CacheStatsAfter; }
 
 private:
-    void CreateVertexBuffer(const std::vector<Vertex>& vertices);
-    void CreateIndexBuffer(const std::vector<uint32_t>& indices);
+    void UploadVertices(const void* vertices, uint32_t vertexCount);
+    void UploadColors(const uint32_t* colors);
+    void UploadIndices(const void* indices, uint32_t indexCount, VkIndexType indexType);
+    void DrawIndexRange(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount) const;
 
 private:
-    std::unique_ptr<VulkanBuffer> m_VertexBuffer;
+    VertexFormat m_VertexFormat{VertexFormat::Standard};
+    QuantizationParams m_Quantization{};
+
+    GeometryAllocation m_VertexAllocation{};
     uint32_t m_VertexCount{};
 
     bool m_HasIndexBuffer{false};
-    std::unique_ptr<VulkanBuffer> m_IndexBuffer;
+    GeometryAllocation m_IndexAllocation{};
     uint32_t m_IndexCount{};
+    VkIndexType m_IndexType{VK_INDEX_TYPE_UINT32};
+
+    std::vector<MeshOptimizer::Meshlet> m_Meshlets;
+    std::vector<MeshLod> m_Lods;
+    MeshBounds m_Bounds{};
+    std::vector<MeshBounds> m_SubmeshBounds;
+    MeshOptimizer::VertexCacheStatistics m_CacheStatsBefore{};
+    MeshOptimizer::VertexCacheStatistics m_CacheStatsAfter{};
+};
+
+// Model data ready for upload, either a mapped mesh cache or a freshly built model
+struct ModelSource
+{
+    ModelSource();
+    ~ModelSource();
+    ModelSource(ModelSource&&) noexcept;
+    ModelSource& operator=(ModelSource&&) noexcept;
+
+    std::unique_ptr<VulkanMeshCache> Cache;
+    std::unique_ptr<VulkanModel::Builder> Builder;
 };
\ No newline at end of file
@@ -24,11 +24,11 @@ bool VulkanPhysicalDevice::IsDeviceSuitable(VkSurfaceKHR surface, const std::vec
         swapChainAdequate = !m_SwapchainSupportDetails.Formats.empty() && !m_SwapchainSupportDetails.PresentModes.empty();
     }
 
-    VkPhysicalDeviceFeatures supportedFeatures;
-    vkGetPhysicalDeviceFeatures(PhysicalDevice, &supportedFeatures);
+    vkGetPhysicalDeviceFeatures(PhysicalDevice, &PhysicalDeviceFeatures);
     vkGetPhysicalDeviceProperties(PhysicalDevice, &PhysicalDeviceProperties);
+    SupportsMemoryBudget = CheckDeviceExtensionSupport({ VK_EXT_MEMORY_BUDGET_EXTENSION_NAME });
 
-    return m_QueueFamilyIndices.IsComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+    return m_QueueFamilyIndices.IsComplete() && extensionsSupported && swapChainAdequate && PhysicalDeviceFeatures.samplerAnisotropy;
 }
 
 bool VulkanPhysicalDevice::CheckDeviceExtensionSupport(const std::vector<const char *>& deviceExtensions) const
@@ -25,6 +25,9 @@ struct VulkanPhysicalDevice
 public:
     VkPhysicalDevice PhysicalDevice{};
     VkPhysicalDeviceProperties PhysicalDeviceProperties{};
+    VkPhysicalDeviceFeatures PhysicalDeviceFeatures{};
+    // VK_EXT_memory_budget, enabled on the logical device when present
+    bool SupportsMemoryBudget = false;
 
     VulkanPhysicalDevice() = default;
     ~VulkanPhysicalDevice() = default;
@@ -2,9 +2,11 @@
 
 #include "core/frame_info.h"
 #include "vulkan_deferred_renderer.h"
+#include "vulkan_memory_allocator.h"
 #include "vulkan_simple_renderer.h"
 #include "vulkan_utils.h"
 
+#include <iostream>
 #include <memory>
 
 VulkanRenderer::VulkanRenderer(Window& window) : m_WindowRef(window)
@@ -35,7 +37,8 @@ void VulkanRenderer::Initialize()
 			sizeof(GlobalUbo),
 			1,
 			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			MemoryCategory::Uniforms);
 		uboBuffer->Map();
 	}
 
@@ -80,5 +83,11 @@ void VulkanRenderer::PrepareGameObjectForRendering(GameObject& gameObjectRef)
 
 void VulkanRenderer::OnSwapchainRecreate(uint32_t width, uint32_t height)
 {
+	// Resizing replaces every attachment, any extra allocation left afterwards is one that was never released
+	const uint32_t attachmentCount = VulkanMemoryAllocator::Get().GetStats().GetCategory(MemoryCategory::Attachments).AllocationCount;
 	m_Renderer->Resize(width, height);
+
+	const uint32_t resizedAttachmentCount = VulkanMemoryAllocator::Get().GetStats().GetCategory(MemoryCategory::Attachments).AllocationCount;
+	if (resizedAttachmentCount > attachmentCount)
+		std::cerr << "Swapchain recreation leaked " << resizedAttachmentCount - attachmentCount << " attachment allocations\n";
 }
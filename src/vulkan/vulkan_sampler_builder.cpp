@@ -86,7 +86,7 @@ VulkanSamplerBuilder& VulkanSamplerBuilder::SetForIntegerFormat(bool isInteger)
 	return *this;
 }
 
-VkSampler VulkanSamplerBuilder::Build()
+VkSampler VulkanSamplerBuilder::Build() const
 {
 	VkSampler sampler;
 	VK_CHECK_RESULT(vkCreateSampler(VulkanContext::Get().Device(), &m_CreateInfo, nullptr, &sampler));
@@ -17,7 +17,9 @@ public:
 	VulkanSamplerBuilder& SetBorderColor(VkBorderColor borderColor);
 	VulkanSamplerBuilder& SetForIntegerFormat(bool isInteger);
 
-	VkSampler Build();
+	const VkSamplerCreateInfo& GetCreateInfo() const { return m_CreateInfo; }
+	// Creates a sampler owned by the caller, images share theirs through VulkanSamplerCache instead
+	VkSampler Build() const;
 
 private:
 	VkSamplerCreateInfo m_CreateInfo{};
@@ -0,0 +1,103 @@
+#include "vulkan_sampler_cache.h"
+#include "vulkan_context.h"
+#include "vulkan_sampler_builder.h"
+#include "core/engine_utils.h"
+
+#include <cassert>
+#include <iostream>
+
+size_t VulkanSamplerCache::KeyHash::operator()(const Key& key) const
+{
+    static_assert(sizeof(Key) == 15 * sizeof(uint32_t), "Sampler key must not contain padding");
+    return static_cast<size_t>(EngineUtils::HashBytes(&key, sizeof(Key)));
+}
+
+void VulkanSamplerCache::Shutdown()
+{
+    VulkanSamplerCache& cache = Get();
+    std::lock_guard<std::mutex> lock(cache.m_Mutex);
+
+    for (auto& [key, entry] : cache.m_Samplers)
+    {
+        if (entry.RefCount > 0)
+            std::cerr << "Sampler destroyed with " << entry.RefCount << " references left\n";
+        vkDestroySampler(VulkanContext::Get().Device(), entry.Sampler, nullptr);
+    }
+
+    cache.m_Samplers.clear();
+    cache.m_Keys.clear();
+}
+
+VkSampler VulkanSamplerCache::Acquire(const VulkanSamplerBuilder& builder)
+{
+    const VkSamplerCreateInfo& info = builder.GetCreateInfo();
+    const Key key
+    {
+        info.magFilter,
+        info.minFilter,
+        info.mipmapMode,
+        info.addressModeU,
+        info.addressModeV,
+        info.addressModeW,
+        info.mipLodBias,
+        info.anisotropyEnable,
+        info.maxAnisotropy,
+        info.compareEnable,
+        info.compareOp,
+        info.minLod,
+        info.maxLod,
+        info.borderColor,
+        info.unnormalizedCoordinates
+    };
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    Entry& entry = m_Samplers[key];
+    if (entry.Sampler == VK_NULL_HANDLE)
+    {
+        entry.Sampler = builder.Build();
+        m_Keys[entry.Sampler] = key;
+    }
+
+    entry.RefCount++;
+    return entry.Sampler;
+}
+
+void VulkanSamplerCache::Release(VkSampler sampler)
+{
+    if (sampler == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // Unknown once Shutdown has destroyed everything
+    auto it = m_Keys.find(sampler);
+    if (it == m_Keys.end())
+        return;
+
+    Entry& entry = m_Samplers.at(it->second);
+    assert(entry.RefCount > 0);
+    entry.RefCount--;
+}
+
+void VulkanSamplerCache::TrimUnused()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::erase_if(m_Samplers, [this](const auto& pair)
+    {
+        const Entry& entry = pair.second;
+        if (entry.RefCount > 0)
+            return false;
+
+        m_Keys.erase(entry.Sampler);
+        vkDestroySampler(VulkanContext::Get().Device(), entry.Sampler, nullptr);
+        return true;
+    });
+}
+
+uint32_t VulkanSamplerCache::GetSamplerCount()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return static_cast<uint32_t>(m_Samplers.size());
+}
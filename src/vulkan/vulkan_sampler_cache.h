@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+class VulkanSamplerBuilder;
+
+// Shares one VkSampler between every image with the same sampler state. Acquire hands out a reference counted
+// sampler and Release drops the reference. Unreferenced samplers are kept until TrimUnused or Shutdown, so images
+// that are resized or reloaded don't create them again. Thread safe.
+class VulkanSamplerCache
+{
+public:
+    static VulkanSamplerCache& Get()
+    {
+        static VulkanSamplerCache cache;
+        return cache;
+    }
+
+    // Destroys every sampler, images still holding one must be released first
+    static void Shutdown();
+
+    VkSampler Acquire(const VulkanSamplerBuilder& builder);
+    void Release(VkSampler sampler);
+    // Destroys samplers no image references anymore
+    void TrimUnused();
+
+    uint32_t GetSamplerCount();
+
+private:
+    // Every VkSamplerCreateInfo field that affects sampling, all of them 32 bits wide so the key has no padding
+    struct Key
+    {
+        VkFilter MagFilter;
+        VkFilter MinFilter;
+        VkSamplerMipmapMode MipmapMode;
+        VkSamplerAddressMode AddressModeU;
+        VkSamplerAddressMode AddressModeV;
+        VkSamplerAddressMode AddressModeW;
+        float MipLodBias;
+        VkBool32 AnisotropyEnable;
+        float MaxAnisotropy;
+        VkBool32 CompareEnable;
+        VkCompareOp CompareOp;
+        float MinLod;
+        float MaxLod;
+        VkBorderColor BorderColor;
+        VkBool32 UnnormalizedCoordinates;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        VkSampler Sampler = VK_NULL_HANDLE;
+        uint32_t RefCount = 0;
+    };
+
+    VulkanSamplerCache() = default;
+
+    std::unordered_map<Key, Entry, KeyHash> m_Samplers;
+    std::unordered_map<VkSampler, Key> m_Keys;
+    std::mutex m_Mutex;
+};
@@ -7,8 +7,8 @@
 #include <shaderc/shaderc.hpp>
 #include <stdexcept>
 
-VulkanShader::VulkanShader(std::string filePath, ShaderType type)
-    : m_FilePath(std::move(filePath)), m_Type(type)
+VulkanShader::VulkanShader(std::string filePath, ShaderType type, std::vector<std::string> defines)
+    : m_FilePath(std::move(filePath)), m_Type(type), m_Defines(std::move(defines))
 {
     Load();
     std::vector<uint32_t> byteCode = Compile();
@@ -44,6 +44,8 @@ std::vector<uint32_t> VulkanShader::Compile()
     options.SetOptimizationLevel(shaderc_optimization_level_zero);
 	options.SetGenerateDebugInfo();
 	options.SetSourceLanguage(shaderc_source_language_glsl);
+    for (const auto& define : m_Defines)
+        options.AddMacroDefinition(define);
 
     shaderc_shader_kind kind;
     switch (m_Type)
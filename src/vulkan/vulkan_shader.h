@@ -4,7 +4,9 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <set>
+#include <stdexcept>
 #include <vulkan/vulkan.h>
 
 enum class ShaderType
@@ -66,12 +68,32 @@ struct ShaderDescriptorInfo
     {
         return uniqueSets.size();
     }
+
+    // Turns the uniform buffer at set and binding into one bound with a dynamic offset
+    void SetDynamicUniformBuffer(uint32_t set, uint32_t binding)
+    {
+        auto& descriptors = setDescriptors[set];
+        auto it = std::find_if(descriptors.begin(), descriptors.end(),
+                               [&](const DescriptorInfo& info)
+                               {
+                                   return info.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && info.binding == binding;
+                               });
+        if (it == descriptors.end())
+        {
+            throw std::runtime_error("No uniform buffer at set " + std::to_string(set) + " binding " + std::to_string(binding));
+        }
+
+        it->type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        totalDescriptorCounts[VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER] -= it->count;
+        totalDescriptorCounts[VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC] += it->count;
+    }
 };
 
 class VulkanShader
 {
 public:
-    VulkanShader(std::string filePath, ShaderType type);
+    // Defines are injected as preprocessor macros so one source can produce several variants
+    VulkanShader(std::string filePath, ShaderType type, std::vector<std::string> defines = {});
     ~VulkanShader();
 
     VulkanShaderReflection& GetReflection() const { return *m_Reflection; }
@@ -86,6 +108,7 @@ private:
 private:
     std::string m_FilePath;
     ShaderType m_Type;
+    std::vector<std::string> m_Defines;
     VkShaderModule m_ShaderModule = VK_NULL_HANDLE;
     std::string m_ShaderSource;
 
@@ -70,6 +70,7 @@ void VulkanSimpleRenderer::CreateSimpleTexture()
 		TextureSpecification noiseSpec
 		{
 			.Usage = TextureUsage::Texture,
+			.Encoding = MipGenerator::Encoding::Linear,
 			.DebugName = "Blue Noise",
 		};
 		m_SimpleTextureB = VulkanTexture2D::CreateFromFile(noiseSpec, "../assets/textures/blue-noise.png");
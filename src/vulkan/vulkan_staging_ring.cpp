@@ -0,0 +1,155 @@
+#include "vulkan_staging_ring.h"
+#include "vulkan_image.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    std::unique_ptr<VulkanBuffer> CreateOverflowBuffer(const void* data, VkDeviceSize size)
+    {
+        auto stagingBuffer = std::make_unique<VulkanBuffer>(
+                size,
+                1,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                MemoryCategory::Staging);
+        stagingBuffer->Map();
+        stagingBuffer->WriteToBuffer(data, size);
+        stagingBuffer->Unmap();
+        return stagingBuffer;
+    }
+}
+
+void VulkanStagingRing::Initialize(VkDeviceSize partitionSize)
+{
+    VulkanStagingRing& ring = Get();
+    std::lock_guard<std::mutex> lock(ring.m_Mutex);
+
+    ring.m_PartitionSize = partitionSize;
+    ring.m_Buffer = std::make_unique<VulkanBuffer>(
+            partitionSize,
+            VulkanSwapchain::MAX_FRAMES_IN_FLIGHT,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            MemoryCategory::Staging);
+    ring.m_Buffer->Map();
+
+    ring.m_Partitions = {};
+    ring.m_CurrentPartition = 0;
+    ring.m_Stats = {};
+    ring.m_Stats.PartitionSize = partitionSize;
+}
+
+void VulkanStagingRing::Shutdown()
+{
+    VulkanStagingRing& ring = Get();
+
+    // The transfer context is flushed before this, nothing reads the ring anymore
+    std::lock_guard<std::mutex> lock(ring.m_Mutex);
+    ring.m_Buffer.reset();
+    ring.m_Partitions = {};
+}
+
+void VulkanStagingRing::BeginFrame(uint32_t frameIndex)
+{
+    TransferTicket ticket;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ticket = m_Partitions[frameIndex].Ticket;
+    }
+
+    // Not the current partition, so nothing allocates from it while waiting. Waiting takes the transfer
+    // context's lock, which Allocate is called under, so the ring's own lock can't be held here.
+    if (ticket != 0)
+        VulkanTransferContext::Get().Wait(ticket);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Partitions[frameIndex] = {};
+    m_CurrentPartition = frameIndex;
+    m_Stats.UsedBytes = 0;
+}
+
+StagingAllocation VulkanStagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_Buffer)
+        return {};
+
+    Partition& partition = m_Partitions[m_CurrentPartition];
+    const VkDeviceSize offset = (partition.Head + alignment - 1) / alignment * alignment;
+    if (offset + size > m_PartitionSize)
+    {
+        m_Stats.OverflowCount++;
+        return {};
+    }
+
+    partition.Head = offset + size;
+    partition.Ticket = transfer.GetRecordingTicket();
+
+    m_Stats.UsedBytes = partition.Head;
+    m_Stats.PeakUsedBytes = std::max(m_Stats.PeakUsedBytes, m_Stats.UsedBytes);
+    m_Stats.UploadedBytes += size;
+
+    const VkDeviceSize bufferOffset = m_CurrentPartition * m_PartitionSize + offset;
+    return { m_Buffer->GetBuffer(), bufferOffset, size, static_cast<char*>(m_Buffer->GetMappedMemory()) + bufferOffset };
+}
+
+void VulkanStagingRing::UploadToBuffer(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size)
+{
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+    transfer.BeginRecording();
+
+    const StagingAllocation staging = Allocate(size);
+    if (staging.IsValid())
+    {
+        memcpy(staging.Mapped, data, size);
+        VulkanBuffer::CopyBuffer(staging.Buffer, destination, size, staging.Offset, destinationOffset);
+    }
+    else
+    {
+        std::unique_ptr<VulkanBuffer> stagingBuffer = CreateOverflowBuffer(data, size);
+        VulkanBuffer::CopyBuffer(stagingBuffer->GetBuffer(), destination, size, 0, destinationOffset);
+        transfer.Retain(std::move(stagingBuffer));
+    }
+
+    transfer.EndRecording();
+}
+
+void VulkanStagingRing::UploadToImage(VulkanImage2D& image, uint32_t mip, const void* data, VkDeviceSize size)
+{
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+    transfer.BeginRecording();
+
+    // Buffer offsets of image copies must be a multiple of the texel block size, 16 bytes covers every format
+    const StagingAllocation staging = Allocate(size, 16);
+    if (staging.IsValid())
+    {
+        memcpy(staging.Mapped, data, size);
+        image.CopyMipChainFromBuffer(staging.Buffer, {staging.Offset}, mip);
+    }
+    else
+    {
+        std::unique_ptr<VulkanBuffer> stagingBuffer = CreateOverflowBuffer(data, size);
+        image.CopyMipChainFromBuffer(stagingBuffer->GetBuffer(), {0}, mip);
+        transfer.Retain(std::move(stagingBuffer));
+    }
+
+    transfer.EndRecording();
+}
+
+VkDeviceSize VulkanStagingRing::GetAvailableBytes()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_Buffer)
+        return 0;
+    return m_PartitionSize - m_Partitions[m_CurrentPartition].Head;
+}
+
+StagingRingStats VulkanStagingRing::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
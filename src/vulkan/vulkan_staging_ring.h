@@ -0,0 +1,85 @@
+#pragma once
+
+#include "vulkan_buffer.h"
+#include "vulkan_swapchain.h"
+#include "vulkan_transfer_context.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+class VulkanImage2D;
+
+// Region of the staging ring, valid until the ring comes back around to its partition
+struct StagingAllocation
+{
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    VkDeviceSize Offset = 0;
+    VkDeviceSize Size = 0;
+    void* Mapped = nullptr;
+
+    bool IsValid() const { return Buffer != VK_NULL_HANDLE; }
+};
+
+struct StagingRingStats
+{
+    VkDeviceSize PartitionSize = 0;
+    // Bytes bump allocated from the current partition so far
+    VkDeviceSize UsedBytes = 0;
+    VkDeviceSize PeakUsedBytes = 0;
+    uint64_t UploadedBytes = 0;
+    // Uploads that didn't fit and got a staging buffer of their own
+    uint32_t OverflowCount = 0;
+};
+
+// One persistently mapped staging buffer split into a partition per frame in flight. Transient uploads bump
+// allocate from the current frame's partition and record their copy right away. BeginFrame moves to the next
+// partition once the transfer submissions that read it have finished, which is normally long done by the time
+// the ring comes back around. Uploads that don't fit fall back to a staging buffer of their own, and the space
+// left this frame is what the texture streamer throttles against.
+class VulkanStagingRing
+{
+public:
+    static VulkanStagingRing& Get()
+    {
+        static VulkanStagingRing ring;
+        return ring;
+    }
+
+    // After VulkanTransferContext::Initialize
+    static void Initialize(VkDeviceSize partitionSize = 16ull * 1024 * 1024);
+    static void Shutdown();
+
+    // Render thread, once per frame before any uploads of that frame
+    void BeginFrame(uint32_t frameIndex);
+
+    // Must be called between BeginRecording and EndRecording of the transfer context, the copy reading the region
+    // has to go into the submission that is open. Returns an invalid allocation when the partition is full.
+    StagingAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    // Stage data and record a copy into the destination. Safe on any thread: the ring and the transfer context are
+    // locked while recording and the submit holds VulkanContext::QueueMutex.
+    void UploadToBuffer(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size);
+    void UploadToImage(VulkanImage2D& image, uint32_t mip, const void* data, VkDeviceSize size);
+
+    VkDeviceSize GetAvailableBytes();
+    StagingRingStats GetStats();
+
+private:
+    struct Partition
+    {
+        VkDeviceSize Head = 0;
+        // Last transfer submission that reads from the partition
+        TransferTicket Ticket = 0;
+    };
+
+    VulkanStagingRing() = default;
+
+    std::unique_ptr<VulkanBuffer> m_Buffer;
+    std::array<Partition, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT> m_Partitions{};
+    uint32_t m_CurrentPartition = 0;
+    VkDeviceSize m_PartitionSize = 0;
+    StagingRingStats m_Stats{};
+    std::mutex m_Mutex;
+};
@@ -0,0 +1,273 @@
+#include "vulkan_streaming_model.h"
+#include "core/thread_pool.h"
+#include "vulkan_swapchain.h"
+#include "vulkan_transfer_context.h"
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+std::shared_ptr<VulkanStreamingModel> VulkanStreamingModel::CreateFromFile(const std::string& filePath, const ModelLoadOptions& options)
+{
+    const std::string chunkedPath = VulkanChunkedMesh::GetChunkedPath(filePath);
+
+    auto mesh = std::make_unique<VulkanChunkedMesh>();
+    if (!mesh->Open(chunkedPath, filePath))
+    {
+        // Chunking needs the whole model once, afterwards only the chunk table is read until the source changes
+        VulkanModel::Builder builder{};
+        builder.LoadModel(filePath, options);
+
+        if (!VulkanChunkedMesh::Write(chunkedPath, filePath, builder) || !mesh->Open(chunkedPath, filePath))
+            throw std::runtime_error("Failed to create chunked mesh: " + chunkedPath);
+    }
+
+    return std::make_shared<VulkanStreamingModel>(std::move(mesh));
+}
+
+VulkanStreamingModel::VulkanStreamingModel(std::unique_ptr<VulkanChunkedMesh> mesh)
+    : m_Mesh(std::move(mesh))
+{
+    m_Chunks.resize(m_Mesh->GetChunkCount());
+    m_Id = VulkanChunkStreamer::Get().Register(this);
+}
+
+VulkanStreamingModel::~VulkanStreamingModel()
+{
+    VulkanChunkStreamer::Get().Unregister(this);
+}
+
+void VulkanStreamingModel::RequestChunks(const glm::vec3& viewerPosition)
+{
+    VulkanChunkStreamer& streamer = VulkanChunkStreamer::Get();
+
+    const auto& chunks = m_Mesh->GetChunks();
+    for (uint32_t i = 0; i < chunks.size(); i++)
+    {
+        const float distance = std::max(glm::length(chunks[i].Bounds.Center - viewerPosition) - chunks[i].Bounds.Radius, 0.0f);
+        if (distance <= m_StreamDistance)
+            streamer.Request({m_Id, i}, distance);
+    }
+}
+
+void VulkanStreamingModel::Draw(VkCommandBuffer commandBuffer) const
+{
+    const auto& chunks = m_Mesh->GetChunks();
+    std::optional<GeometryBinding> boundGeometry;
+
+    for (uint32_t i = 0; i < m_Chunks.size(); i++)
+    {
+        const ChunkResidency& chunk = m_Chunks[i];
+        if (chunk.State != ChunkState::Resident)
+            continue;
+
+        GeometryBinding geometry{};
+        geometry.Format = GetVertexFormat();
+        geometry.VertexBlock = chunk.Vertices.Block;
+        geometry.IndexType = VK_INDEX_TYPE_UINT16;
+        geometry.IndexBlock = chunk.Indices.Block;
+        if (geometry != boundGeometry)
+        {
+            VulkanGeometryPool::Get().Bind(commandBuffer, geometry);
+            boundGeometry = geometry;
+        }
+
+        vkCmdDrawIndexed(commandBuffer, chunks[i].IndexCount, 1, chunk.Indices.Offset, static_cast<int32_t>(chunk.Vertices.Offset), 0);
+    }
+}
+
+void VulkanChunkStreamer::Initialize(const StreamingBudget& budget)
+{
+    Get().m_Budget = budget;
+}
+
+void VulkanChunkStreamer::Shutdown()
+{
+    VulkanChunkStreamer& streamer = Get();
+
+    streamer.m_Requests.clear();
+
+    std::lock_guard<std::mutex> lock(streamer.m_LoadedMutex);
+    streamer.m_Loaded.clear();
+}
+
+void VulkanChunkStreamer::ProcessLoads()
+{
+    m_Frame++;
+
+    // Decides which resident chunks are kept this frame before uploads evict anything
+    IssueReads();
+    UploadLoadedChunks();
+}
+
+uint64_t VulkanChunkStreamer::Register(VulkanStreamingModel* model)
+{
+    const uint64_t id = m_NextModelId++;
+    m_Models[id] = model;
+    return id;
+}
+
+void VulkanChunkStreamer::Unregister(VulkanStreamingModel* model)
+{
+    for (uint32_t chunk = 0; chunk < model->m_Chunks.size(); chunk++)
+    {
+        if (model->m_Chunks[chunk].State == VulkanStreamingModel::ChunkState::Resident)
+            Evict(*model, chunk);
+    }
+
+    // Reads still in flight are dropped when they arrive
+    std::erase_if(m_Requests, [id = model->m_Id](const ChunkRequest& request) { return request.Ref.ModelId == id; });
+    m_Models.erase(model->m_Id);
+}
+
+void VulkanChunkStreamer::IssueReads()
+{
+    std::stable_sort(m_Requests.begin(), m_Requests.end(), [](const ChunkRequest& a, const ChunkRequest& b) { return a.Distance < b.Distance; });
+
+    // Nearest chunks claim the device budget first, resident chunks beyond it become eviction candidates
+    uint64_t claimedBytes = m_LoadingBytes;
+    for (const ChunkRequest& request : m_Requests)
+    {
+        auto it = m_Models.find(request.Ref.ModelId);
+        if (it == m_Models.end())
+            continue;
+
+        VulkanStreamingModel& model = *it->second;
+        VulkanStreamingModel::ChunkResidency& chunk = model.m_Chunks[request.Ref.Chunk];
+        const uint64_t size = model.m_Mesh->GetChunkSize(request.Ref.Chunk);
+
+        // Already handled for another object sharing the model, or already counted in m_LoadingBytes
+        if (chunk.KeepFrame == m_Frame || chunk.State == VulkanStreamingModel::ChunkState::Loading)
+            continue;
+
+        const bool fitsDevice = claimedBytes + size <= m_Budget.DeviceBytes || claimedBytes == 0;
+        if (chunk.State == VulkanStreamingModel::ChunkState::Resident)
+        {
+            if (fitsDevice)
+            {
+                chunk.KeepFrame = m_Frame;
+                m_Lru.splice(m_Lru.begin(), m_Lru, chunk.LruEntry);
+                claimedBytes += size;
+            }
+            continue;
+        }
+
+        const bool fitsHost = m_HostBytes.load() + size <= m_Budget.HostBytes || m_HostBytes.load() == 0;
+        if (!fitsDevice || !fitsHost || m_ReadsInFlight >= m_Budget.MaxConcurrentReads)
+            continue;
+
+        chunk.State = VulkanStreamingModel::ChunkState::Loading;
+        chunk.KeepFrame = m_Frame;
+        claimedBytes += size;
+        m_LoadingBytes += size;
+        m_HostBytes += size;
+        m_ReadsInFlight++;
+
+        ThreadPool::Get().Submit([this, ref = request.Ref, mesh = model.m_Mesh, size]()
+        {
+            LoadedChunk loaded{};
+            loaded.Ref = ref;
+            loaded.Size = size;
+            loaded.Succeeded = mesh->ReadChunk(ref.Chunk, loaded.Data);
+
+            std::lock_guard<std::mutex> lock(m_LoadedMutex);
+            m_Loaded.push_back(std::move(loaded));
+        });
+    }
+
+    m_Requests.clear();
+}
+
+void VulkanChunkStreamer::UploadLoadedChunks()
+{
+    std::deque<LoadedChunk> loadedChunks;
+    {
+        std::lock_guard<std::mutex> lock(m_LoadedMutex);
+        loadedChunks.swap(m_Loaded);
+    }
+
+    if (loadedChunks.empty())
+        return;
+
+    VulkanGeometryPool& pool = VulkanGeometryPool::Get();
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+
+    transfer.BeginBatch();
+    for (LoadedChunk& loaded : loadedChunks)
+    {
+        m_ReadsInFlight--;
+        m_LoadingBytes -= loaded.Size;
+
+        auto it = m_Models.find(loaded.Ref.ModelId);
+        if (it != m_Models.end())
+        {
+            VulkanStreamingModel& model = *it->second;
+            VulkanStreamingModel::ChunkResidency& chunk = model.m_Chunks[loaded.Ref.Chunk];
+            const VulkanChunkedMesh::Chunk& source = model.m_Mesh->GetChunks()[loaded.Ref.Chunk];
+            const VertexFormat format = model.GetVertexFormat();
+
+            chunk.State = VulkanStreamingModel::ChunkState::Unloaded;
+            if (!loaded.Succeeded)
+            {
+                std::cerr << "Failed to read mesh chunk " << loaded.Ref.Chunk << "\n";
+            }
+            else if (MakeRoom(loaded.Size))
+            {
+                chunk.Vertices = pool.AllocateVertices(format, source.VertexCount);
+                pool.UploadVertices(format, chunk.Vertices, 0, loaded.Data.Vertices.data());
+                if (format == VertexFormat::PackedColor)
+                    pool.UploadVertices(format, chunk.Vertices, 1, loaded.Data.Colors.data());
+
+                chunk.Indices = pool.AllocateIndices(VK_INDEX_TYPE_UINT16, source.IndexCount);
+                pool.UploadIndices(VK_INDEX_TYPE_UINT16, chunk.Indices, loaded.Data.Indices.data());
+
+                chunk.State = VulkanStreamingModel::ChunkState::Resident;
+                chunk.KeepFrame = m_Frame;
+                chunk.LruEntry = m_Lru.insert(m_Lru.begin(), loaded.Ref);
+                m_ResidentBytes += loaded.Size;
+                model.m_ResidentCount++;
+            }
+        }
+
+        // The staging copies hold the data from here on
+        loaded.Data = {};
+        m_HostBytes -= loaded.Size;
+    }
+    transfer.EndBatch();
+}
+
+bool VulkanChunkStreamer::MakeRoom(uint64_t size)
+{
+    while (m_ResidentBytes + size > m_Budget.DeviceBytes && !m_Lru.empty())
+    {
+        const StreamingChunkRef ref = m_Lru.back();
+        VulkanStreamingModel& model = *m_Models.at(ref.ModelId);
+
+        // Kept chunks sit at the front, so everything from here on is needed this frame
+        if (model.m_Chunks[ref.Chunk].KeepFrame == m_Frame)
+            return false;
+
+        Evict(model, ref.Chunk);
+    }
+
+    // A single chunk larger than the whole budget still gets to load
+    return m_ResidentBytes + size <= m_Budget.DeviceBytes || m_ResidentBytes == 0;
+}
+
+void VulkanChunkStreamer::Evict(VulkanStreamingModel& model, uint32_t chunkIndex)
+{
+    VulkanStreamingModel::ChunkResidency& chunk = model.m_Chunks[chunkIndex];
+
+    m_Lru.erase(chunk.LruEntry);
+    // The pool holds on to the ranges until frames still drawing the chunk have retired
+    VulkanGeometryPool& pool = VulkanGeometryPool::Get();
+    pool.FreeVertices(model.GetVertexFormat(), chunk.Vertices);
+    pool.FreeIndices(VK_INDEX_TYPE_UINT16, chunk.Indices);
+    m_ResidentBytes -= model.m_Mesh->GetChunkSize(chunkIndex);
+    model.m_ResidentCount--;
+
+    chunk.State = VulkanStreamingModel::ChunkState::Unloaded;
+    chunk.Vertices = {};
+    chunk.Indices = {};
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "vulkan_chunked_mesh.h"
+#include "vulkan_geometry_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Limits shared by every streaming model. Host memory covers chunks read from disk and waiting for upload,
+// device memory covers resident chunks in the geometry pool.
+struct StreamingBudget
+{
+    uint64_t HostBytes = 128ull * 1024 * 1024;
+    uint64_t DeviceBytes = 512ull * 1024 * 1024;
+    uint32_t MaxConcurrentReads = 8;
+};
+
+struct StreamingChunkRef
+{
+    uint64_t ModelId = 0;
+    uint32_t Chunk = 0;
+};
+
+// Model backed by a chunked mesh file. Only the chunk table is kept in memory, chunks near the viewer are
+// read in the background and made resident in the geometry pool by VulkanChunkStreamer, which evicts the
+// least recently used ones when the budget is exhausted. Chunks that are not resident are simply not drawn.
+class VulkanStreamingModel
+{
+public:
+    // Opens the chunked mesh next to the source, writing it from a full model load the first time
+    static std::shared_ptr<VulkanStreamingModel> CreateFromFile(const std::string& filePath, const ModelLoadOptions& options = {});
+
+    explicit VulkanStreamingModel(std::unique_ptr<VulkanChunkedMesh> mesh);
+    ~VulkanStreamingModel();
+
+    VulkanStreamingModel(const VulkanStreamingModel&) = delete;
+    VulkanStreamingModel& operator=(const VulkanStreamingModel&) = delete;
+
+    // Render thread. Asks for every chunk within the stream distance of the viewer (object space), nearest first.
+    void RequestChunks(const glm::vec3& viewerPosition);
+    // Draws the resident chunks, binding the geometry of each one as needed
+    void Draw(VkCommandBuffer commandBuffer) const;
+
+    void SetStreamDistance(float distance) { m_StreamDistance = distance; }
+    float GetStreamDistance() const { return m_StreamDistance; }
+
+    VertexFormat GetVertexFormat() const { return m_Mesh->GetVertexFormat(); }
+    const VulkanModel::QuantizationParams& GetQuantization() const { return m_Mesh->GetQuantization(); }
+    const MeshBounds& GetBounds() const { return m_Mesh->GetBounds(); }
+    uint32_t GetChunkCount() const { return m_Mesh->GetChunkCount(); }
+    uint32_t GetResidentChunkCount() const { return m_ResidentCount; }
+
+private:
+    enum class ChunkState : uint8_t
+    {
+        Unloaded = 0,
+        Loading,
+        Resident
+    };
+
+    struct ChunkResidency
+    {
+        ChunkState State = ChunkState::Unloaded;
+        GeometryAllocation Vertices{};
+        GeometryAllocation Indices{};
+        std::list<StreamingChunkRef>::iterator LruEntry{};
+        // Frame in which the streamer last decided to keep the chunk, kept chunks are never evicted
+        uint64_t KeepFrame = 0;
+    };
+
+    std::shared_ptr<VulkanChunkedMesh> m_Mesh;
+    std::vector<ChunkResidency> m_Chunks;
+    uint64_t m_Id = 0;
+    uint32_t m_ResidentCount = 0;
+    float m_StreamDistance = std::numeric_limits<float>::max();
+
+    friend class VulkanChunkStreamer;
+};
+
+// Owns the residency of every streaming model. ProcessLoads runs once per frame on the render thread:
+// it uploads chunks read since the last frame, evicts least recently used chunks to stay within the
+// device budget and starts reads for the nearest missing chunks while the host budget allows.
+class VulkanChunkStreamer
+{
+public:
+    static VulkanChunkStreamer& Get()
+    {
+        static VulkanChunkStreamer streamer;
+        return streamer;
+    }
+
+    static void Initialize(const StreamingBudget& budget = {});
+    static void Shutdown();
+
+    void ProcessLoads();
+
+    const StreamingBudget& GetBudget() const { return m_Budget; }
+    uint64_t GetResidentBytes() const { return m_ResidentBytes; }
+    uint64_t GetHostBytes() const { return m_HostBytes.load(); }
+
+private:
+    struct ChunkRequest
+    {
+        StreamingChunkRef Ref;
+        float Distance;
+    };
+
+    struct LoadedChunk
+    {
+        StreamingChunkRef Ref;
+        uint64_t Size = 0;
+        bool Succeeded = false;
+        VulkanChunkedMesh::ChunkData Data;
+    };
+
+    VulkanChunkStreamer() = default;
+
+    uint64_t Register(VulkanStreamingModel* model);
+    void Unregister(VulkanStreamingModel* model);
+    void Request(const StreamingChunkRef& ref, float distance) { m_Requests.push_back({ref, distance}); }
+
+    void UploadLoadedChunks();
+    void IssueReads();
+    bool MakeRoom(uint64_t size);
+    void Evict(VulkanStreamingModel& model, uint32_t chunk);
+
+    StreamingBudget m_Budget{};
+    std::unordered_map<uint64_t, VulkanStreamingModel*> m_Models;
+    uint64_t m_NextModelId = 1;
+    uint64_t m_Frame = 1;
+
+    // Most recently kept chunks at the front
+    std::list<StreamingChunkRef> m_Lru;
+    std::vector<ChunkRequest> m_Requests;
+    uint64_t m_ResidentBytes = 0;
+    uint64_t m_LoadingBytes = 0;
+    uint32_t m_ReadsInFlight = 0;
+
+    std::deque<LoadedChunk> m_Loaded;
+    std::mutex m_LoadedMutex;
+    std::atomic<uint64_t> m_HostBytes = 0;
+
+    friend class VulkanStreamingModel;
+};
@@ -184,6 +184,7 @@ void VulkanSwapchain::SubmitCommandBuffer(FrameInfo& frameInfo)
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &frameInfo.DrawCommandBuffer;
 
+	std::lock_guard<std::mutex> lock(VulkanContext::Get().QueueMutex());
 	VK_CHECK_RESULT(vkQueueSubmit(VulkanContext::Get().GraphicsQueue(), 1, &submitInfo, m_InFlightFences[frameInfo.FrameIndex]));
 }
 
@@ -201,6 +202,7 @@ VkResult VulkanSwapchain::Present(FrameInfo& frameInfo, const uint32_t* imageInd
 	presentInfo.pSwapchains = swapChains;
 
 	presentInfo.pImageIndices = imageIndex;
+	std::lock_guard<std::mutex> lock(VulkanContext::Get().QueueMutex());
 	auto result = vkQueuePresentKHR(VulkanContext::Get().PresentQueue(), &presentInfo);
 	return result;
 }
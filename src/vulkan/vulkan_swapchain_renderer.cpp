@@ -28,7 +28,7 @@ void VulkanSwapchainRenderer::RecreateSwapchain()
 		extent = m_WindowRef.GetExtent();
 		glfwWaitEvents();
 	}
-	vkDeviceWaitIdle(VulkanContext::Get().Device());
+	VulkanContext::Get().WaitIdle();
 
 	if (m_Swapchain == nullptr)
 	{
@@ -48,7 +48,7 @@ void VulkanSwapchainRenderer::RecreateSwapchain()
 	if(m_RecreateSwapchainCallback)
 		m_RecreateSwapchainCallback(m_Swapchain->Width(), m_Swapchain->Height());
 
-	vkDeviceWaitIdle(VulkanContext::Get().Device());
+	VulkanContext::Get().WaitIdle();
 }
 
 void VulkanSwapchainRenderer::CreateDrawCommandBuffers()
@@ -1,16 +1,53 @@
 #include "vulkan_texture.h"
 #include "vulkan_context.h"
 #include "vulkan_buffer.h"
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
+#include "vulkan_staging_ring.h"
+#include "vulkan_texture_cache.h"
+#include "vulkan_texture_streamer.h"
+#include "vulkan_transfer_context.h"
+#include "core/image_decoder.h"
+#include "core/texture_compressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 #include <utility>
 
+namespace
+{
+    // ImageFormat::None when the texture stays uncompressed
+    ImageFormat GetCompressedFormat(const TextureSpecification& specification)
+    {
+        if (specification.Compression == TextureCompression::None || !VulkanContext::Get().PhysicalDeviceFeatures().textureCompressionBC)
+            return ImageFormat::None;
+
+        switch (specification.Compression)
+        {
+            case TextureCompression::BC1:
+                return ImageFormat::BC1;
+            case TextureCompression::BC3:
+                return ImageFormat::BC3;
+            case TextureCompression::BC5:
+                return ImageFormat::BC5;
+            case TextureCompression::BC7:
+                return ImageFormat::BC7;
+            default:
+                return specification.Encoding == MipGenerator::Encoding::NormalMap ? ImageFormat::BC5 : ImageFormat::BC7;
+        }
+    }
+}
+
 std::shared_ptr<VulkanTexture2D> VulkanTexture2D::CreateFromFile(const TextureSpecification& specification, const std::string& filepath)
+{
+    auto texture = DecodeFromFile(specification, filepath);
+    texture->Invalidate(false);
+    return texture;
+}
+
+std::shared_ptr<VulkanTexture2D> VulkanTexture2D::DecodeFromFile(const TextureSpecification& specification, const std::string& filepath)
 {
     auto texture = std::make_shared<VulkanTexture2D>(specification);
     texture->LoadFromFile(filepath);
-    texture->Invalidate(false);
     return texture;
 }
 
@@ -48,11 +85,20 @@ VkImage VulkanTexture2D::GetVkImage() const
 
 void VulkanTexture2D::Release()
 {
+    // Streaming textures are registered once their image exists
+    if (m_StreamSource && m_Image)
+        VulkanTextureStreamer::Get().Unregister(this);
+
     if (m_Image)
     {
         m_Image.reset();
     }
     m_ImageData.Release();
+    m_StagingBuffer.reset();
+    m_StagedMipOffsets.clear();
+    m_StagedBaseMip = 0;
+    m_StreamSource.reset();
+    m_ResidentMip = 0;
     m_DescriptorInfo = {};
 }
 
@@ -70,10 +116,23 @@ VulkanTexture2D::VulkanTexture2D(VulkanTexture2D&& other) noexcept
         : m_Specification(std::move(other.m_Specification)),
           m_Filepath(std::move(other.m_Filepath)),
           m_ImageData(std::move(other.m_ImageData)),
+          m_StagingBuffer(std::move(other.m_StagingBuffer)),
+          m_StagedMipOffsets(std::move(other.m_StagedMipOffsets)),
+          m_StagedBaseMip(other.m_StagedBaseMip),
+          m_DecodeMilliseconds(other.m_DecodeMilliseconds),
+          m_StreamSource(std::move(other.m_StreamSource)),
+          m_ResidentMip(other.m_ResidentMip),
           m_Image(std::move(other.m_Image)),
           m_DescriptorInfo(other.m_DescriptorInfo)
 {
     other.m_DescriptorInfo = {};
+
+    // The streamer tracks textures by address
+    if (m_StreamSource && m_Image)
+    {
+        VulkanTextureStreamer::Get().Unregister(&other);
+        VulkanTextureStreamer::Get().Register(this);
+    }
 }
 
 VulkanTexture2D& VulkanTexture2D::operator=(VulkanTexture2D&& other) noexcept
@@ -84,9 +143,21 @@ VulkanTexture2D& VulkanTexture2D::operator=(VulkanTexture2D&& other) noexcept
         m_Specification = std::move(other.m_Specification);
         m_Filepath = std::move(other.m_Filepath);
         m_ImageData = std::move(other.m_ImageData);
+        m_StagingBuffer = std::move(other.m_StagingBuffer);
+        m_StagedMipOffsets = std::move(other.m_StagedMipOffsets);
+        m_StagedBaseMip = other.m_StagedBaseMip;
+        m_DecodeMilliseconds = other.m_DecodeMilliseconds;
+        m_StreamSource = std::move(other.m_StreamSource);
+        m_ResidentMip = other.m_ResidentMip;
         m_Image = std::move(other.m_Image);
         m_DescriptorInfo = other.m_DescriptorInfo;
         other.m_DescriptorInfo = {};
+
+        if (m_StreamSource && m_Image)
+        {
+            VulkanTextureStreamer::Get().Unregister(&other);
+            VulkanTextureStreamer::Get().Register(this);
+        }
     }
     return *this;
 }
@@ -101,7 +172,7 @@ void VulkanTexture2D::Invalidate(bool release)
     {
         CreateAttachmentImage();
     }
-    else if (!m_ImageData.IsEmpty())
+    else if (m_StagingBuffer || !m_ImageData.IsEmpty())
     {
         CreateTextureImage();
     }
@@ -127,61 +198,88 @@ void VulkanTexture2D::Resize(uint32_t width, uint32_t height)
 void VulkanTexture2D::LoadFromFile(const std::string& filepath)
 {
     m_Filepath = filepath;
-    int width, height, channels;
-    stbi_set_flip_vertically_on_load(1);
-    void* data = nullptr;
 
-    if (stbi_is_hdr(filepath.c_str()))
+    const ImageFormat compressedFormat = GetCompressedFormat(m_Specification);
+
+    // Streaming reads its levels from the mapped cache
+    const bool streaming = m_Specification.Streaming && m_Specification.UseTextureCache && m_Specification.GenerateMips;
+
+    // Cooked textures map straight into staging, no decoding, mip generation or compression
+    const std::string cachePath = VulkanTextureCache::GetCachePath(filepath);
+    auto cache = std::make_unique<VulkanTextureCache>();
+    const ImageFormat cachedFormat = compressedFormat != ImageFormat::None ? compressedFormat : ImageFormat::RGBA;
+    if (m_Specification.UseTextureCache && cache->Open(cachePath, filepath, m_Specification.Encoding, cachedFormat, m_Specification.GenerateMips))
     {
-        data = stbi_loadf(filepath.c_str(), &width, &height, &channels, 4);
-        m_Specification.Format = ImageFormat::RGBA32F;
+        if (streaming)
+            StageMipTail(std::move(cache));
+        else
+            StageMipChain(cache->GetFormat(), cache->GetLevels(), cache->GetChainData());
+        return;
     }
+
+    ImageDecoder::DecodedImage image = ImageDecoder::DecodeFile(filepath);
+    m_DecodeMilliseconds = image.DecodeMilliseconds;
+
+    const uint32_t width = image.Width;
+    const uint32_t height = image.Height;
+    ImageFormat format = image.IsHDR ? ImageFormat::RGBA32F : ImageFormat::RGBA;
+
+    const uint32_t mipCount = m_Specification.GenerateMips ? ImageUtils::CalculateMipCount(width, height) : 1;
+    std::vector<MipGenerator::MipLevel> levels = MipGenerator::GetChainLayout(width, height, mipCount, ImageUtils::GetImageFormatBPP(format));
+
+    Buffer chain(MipGenerator::GetChainSize(levels));
+    std::memcpy(chain.Data(), image.Data(), levels[0].Size);
+    image = {};
+
+    if (format == ImageFormat::RGBA32F)
+        MipGenerator::GenerateRGBA32F(reinterpret_cast<float*>(chain.Data()), levels, m_Specification.Encoding);
     else
+        MipGenerator::GenerateRGBA8(chain.Data(), levels, m_Specification.Encoding);
+
+    // Every level is filtered at full precision first and compressed after, so mips don't compound block error
+    if (format == ImageFormat::RGBA && compressedFormat != ImageFormat::None)
     {
-        data = stbi_load(filepath.c_str(), &width, &height, &channels, 4);
-        m_Specification.Format = ImageFormat::RGBA;
+        const TextureCompressor::Format compressor = VulkanTextureCache::GetCompressorFormat(compressedFormat);
+        std::vector<MipGenerator::MipLevel> compressedLevels = VulkanTextureCache::GetChainLayout(compressedFormat, width, height, mipCount);
+
+        Buffer compressed(MipGenerator::GetChainSize(compressedLevels));
+        for (size_t i = 0; i < levels.size(); i++)
+            TextureCompressor::Compress(compressor, chain.Data() + levels[i].Offset, levels[i].Width, levels[i].Height, compressed.Data() + compressedLevels[i].Offset);
+
+        format = compressedFormat;
+        levels = std::move(compressedLevels);
+        chain = std::move(compressed);
     }
 
-    if (!data)
-        throw std::runtime_error("Failed to load image: " + filepath);
+    const bool cached = m_Specification.UseTextureCache && VulkanTextureCache::Write(cachePath, filepath, format, m_Specification.Encoding, levels, chain.Data());
+    if (m_Specification.UseTextureCache && !cached)
+        std::cerr << "Failed to write texture cache: " << cachePath << "\n";
 
-    m_Specification.Width = width;
-    m_Specification.Height = height;
+    // A freshly cooked texture streams from its cache like any other
+    if (streaming && cached && cache->Open(cachePath, filepath, m_Specification.Encoding, format, m_Specification.GenerateMips))
+    {
+        StageMipTail(std::move(cache));
+        return;
+    }
 
-    m_ImageData = Buffer::Copy(data, width * height * 4 * (m_Specification.Format == ImageFormat::RGBA32F ? sizeof(float) : sizeof(uint8_t)));
-    stbi_image_free(data);
+    StageMipChain(format, levels, chain.Data());
 }
 
 void VulkanTexture2D::LoadFromMemory(const Buffer& data)
 {
-    // Check if the data is in a format STB Image can recognize
-    if (stbi_is_hdr_from_memory(static_cast<const stbi_uc*>(data.Data()), static_cast<int>(data.GetSize())) ||
-        stbi_info_from_memory(static_cast<const stbi_uc*>(data.Data()), static_cast<int>(data.GetSize()), nullptr, nullptr, nullptr))
+    if (ImageDecoder::IsEncodedImage(data.Data(), data.GetSize()))
     {
-        // It's a compressed image format, use STB Image to load it
-        int width, height, channels;
-        stbi_set_flip_vertically_on_load(1);
-        void* imageData = nullptr;
-
-        if (stbi_is_hdr_from_memory(static_cast<const stbi_uc*>(data.Data()), static_cast<int>(data.GetSize())))
-        {
-            imageData = stbi_loadf_from_memory(static_cast<const stbi_uc*>(data.Data()), static_cast<int>(data.GetSize()), &width, &height, &channels, 4);
-            m_Specification.Format = ImageFormat::RGBA32F;
-        }
-        else
-        {
-            imageData = stbi_load_from_memory(static_cast<const stbi_uc*>(data.Data()), static_cast<int>(data.GetSize()), &width, &height, &channels, 4);
-            m_Specification.Format = ImageFormat::RGBA;
-        }
-
-        if (!imageData)
-            throw std::runtime_error("Failed to load image from memory");
+        // It's a compressed image format, decode it
+        const ImageDecoder::DecodedImage image = ImageDecoder::DecodeMemory(data.Data(), data.GetSize());
+        m_DecodeMilliseconds = image.DecodeMilliseconds;
 
-        m_Specification.Width = width;
-        m_Specification.Height = height;
+        m_Specification.Format = image.IsHDR ? ImageFormat::RGBA32F : ImageFormat::RGBA;
+        m_Specification.Width = image.Width;
+        m_Specification.Height = image.Height;
 
-        m_ImageData = Buffer::Copy(imageData, width * height * 4 * (m_Specification.Format == ImageFormat::RGBA32F ? sizeof(float) : sizeof(uint8_t)));
-        stbi_image_free(imageData);
+        StagePixelData(image.Data(), image.GetSize());
+        if (m_Specification.KeepPixelData)
+            m_ImageData = Buffer::Copy(image.Data(), image.GetSize());
     }
     else
     {
@@ -195,22 +293,92 @@ void VulkanTexture2D::LoadFromMemory(const Buffer& data)
         if (data.GetSize() != expectedSize)
             throw std::runtime_error("Raw pixel data size doesn't match the specified dimensions and format");
 
-        m_ImageData = Buffer::Copy(data.Data(), data.GetSize());
+        StagePixelData(data.Data(), data.GetSize());
+        if (m_Specification.KeepPixelData)
+            m_ImageData = Buffer::Copy(data.Data(), data.GetSize());
     }
 }
 
-void VulkanTexture2D::CreateTextureImage()
+void VulkanTexture2D::StagePixelData(const void* data, VkDeviceSize size)
 {
-    VkDeviceSize imageSize = m_ImageData.GetSize();
-    uint32_t mipLevels = m_Specification.GenerateMips ? ImageUtils::CalculateMipCount(m_Specification.Width, m_Specification.Height) : 1;
-
-    VulkanBuffer stagingBuffer(
-            imageSize,
+    // stb allocates its own output, so decoded pixels are copied once more on their way to the image
+    m_StagingBuffer = std::make_unique<VulkanBuffer>(
+            size,
             1,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer(m_ImageData.Data(), imageSize);
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            MemoryCategory::Staging);
+    m_StagingBuffer->Map();
+    m_StagingBuffer->WriteToBuffer(data, size);
+    m_StagingBuffer->Unmap();
+}
+
+void VulkanTexture2D::StageMipChain(ImageFormat format, const std::vector<MipGenerator::MipLevel>& levels, const void* chain)
+{
+    m_Specification.Format = format;
+    m_Specification.Width = levels[0].Width;
+    m_Specification.Height = levels[0].Height;
+
+    StagePixelData(chain, MipGenerator::GetChainSize(levels));
+    m_StagedMipOffsets.clear();
+    for (const auto& level : levels)
+        m_StagedMipOffsets.push_back(level.Offset);
+
+    if (m_Specification.KeepPixelData)
+        m_ImageData = Buffer::Copy(chain, levels[0].Size);
+}
+
+void VulkanTexture2D::StageMipTail(std::unique_ptr<VulkanTextureCache> source)
+{
+    const std::vector<MipGenerator::MipLevel>& levels = source->GetLevels();
+    const uint32_t tailSize = VulkanTextureStreamer::Get().GetBudget().TailSize;
+
+    uint32_t tailMip = static_cast<uint32_t>(levels.size()) - 1;
+    while (tailMip > 0 && std::max(levels[tailMip - 1].Width, levels[tailMip - 1].Height) <= tailSize)
+        tailMip--;
+
+    // Small enough to upload whole
+    if (tailMip == 0)
+    {
+        StageMipChain(source->GetFormat(), levels, source->GetChainData());
+        return;
+    }
+
+    m_Specification.Format = source->GetFormat();
+    m_Specification.Width = levels[0].Width;
+    m_Specification.Height = levels[0].Height;
+
+    // Levels are stored finest first, so the tail is one contiguous range at the end of the chain
+    const auto* chain = static_cast<const uint8_t*>(source->GetChainData());
+    const size_t tailOffset = levels[tailMip].Offset;
+    StagePixelData(chain + tailOffset, MipGenerator::GetChainSize(levels) - tailOffset);
+
+    m_StagedMipOffsets.clear();
+    for (uint32_t i = tailMip; i < levels.size(); i++)
+        m_StagedMipOffsets.push_back(levels[i].Offset - tailOffset);
+    m_StagedBaseMip = tailMip;
+    m_ResidentMip = tailMip;
+
+    if (m_Specification.KeepPixelData)
+        m_ImageData = Buffer::Copy(chain, levels[0].Size);
+
+    m_StreamSource = std::move(source);
+}
+
+void VulkanTexture2D::CreateTextureImage()
+{
+    // Kept pixel data is staged again when the image is recreated
+    if (!m_StagingBuffer)
+        StagePixelData(m_ImageData.Data(), m_ImageData.GetSize());
+
+    // A staged mip chain is copied as is, a single staged level gets its mips blitted on the GPU.
+    // Block compressed formats can't be blitted to, so without a staged chain they only get level 0.
+    VkDeviceSize imageSize = m_StagingBuffer->GetBufferSize();
+    const bool hasMipChain = !m_StagedMipOffsets.empty();
+    const bool canBlitMips = m_Specification.GenerateMips && !ImageUtils::IsBlockCompressed(m_Specification.Format);
+    uint32_t mipLevels = hasMipChain
+        ? m_StagedBaseMip + static_cast<uint32_t>(m_StagedMipOffsets.size())
+        : canBlitMips ? ImageUtils::CalculateMipCount(m_Specification.Width, m_Specification.Height) : 1;
 
     ImageSpecification imageSpec;
     imageSpec.Format = m_Specification.Format;
@@ -224,7 +392,19 @@ void VulkanTexture2D::CreateTextureImage()
 	imageSpec.Properties = m_Specification.MemoryProperties;
 
     m_Image = std::make_unique<VulkanImage2D>(imageSpec);
-    m_Image->CopyFromBufferAndGenerateMipmaps(stagingBuffer.GetBuffer(), imageSize, mipLevels);
+    if (hasMipChain)
+        m_Image->CopyMipChainFromBuffer(m_StagingBuffer->GetBuffer(), m_StagedMipOffsets, m_StagedBaseMip);
+    else
+        m_Image->CopyFromBufferAndGenerateMipmaps(m_StagingBuffer->GetBuffer(), imageSize, mipLevels);
+    m_StagedMipOffsets.clear();
+    m_StagedBaseMip = 0;
+
+    // Inside a transfer batch the copy has only been recorded, the staging memory has to outlive it
+    VulkanTransferContext::Get().Retain(std::move(m_StagingBuffer));
+
+    // Only the mip tail is resident, the streamer copies finer levels as objects need them
+    if (m_StreamSource)
+        VulkanTextureStreamer::Get().Register(this);
 }
 
 void VulkanTexture2D::CreateAttachmentImage()
@@ -263,15 +443,45 @@ void VulkanTexture2D::CreateEmptyTextureImage()
 
 void VulkanTexture2D::UpdateDescriptorInfo()
 {
-    m_DescriptorInfo = m_Image->GetDescriptorInfo();
+    // Levels finer than the resident one may not be uploaded yet, the view starts below them
+    m_DescriptorInfo = m_Image->GetView(m_ResidentMip)->GetDescriptorInfo();
+}
+
+void VulkanTexture2D::RequestResidency(float screenSize)
+{
+    if (m_StreamSource && m_Image)
+        VulkanTextureStreamer::Get().Request(this, screenSize);
+}
+
+uint64_t VulkanTexture2D::GetStreamedMipSize(uint32_t mip) const
+{
+    return m_StreamSource->GetLevels()[mip].Size;
+}
+
+void VulkanTexture2D::UploadMip(uint32_t mip)
+{
+    const MipGenerator::MipLevel& level = m_StreamSource->GetLevels()[mip];
+    VulkanStagingRing::Get().UploadToImage(*m_Image, mip, static_cast<const uint8_t*>(m_StreamSource->GetChainData()) + level.Offset, level.Size);
+}
+
+void VulkanTexture2D::SetResidentMip(uint32_t mip)
+{
+    m_ResidentMip = mip;
+    if (mip == 0)
+    {
+        // Fully resident, from here on it is an ordinary texture
+        m_Image->SetExpectedLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        m_StreamSource.reset();
+    }
+    UpdateDescriptorInfo();
 }
 
 void VulkanTexture2D::TransitionLayout(VkImageLayout newLayout)
 {
-	auto cmd = VulkanContext::Get().BeginSingleTimeCommands();
+	auto cmd = VulkanTransferContext::Get().BeginRecording();
 	m_Image->TransitionLayout(cmd, newLayout);
 	UpdateDescriptorInfo();
-	VulkanContext::Get().EndSingleTimeCommand(cmd);
+	VulkanTransferContext::Get().EndRecording();
 }
 
 void VulkanTexture2D::TransitionLayout(VkCommandBuffer cmd, VkImageLayout newLayout)
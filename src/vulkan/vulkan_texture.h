@@ -4,8 +4,14 @@
 #include <memory>
 #include "vulkan_image.h"
 #include "core/buffer.h"
+#include "core/mip_generator.h"
+
+class VulkanBuffer;
+class VulkanTextureCache;
 
 enum class TextureUsage { Texture, Attachment, Storage };
+// Auto picks BC5 for normal maps and BC7 for everything else
+enum class TextureCompression { None, Auto, BC1, BC3, BC5, BC7 };
 
 struct TextureSpecification
 {
@@ -18,6 +24,17 @@ struct TextureSpecification
     bool UsedInTransferOps = false;
 	bool CreateSampler = true;
 	SamplerSpecification SamplerSpec{};
+    // How the CPU mip chain of a file texture is filtered
+    MipGenerator::Encoding Encoding = MipGenerator::Encoding::SRGB;
+    // Cook file textures into a .cootex cache holding the whole mip chain, see VulkanTextureCache
+    bool UseTextureCache = true;
+    // Block compress 8 bit file textures on the CPU, ignored when the device lacks textureCompressionBC
+    TextureCompression Compression = TextureCompression::None;
+    // Upload only the mip tail of a file texture and stream finer levels on demand, see VulkanTextureStreamer.
+    // Needs the texture cache and a full mip chain, ignored otherwise.
+    bool Streaming = false;
+    // Keep a host copy of the pixels after upload, otherwise they only live in the staging buffer until the copy completes
+    bool KeepPixelData = false;
     std::string DebugName;
 };
 
@@ -25,6 +42,9 @@ class VulkanTexture2D
 {
 public:
     static std::shared_ptr<VulkanTexture2D> CreateFromFile(const TextureSpecification& specification, const std::string& filepath);
+    // Decodes the file into a mapped staging buffer without recording any commands, safe on any thread.
+    // Invalidate(false) creates the image and copies from the staging buffer.
+    static std::shared_ptr<VulkanTexture2D> DecodeFromFile(const TextureSpecification& specification, const std::string& filepath);
     static std::shared_ptr<VulkanTexture2D> CreateFromMemory(const TextureSpecification& specification, const Buffer& data);
     static std::shared_ptr<VulkanTexture2D> CreateAttachment(const TextureSpecification& specification);
 
@@ -50,6 +70,16 @@ public:
 
     VulkanImage2D* GetImage() const { return m_Image.get(); }
     VkDescriptorImageInfo GetBaseViewDescriptorInfo() const { return m_DescriptorInfo; }
+    // Empty unless the specification asks to keep the pixel data
+    const Buffer& GetPixelData() const { return m_ImageData; }
+    // Time spent in the image decoder, zero for raw pixels and textures loaded from the texture cache
+    double GetDecodeMilliseconds() const { return m_DecodeMilliseconds; }
+
+    // Render thread. Asks the streamer for the levels needed to cover screenSize pixels, no-op once fully resident.
+    void RequestResidency(float screenSize);
+    bool IsStreaming() const { return m_StreamSource != nullptr; }
+    // Finest mip level the descriptor can sample
+    uint32_t GetResidentMip() const { return m_ResidentMip; }
 
     void UpdateState(VkImageLayout expectedLayout);
 	void TransitionLayout(VkImageLayout newLayout);
@@ -58,14 +88,33 @@ public:
 private:
     void LoadFromFile(const std::string& filepath);
     void LoadFromMemory(const Buffer& data);
+    void StagePixelData(const void* data, VkDeviceSize size);
+    void StageMipChain(ImageFormat format, const std::vector<MipGenerator::MipLevel>& levels, const void* chain);
+    void StageMipTail(std::unique_ptr<VulkanTextureCache> source);
     void CreateTextureImage();
     void CreateAttachmentImage();
     void CreateEmptyTextureImage();
     void UpdateDescriptorInfo();
 
+    // Used by VulkanTextureStreamer
+    uint64_t GetStreamedMipSize(uint32_t mip) const;
+    void UploadMip(uint32_t mip);
+    void SetResidentMip(uint32_t mip);
+
     TextureSpecification m_Specification;
     std::string m_Filepath;
     Buffer m_ImageData;
+    // Decoded pixels waiting for CreateTextureImage, handed to the transfer context once the copy is recorded
+    std::unique_ptr<VulkanBuffer> m_StagingBuffer;
+    // Offsets of the staged levels starting at m_StagedBaseMip, empty when only level 0 is staged
+    std::vector<VkDeviceSize> m_StagedMipOffsets;
+    uint32_t m_StagedBaseMip = 0;
+    double m_DecodeMilliseconds = 0.0;
+    // Mapped texture cache the levels of a streaming texture are read from, released once mip 0 is resident
+    std::unique_ptr<VulkanTextureCache> m_StreamSource;
+    uint32_t m_ResidentMip = 0;
     std::unique_ptr<VulkanImage2D> m_Image;
     VkDescriptorImageInfo m_DescriptorInfo{};
+
+    friend class VulkanTextureStreamer;
 };
@@ -0,0 +1,148 @@
+#include "vulkan_texture_cache.h"
+#include "core/engine_utils.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr uint64_t DataAlignment = 16;
+}
+
+std::string VulkanTextureCache::GetCachePath(const std::string& sourcePath)
+{
+    return sourcePath + ".cootex";
+}
+
+std::vector<MipGenerator::MipLevel> VulkanTextureCache::GetChainLayout(ImageFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    if (ImageUtils::IsBlockCompressed(format))
+        return TextureCompressor::GetChainLayout(GetCompressorFormat(format), width, height, mipCount);
+    return MipGenerator::GetChainLayout(width, height, mipCount, ImageUtils::GetImageFormatBPP(format));
+}
+
+TextureCompressor::Format VulkanTextureCache::GetCompressorFormat(ImageFormat format)
+{
+    switch (format)
+    {
+        case ImageFormat::BC1:
+            return TextureCompressor::Format::BC1;
+        case ImageFormat::BC3:
+            return TextureCompressor::Format::BC3;
+        case ImageFormat::BC5:
+            return TextureCompressor::Format::BC5;
+        case ImageFormat::BC7:
+            return TextureCompressor::Format::BC7;
+        default:
+            throw std::runtime_error("Image format has no block compressor");
+    }
+}
+
+bool VulkanTextureCache::Write(const std::string& cachePath, const std::string& sourcePath, ImageFormat format, MipGenerator::Encoding encoding,
+                               const std::vector<MipGenerator::MipLevel>& levels, const void* chain)
+{
+    Header header{};
+    header.Magic = Magic;
+    header.Version = Version;
+    header.Format = format;
+    header.Encoding = encoding;
+    header.Width = levels.front().Width;
+    header.Height = levels.front().Height;
+    header.MipCount = static_cast<uint32_t>(levels.size());
+    header.DataOffset = (sizeof(Header) + DataAlignment - 1) & ~(DataAlignment - 1);
+    header.DataSize = MipGenerator::GetChainSize(levels);
+    if (!EngineUtils::GetFileStamp(sourcePath, header.SourceSize, header.SourceWriteTime))
+        return false;
+
+    // Write to a temporary file first so a crash mid-write never leaves a truncated cache behind
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+        if (!file.is_open())
+        {
+            std::cerr << "Unable to write texture cache: " << cachePath << "\n";
+            return false;
+        }
+
+        static constexpr char padding[DataAlignment]{};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(padding, static_cast<std::streamsize>(header.DataOffset - sizeof(Header)));
+        file.write(static_cast<const char*>(chain), static_cast<std::streamsize>(header.DataSize));
+
+        if (!file.good())
+        {
+            file.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+    if (ec)
+    {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanTextureCache::Open(const std::string& cachePath, const std::string& sourcePath, MipGenerator::Encoding encoding, ImageFormat format, bool fullMipChain)
+{
+    m_Header = {};
+    m_Levels.clear();
+
+    if (!m_File.Open(cachePath))
+        return false;
+
+    if (m_File.Size() < sizeof(Header))
+    {
+        m_File.Close();
+        return false;
+    }
+
+    const Header& header = *m_File.As<Header>();
+    const bool formatValid =
+        (header.Format == format || header.Format == ImageFormat::RGBA32F) &&
+        (header.Format == ImageFormat::RGBA || header.Format == ImageFormat::RGBA32F || ImageUtils::IsBlockCompressed(header.Format)) &&
+        header.Width > 0 && header.Height > 0;
+    const uint32_t expectedMipCount = formatValid && fullMipChain ? ImageUtils::CalculateMipCount(header.Width, header.Height) : 1;
+
+    bool headerValid =
+        header.Magic == Magic &&
+        header.Version == Version &&
+        header.Encoding == encoding &&
+        formatValid &&
+        header.MipCount == expectedMipCount;
+
+    if (headerValid)
+    {
+        m_Levels = GetChainLayout(header.Format, header.Width, header.Height, header.MipCount);
+        headerValid =
+            header.DataSize == MipGenerator::GetChainSize(m_Levels) &&
+            header.DataOffset + header.DataSize <= m_File.Size();
+    }
+
+    uint64_t sourceSize = 0;
+    int64_t sourceWriteTime = 0;
+    // A missing source is fine, the cache can be shipped on its own
+    const bool sourceMatches =
+        !EngineUtils::GetFileStamp(sourcePath, sourceSize, sourceWriteTime) ||
+        (sourceSize == header.SourceSize && sourceWriteTime == header.SourceWriteTime);
+
+    if (!headerValid || !sourceMatches)
+    {
+        m_Levels.clear();
+        m_File.Close();
+        return false;
+    }
+
+    m_Header = header;
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/mapped_file.h"
+#include "core/mip_generator.h"
+#include "core/texture_compressor.h"
+#include "vulkan_image_utils.h"
+
+#include <string>
+#include <vector>
+
+// Versioned binary container for a decoded texture and its full mip chain. Written next to the source image
+// on first load and memory mapped on every load after that. Levels are laid out as GetChainLayout describes,
+// so the whole chain is copied to staging at once and uploaded with one region per level. Block compressed
+// chains are stored already encoded and upload without any further CPU work.
+class VulkanTextureCache
+{
+public:
+    static constexpr uint32_t Magic = 0x544F4F43; // "COOT"
+    static constexpr uint32_t Version = 1;
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t SourceSize;
+        int64_t SourceWriteTime;
+        ImageFormat Format;
+        MipGenerator::Encoding Encoding;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t MipCount;
+        uint32_t Reserved;
+        uint64_t DataOffset;
+        uint64_t DataSize;
+    };
+
+    static std::string GetCachePath(const std::string& sourcePath);
+    // MipGenerator layout for texel formats, TextureCompressor layout for block compressed ones
+    static std::vector<MipGenerator::MipLevel> GetChainLayout(ImageFormat format, uint32_t width, uint32_t height, uint32_t mipCount);
+    static TextureCompressor::Format GetCompressorFormat(ImageFormat format);
+    static bool Write(const std::string& cachePath, const std::string& sourcePath, ImageFormat format, MipGenerator::Encoding encoding,
+                      const std::vector<MipGenerator::MipLevel>& levels, const void* chain);
+
+    // Maps the cache and validates it against the source file. Returns false when the cache is missing, stale,
+    // or was built with a different encoding, format or mip count. HDR sources are never compressed, so an
+    // RGBA32F cache satisfies any requested format.
+    bool Open(const std::string& cachePath, const std::string& sourcePath, MipGenerator::Encoding encoding, ImageFormat format, bool fullMipChain);
+    void Close() { m_File.Close(); }
+    bool IsOpen() const { return m_File.IsOpen(); }
+
+    ImageFormat GetFormat() const { return m_Header.Format; }
+    uint32_t GetWidth() const { return m_Header.Width; }
+    uint32_t GetHeight() const { return m_Header.Height; }
+    const std::vector<MipGenerator::MipLevel>& GetLevels() const { return m_Levels; }
+    const void* GetChainData() const { return m_File.Data() + m_Header.DataOffset; }
+    size_t GetChainSize() const { return m_Header.DataSize; }
+
+private:
+    MappedFile m_File;
+    Header m_Header{};
+    std::vector<MipGenerator::MipLevel> m_Levels;
+};
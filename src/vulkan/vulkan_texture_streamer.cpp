@@ -0,0 +1,133 @@
+#include "vulkan_texture_streamer.h"
+#include "vulkan_staging_ring.h"
+#include "vulkan_texture.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Finest level needed to keep roughly one texel per pixel, assuming the texture spans the surface once
+    uint32_t GetRequiredMip(const VulkanTexture2D& texture, float screenSize)
+    {
+        const float size = static_cast<float>(std::max(texture.GetWidth(), texture.GetHeight()));
+        if (screenSize >= size)
+            return 0;
+
+        const auto mip = static_cast<uint32_t>(std::floor(std::log2(size / std::max(screenSize, 1.0f))));
+        return std::min(mip, texture.GetImage()->GetSpecification().Mips - 1);
+    }
+}
+
+void VulkanTextureStreamer::Initialize(const TextureStreamingBudget& budget)
+{
+    Get().m_Budget = budget;
+}
+
+void VulkanTextureStreamer::Shutdown()
+{
+    VulkanTextureStreamer& streamer = Get();
+
+    // Textures still alive keep whatever levels they have
+    for (const PendingUpload& upload : streamer.m_Pending)
+        VulkanTransferContext::Get().Wait(upload.Ticket);
+
+    streamer.m_Pending.clear();
+    streamer.m_Requests.clear();
+    streamer.m_Textures.clear();
+}
+
+void VulkanTextureStreamer::ProcessUploads()
+{
+    ResolveCompletedUploads();
+    IssueUploads();
+    m_Requests.clear();
+}
+
+void VulkanTextureStreamer::Register(VulkanTexture2D* texture)
+{
+    m_Textures.push_back(texture);
+}
+
+void VulkanTextureStreamer::Unregister(VulkanTexture2D* texture)
+{
+    // The image is about to be destroyed, copies into it have to finish first
+    std::erase_if(m_Pending, [texture](const PendingUpload& upload)
+    {
+        if (upload.Texture != texture)
+            return false;
+
+        VulkanTransferContext::Get().Wait(upload.Ticket);
+        return true;
+    });
+
+    m_Requests.erase(texture);
+    std::erase(m_Textures, texture);
+}
+
+void VulkanTextureStreamer::Request(VulkanTexture2D* texture, float screenSize)
+{
+    float& requested = m_Requests[texture];
+    requested = std::max(requested, screenSize);
+}
+
+void VulkanTextureStreamer::ResolveCompletedUploads()
+{
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+
+    std::erase_if(m_Pending, [&](const PendingUpload& upload)
+    {
+        if (!transfer.IsComplete(upload.Ticket))
+            return false;
+
+        upload.Texture->SetResidentMip(upload.Mip);
+        if (upload.Mip == 0)
+            std::erase(m_Textures, upload.Texture);
+        return true;
+    });
+}
+
+void VulkanTextureStreamer::IssueUploads()
+{
+    if (m_Requests.empty())
+        return;
+
+    // Largest on screen first, those show missing detail the most
+    std::vector<std::pair<VulkanTexture2D*, float>> requests(m_Requests.begin(), m_Requests.end());
+    std::sort(requests.begin(), requests.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    VulkanTransferContext& transfer = VulkanTransferContext::Get();
+    std::vector<PendingUpload> issued;
+    uint64_t uploadedBytes = 0;
+
+    for (const auto& [texture, screenSize] : requests)
+    {
+        // One level in flight per texture, so levels land coarse to fine
+        const bool uploading = std::any_of(m_Pending.begin(), m_Pending.end(), [texture](const PendingUpload& upload) { return upload.Texture == texture; });
+        if (uploading || texture->GetResidentMip() <= GetRequiredMip(*texture, screenSize))
+            continue;
+
+        const uint32_t mip = texture->GetResidentMip() - 1;
+        const uint64_t size = texture->GetStreamedMipSize(mip);
+        if (uploadedBytes > 0 && (uploadedBytes + size > m_Budget.UploadBytesPerFrame || size > VulkanStagingRing::Get().GetAvailableBytes()))
+            continue;
+
+        if (issued.empty())
+            transfer.BeginBatch();
+
+        texture->UploadMip(mip);
+        issued.push_back({texture, mip, 0});
+        uploadedBytes += size;
+    }
+
+    if (issued.empty())
+        return;
+
+    const TransferTicket ticket = transfer.EndBatch();
+    for (PendingUpload& upload : issued)
+    {
+        upload.Ticket = ticket;
+        m_Pending.push_back(upload);
+    }
+    m_UploadedBytes += uploadedBytes;
+}
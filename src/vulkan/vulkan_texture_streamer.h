@@ -0,0 +1,67 @@
+#pragma once
+
+#include "vulkan_transfer_context.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class VulkanTexture2D;
+
+struct TextureStreamingBudget
+{
+    // Bytes of mip data copied per frame, one level is always allowed so large levels still make progress.
+    // Levels that no longer fit the staging ring's partition wait for the next frame as well.
+    uint64_t UploadBytesPerFrame = 8ull * 1024 * 1024;
+    // Levels no larger than this along either axis are uploaded with the texture itself
+    uint32_t TailSize = 64;
+};
+
+// Streams the finer mip levels of streaming textures (TextureSpecification::Streaming). Each texture is created
+// with its full chain but only the mip tail uploaded, its descriptor views the finest resident level. Objects
+// request the level their on-screen size needs, ProcessUploads copies the next finer level of the largest
+// requests first while the per-frame budget allows, and moves a texture's view down once its copy has executed.
+class VulkanTextureStreamer
+{
+public:
+    static VulkanTextureStreamer& Get()
+    {
+        static VulkanTextureStreamer streamer;
+        return streamer;
+    }
+
+    static void Initialize(const TextureStreamingBudget& budget = {});
+    static void Shutdown();
+
+    // Render thread, once per frame
+    void ProcessUploads();
+
+    const TextureStreamingBudget& GetBudget() const { return m_Budget; }
+    uint64_t GetUploadedBytes() const { return m_UploadedBytes; }
+
+private:
+    struct PendingUpload
+    {
+        VulkanTexture2D* Texture;
+        uint32_t Mip;
+        TransferTicket Ticket;
+    };
+
+    VulkanTextureStreamer() = default;
+
+    void Register(VulkanTexture2D* texture);
+    void Unregister(VulkanTexture2D* texture);
+    void Request(VulkanTexture2D* texture, float screenSize);
+
+    void ResolveCompletedUploads();
+    void IssueUploads();
+
+    TextureStreamingBudget m_Budget{};
+    // Largest on-screen size requested for each registered texture since the last ProcessUploads
+    std::unordered_map<VulkanTexture2D*, float> m_Requests;
+    std::vector<VulkanTexture2D*> m_Textures;
+    std::vector<PendingUpload> m_Pending;
+    uint64_t m_UploadedBytes = 0;
+
+    friend class VulkanTexture2D;
+};
@@ -0,0 +1,255 @@
+#include "vulkan_transfer_context.h"
+#include "vulkan_context.h"
+
+#include <stdexcept>
+
+void VulkanTransferContext::Initialize()
+{
+    VulkanTransferContext& context = Get();
+
+    QueueFamilyIndices queueFamilyIndices = VulkanContext::Get().GetAvailableDeviceQueueFamilyIndices();
+    if (!queueFamilyIndices.GraphicsFamily.has_value())
+        throw std::runtime_error("Unable to initialize the transfer context, no GraphicsFamily indices were found.");
+
+    // Transfers go through the graphics queue so mip blits and layout transitions can be recorded alongside copies
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.GraphicsFamily.value();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(VulkanContext::Get().Device(), &poolInfo, nullptr, &context.m_CommandPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create transfer command pool!");
+}
+
+void VulkanTransferContext::Shutdown()
+{
+    VulkanTransferContext& context = Get();
+    context.Flush();
+
+    VkDevice device = VulkanContext::Get().Device();
+    for (VkFence fence : context.m_FreeFences)
+        vkDestroyFence(device, fence, nullptr);
+    context.m_FreeFences.clear();
+
+    if (!context.m_FreeCommandBuffers.empty())
+    {
+        vkFreeCommandBuffers(device, context.m_CommandPool, static_cast<uint32_t>(context.m_FreeCommandBuffers.size()), context.m_FreeCommandBuffers.data());
+        context.m_FreeCommandBuffers.clear();
+    }
+
+    vkDestroyCommandPool(device, context.m_CommandPool, nullptr);
+    context.m_CommandPool = VK_NULL_HANDLE;
+}
+
+VkCommandBuffer VulkanTransferContext::BeginRecording()
+{
+    std::unique_lock<std::recursive_mutex> lock(m_Mutex);
+
+    // Unlocked again if opening the submission throws
+    if (m_Current.CommandBuffer == VK_NULL_HANDLE)
+        OpenSubmission();
+
+    m_RecordingDepth++;
+
+    // Recording has started, the lock is held until the matching EndRecording
+    lock.release();
+    return m_Current.CommandBuffer;
+}
+
+void VulkanTransferContext::EndRecording()
+{
+    if (m_RecordingDepth == 0)
+        throw std::runtime_error("VulkanTransferContext::EndRecording called without BeginRecording");
+
+    std::lock_guard<std::recursive_mutex> lock(m_Mutex, std::adopt_lock);
+
+    m_RecordingDepth--;
+    if (m_RecordingDepth == 0 && m_BatchDepth == 0)
+        Wait(Submit());
+}
+
+void VulkanTransferContext::Retain(std::unique_ptr<VulkanBuffer> buffer)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+    if (m_Current.CommandBuffer != VK_NULL_HANDLE)
+        m_Current.RetainedBuffers.push_back(std::move(buffer));
+    else if (!m_InFlight.empty())
+        m_InFlight.back().RetainedBuffers.push_back(std::move(buffer));
+}
+
+void VulkanTransferContext::BeginBatch()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+    m_BatchDepth++;
+}
+
+TransferTicket VulkanTransferContext::EndBatch()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+    if (m_BatchDepth == 0)
+        throw std::runtime_error("VulkanTransferContext::EndBatch called without BeginBatch");
+
+    m_BatchDepth--;
+    if (m_BatchDepth > 0 || m_RecordingDepth > 0 || m_Current.CommandBuffer == VK_NULL_HANDLE)
+        return m_NextTicket - 1;
+
+    return Submit();
+}
+
+TransferTicket VulkanTransferContext::GetRecordingTicket() const
+{
+    if (m_RecordingDepth == 0)
+        throw std::runtime_error("VulkanTransferContext::GetRecordingTicket called outside of a recording");
+
+    // Tickets are assigned in submission order and only the open submission can be recorded into
+    return m_NextTicket;
+}
+
+bool VulkanTransferContext::IsComplete(TransferTicket ticket)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+    CollectCompleted();
+    return ticket <= m_CompletedTicket;
+}
+
+void VulkanTransferContext::Wait(TransferTicket ticket)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+    if (ticket >= m_NextTicket && m_Current.CommandBuffer != VK_NULL_HANDLE && m_RecordingDepth == 0)
+        Submit();
+
+    // Submissions on one queue are not guaranteed to finish in order, wait on every fence up to the ticket
+    std::vector<VkFence> fences;
+    for (const Submission& submission : m_InFlight)
+    {
+        if (submission.Ticket <= ticket)
+            fences.push_back(submission.Fence);
+    }
+
+    if (!fences.empty())
+        vkWaitForFences(VulkanContext::Get().Device(), static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+
+    CollectCompleted();
+}
+
+void VulkanTransferContext::Flush()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+    // An open batch is submitted as is, later recordings start a new submission
+    if (m_Current.CommandBuffer != VK_NULL_HANDLE && m_RecordingDepth == 0)
+        Submit();
+
+    Wait(m_NextTicket - 1);
+}
+
+void VulkanTransferContext::OpenSubmission()
+{
+    VkDevice device = VulkanContext::Get().Device();
+
+    if (!m_FreeCommandBuffers.empty())
+    {
+        m_Current.CommandBuffer = m_FreeCommandBuffers.back();
+        m_FreeCommandBuffers.pop_back();
+    }
+    else
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = m_CommandPool;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &m_Current.CommandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to allocate transfer command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(m_Current.CommandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        m_FreeCommandBuffers.push_back(m_Current.CommandBuffer);
+        m_Current.CommandBuffer = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to begin transfer command buffer!");
+    }
+}
+
+TransferTicket VulkanTransferContext::Submit()
+{
+    VkDevice device = VulkanContext::Get().Device();
+
+    // Make the copies visible to every later read, waiting on the fence alone does not do that
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+            m_Current.CommandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+
+    vkEndCommandBuffer(m_Current.CommandBuffer);
+
+    if (!m_FreeFences.empty())
+    {
+        m_Current.Fence = m_FreeFences.back();
+        m_FreeFences.pop_back();
+    }
+    else
+    {
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkCreateFence(device, &fenceInfo, nullptr, &m_Current.Fence) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create transfer fence!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_Current.CommandBuffer;
+
+    {
+        std::lock_guard<std::mutex> lock(VulkanContext::Get().QueueMutex());
+        if (vkQueueSubmit(VulkanContext::Get().GraphicsQueue(), 1, &submitInfo, m_Current.Fence) != VK_SUCCESS)
+            throw std::runtime_error("Failed to submit transfer command buffer!");
+    }
+
+    m_Current.Ticket = m_NextTicket++;
+    const TransferTicket ticket = m_Current.Ticket;
+    m_InFlight.push_back(std::move(m_Current));
+    m_Current = {};
+
+    return ticket;
+}
+
+void VulkanTransferContext::CollectCompleted()
+{
+    VkDevice device = VulkanContext::Get().Device();
+
+    while (!m_InFlight.empty() && vkGetFenceStatus(device, m_InFlight.front().Fence) == VK_SUCCESS)
+    {
+        Submission& submission = m_InFlight.front();
+        m_CompletedTicket = submission.Ticket;
+
+        vkResetFences(device, 1, &submission.Fence);
+        m_FreeFences.push_back(submission.Fence);
+        // Reset implicitly by the next vkBeginCommandBuffer
+        m_FreeCommandBuffers.push_back(submission.CommandBuffer);
+
+        // Releases the retained staging buffers
+        m_InFlight.pop_front();
+    }
+}
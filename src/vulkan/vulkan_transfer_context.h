@@ -0,0 +1,82 @@
+#pragma once
+
+#include "vulkan_buffer.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Identifies one submission of the transfer context, tickets increase monotonically
+using TransferTicket = uint64_t;
+
+// Records uploads, blits and layout transitions into a shared command buffer and submits them with a fence.
+// Outside of a batch every recording is submitted on its own and waited on with its fence, which keeps the old
+// single time command behaviour without idling the whole queue. Inside BeginBatch/EndBatch everything recorded
+// goes into one submit, staging buffers handed to Retain live until its fence signals.
+// Recording is serialized by the context's lock and submits hold VulkanContext::QueueMutex like every other
+// submission to the queue, so uploads may come from any thread.
+class VulkanTransferContext
+{
+public:
+    static VulkanTransferContext& Get()
+    {
+        static VulkanTransferContext context;
+        return context;
+    }
+
+    static void Initialize();
+    static void Shutdown();
+
+    // Returns the command buffer to record into. Must be paired with EndRecording, pairs may nest.
+    VkCommandBuffer BeginRecording();
+    void EndRecording();
+
+    // Keeps a staging buffer alive until the commands recorded so far have executed.
+    // When nothing is pending the recorded work is already complete and the buffer is released right away.
+    void Retain(std::unique_ptr<VulkanBuffer> buffer);
+
+    // Batches nest, only the outermost EndBatch submits. Returns the ticket to wait on.
+    void BeginBatch();
+    TransferTicket EndBatch();
+
+    // Ticket the open submission will be submitted under, only meaningful between BeginRecording and EndRecording
+    TransferTicket GetRecordingTicket() const;
+
+    bool IsComplete(TransferTicket ticket);
+    // Waiting on the open submission's ticket submits it first, unless it is still being recorded
+    void Wait(TransferTicket ticket);
+    // Submits pending work and waits for every submission
+    void Flush();
+
+private:
+    struct Submission
+    {
+        TransferTicket Ticket = 0;
+        VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+        VkFence Fence = VK_NULL_HANDLE;
+        std::vector<std::unique_ptr<VulkanBuffer>> RetainedBuffers;
+    };
+
+    VulkanTransferContext() = default;
+
+    void OpenSubmission();
+    TransferTicket Submit();
+    // Releases the resources of every finished submission, oldest first
+    void CollectCompleted();
+
+    VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> m_FreeCommandBuffers;
+    std::vector<VkFence> m_FreeFences;
+
+    // Open submission, has a command buffer while recording or batching
+    Submission m_Current;
+    std::deque<Submission> m_InFlight;
+
+    TransferTicket m_NextTicket = 1;
+    TransferTicket m_CompletedTicket = 0;
+    uint32_t m_RecordingDepth = 0;
+    uint32_t m_BatchDepth = 0;
+
+    std::recursive_mutex m_Mutex;
+};
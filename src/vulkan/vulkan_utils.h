@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 
 inline const char* VKResultToString(VkResult result)
@@ -241,9 +242,9 @@ inline void SetDebugUtilsObjectName(VkDevice device, VkObjectType objectType, ui
 	}
 }
 
-inline void BeginDebugMarker(VkCommandBuffer cmdBuffer, const char* markerName, const float color[4])
+inline void BeginDebugMarker(VkInstance instance, VkCommandBuffer cmdBuffer, const char* markerName, const float color[4])
 {
-	auto func = (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(VulkanContext::Get().Instance(), "vkCmdBeginDebugUtilsLabelEXT");
+	auto func = (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT");
 	if (func != nullptr)
 	{
 		VkDebugUtilsLabelEXT markerInfo = {};
@@ -254,9 +255,9 @@ inline void BeginDebugMarker(VkCommandBuffer cmdBuffer, const char* markerName,
 	}
 }
 
-inline void EndDebugMarker(VkCommandBuffer cmdBuffer)
+inline void EndDebugMarker(VkInstance instance, VkCommandBuffer cmdBuffer)
 {
-	auto func = (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(VulkanContext::Get().Instance(), "vkCmdEndDebugUtilsLabelEXT");
+	auto func = (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT");
 	if (func != nullptr)
 	{
 		func(cmdBuffer);
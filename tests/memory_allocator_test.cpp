@@ -0,0 +1,206 @@
+// Headless checks for VulkanMemoryAllocator: suballocation, freeing and coalescing, block reuse, dedicated
+// allocations and stats. Needs nothing but a Vulkan device, so it runs on software drivers such as lavapipe
+// (VK_ICD_FILENAMES=.../lvp_icd.x86_64.json). Built without NDEBUG so ValidatePool checks every step.
+#include "vulkan/vulkan_memory_allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // ctest reports the test as skipped when no device is available
+    constexpr int SkipReturnCode = 77;
+    constexpr VkDeviceSize BlockSize = 1024 * 1024;
+
+    int s_FailureCount = 0;
+
+    void Check(bool condition, const char* message)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << message << "\n";
+            s_FailureCount++;
+        }
+    }
+
+    struct TestDevice
+    {
+        VkInstance Instance = VK_NULL_HANDLE;
+        VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+        VkDevice Device = VK_NULL_HANDLE;
+        VkPhysicalDeviceProperties Properties{};
+    };
+
+    bool CreateTestDevice(TestDevice& testDevice)
+    {
+        VkApplicationInfo appInfo{};
+        appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pApplicationName = "memory_allocator_test";
+        appInfo.apiVersion = VK_API_VERSION_1_1;
+
+        VkInstanceCreateInfo instanceInfo{};
+        instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceInfo.pApplicationInfo = &appInfo;
+        if (vkCreateInstance(&instanceInfo, nullptr, &testDevice.Instance) != VK_SUCCESS)
+            return false;
+
+        uint32_t deviceCount = 1;
+        VkResult result = vkEnumeratePhysicalDevices(testDevice.Instance, &deviceCount, &testDevice.PhysicalDevice);
+        if ((result != VK_SUCCESS && result != VK_INCOMPLETE) || deviceCount == 0)
+            return false;
+
+        vkGetPhysicalDeviceProperties(testDevice.PhysicalDevice, &testDevice.Properties);
+
+        // Any queue will do, nothing is submitted
+        const float priority = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo{};
+        queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueFamilyIndex = 0;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &priority;
+
+        VkDeviceCreateInfo deviceInfo{};
+        deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceInfo.queueCreateInfoCount = 1;
+        deviceInfo.pQueueCreateInfos = &queueInfo;
+        return vkCreateDevice(testDevice.PhysicalDevice, &deviceInfo, nullptr, &testDevice.Device) == VK_SUCCESS;
+    }
+
+    void DestroyTestDevice(TestDevice& testDevice)
+    {
+        if (testDevice.Device != VK_NULL_HANDLE)
+            vkDestroyDevice(testDevice.Device, nullptr);
+        if (testDevice.Instance != VK_NULL_HANDLE)
+            vkDestroyInstance(testDevice.Instance, nullptr);
+        testDevice = {};
+    }
+
+    VkMemoryRequirements MakeRequirements(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        VkMemoryRequirements requirements{};
+        requirements.size = size;
+        requirements.alignment = alignment;
+        requirements.memoryTypeBits = ~0u;
+        return requirements;
+    }
+
+    void TestSuballocation(VulkanMemoryAllocator& allocator, VkDeviceSize atomSize)
+    {
+        const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        MemoryAllocation a = allocator.Allocate(MakeRequirements(100, 16), hostVisible, MemoryResourceKind::Linear, MemoryCategory::Other);
+        MemoryAllocation b = allocator.Allocate(MakeRequirements(300, 64), hostVisible, MemoryResourceKind::Linear, MemoryCategory::Other);
+        MemoryAllocation c = allocator.Allocate(MakeRequirements(200, 256), hostVisible, MemoryResourceKind::Linear, MemoryCategory::Other);
+
+        Check(a.IsValid() && b.IsValid() && c.IsValid(), "small allocations succeed");
+        Check(!a.IsDedicated() && !b.IsDedicated() && !c.IsDedicated(), "small allocations are suballocated");
+        Check(a.Memory == b.Memory && b.Memory == c.Memory, "small allocations share one block");
+        Check(a.Offset + a.Size <= b.Offset && b.Offset + b.Size <= c.Offset, "suballocations don't overlap");
+        Check(b.Offset % 64 == 0 && c.Offset % 256 == 0, "suballocations honour their alignment");
+        Check(a.Size % atomSize == 0 && a.Offset % atomSize == 0, "host visible allocations cover whole atoms");
+        Check(a.Mapped != nullptr && c.Mapped != nullptr, "host visible blocks stay mapped");
+
+        std::memset(c.Mapped, 0xAB, 200);
+        Check(allocator.Flush(c, 64, 100) == VK_SUCCESS, "flushing a sub range succeeds");
+
+        MemoryStats stats = allocator.GetStats();
+        Check(stats.Types[a.MemoryType].BlockCount == 1, "one block backs the small allocations");
+        Check(stats.Types[a.MemoryType].AllocationCount == 3, "stats count three allocations");
+
+        // a and b coalesce into one range at offset 0, which an allocation of their combined size takes again
+        const VkDeviceSize combinedSize = b.Offset + b.Size;
+        allocator.Free(b);
+        allocator.Free(a);
+        Check(!a.IsValid() && !b.IsValid(), "Free resets the allocation");
+
+        MemoryAllocation combined = allocator.Allocate(MakeRequirements(combinedSize, 16), hostVisible, MemoryResourceKind::Linear, MemoryCategory::Other);
+        Check(combined.Memory == c.Memory && combined.Offset == 0, "freed neighbours coalesce into one range");
+
+        // The last empty block is kept, the next allocation reuses it without a new vkAllocateMemory
+        const VkDeviceMemory blockMemory = c.Memory;
+        const uint32_t deviceMemoryCount = allocator.GetStats().DeviceMemoryCount;
+        allocator.Free(combined);
+        allocator.Free(c);
+        Check(allocator.GetStats().DeviceMemoryCount == deviceMemoryCount, "the empty block is kept");
+
+        MemoryAllocation reused = allocator.Allocate(MakeRequirements(512, 16), hostVisible, MemoryResourceKind::Linear, MemoryCategory::Other);
+        Check(reused.Memory == blockMemory && reused.Offset == 0, "the kept block is reused");
+        Check(allocator.GetStats().DeviceMemoryCount == deviceMemoryCount, "reusing the block allocates no device memory");
+        allocator.Free(reused);
+    }
+
+    void TestBlockGrowth(VulkanMemoryAllocator& allocator)
+    {
+        const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        const VkDeviceSize blockSize = allocator.GetBlockSize();
+
+        // Quarter block allocations overflow into a second block, freeing them all leaves only one behind
+        std::vector<MemoryAllocation> allocations;
+        for (int i = 0; i < 6; i++)
+            allocations.push_back(allocator.Allocate(MakeRequirements(blockSize / 4, 16), hostVisible, MemoryResourceKind::Linear, MemoryCategory::Other));
+
+        const uint32_t memoryType = allocations[0].MemoryType;
+        Check(allocator.GetStats().Types[memoryType].BlockCount >= 2, "a full block makes room in a new one");
+
+        for (MemoryAllocation& allocation : allocations)
+            allocator.Free(allocation);
+        Check(allocator.GetStats().Types[memoryType].BlockCount == 1, "only one empty block survives");
+    }
+
+    void TestDedicated(VulkanMemoryAllocator& allocator)
+    {
+        // No required properties, any memory type will do
+        const VkMemoryPropertyFlags anyMemory = 0;
+        const VkDeviceSize blockSize = allocator.GetBlockSize();
+
+        MemoryAllocation requested = allocator.Allocate(MakeRequirements(4096, 256), anyMemory, MemoryResourceKind::Optimal, MemoryCategory::Attachments, true);
+        MemoryAllocation large = allocator.Allocate(MakeRequirements(blockSize / 2 + 1, 256), anyMemory, MemoryResourceKind::Linear, MemoryCategory::Geometry);
+        Check(requested.IsDedicated() && requested.Offset == 0, "requested dedicated allocations get their own memory");
+        Check(large.IsDedicated(), "allocations over half a block are dedicated");
+
+        MemoryStats stats = allocator.GetStats();
+        Check(stats.Types[requested.MemoryType].DedicatedCount >= 1, "stats count dedicated allocations");
+        Check(stats.GetCategory(MemoryCategory::Attachments).AllocationCount == 1, "categories track their allocations");
+
+        allocator.Free(requested);
+        allocator.Free(large);
+        stats = allocator.GetStats();
+        Check(stats.AllocationCount == 0 && stats.UsedBytes == 0, "stats return to zero once everything is freed");
+        Check(stats.GetCategory(MemoryCategory::Attachments).PeakAllocationCount == 1, "categories keep their high-water mark");
+    }
+}
+
+int main()
+{
+    TestDevice testDevice;
+    if (!CreateTestDevice(testDevice))
+    {
+        std::cerr << "No Vulkan device available, skipping\n";
+        DestroyTestDevice(testDevice);
+        return SkipReturnCode;
+    }
+
+    std::cout << "Running on " << testDevice.Properties.deviceName << "\n";
+
+    VulkanMemoryAllocator::Initialize(testDevice.Instance, testDevice.PhysicalDevice, testDevice.Device, false, BlockSize);
+    VulkanMemoryAllocator& allocator = VulkanMemoryAllocator::Get();
+
+    const VkDeviceSize atomSize = std::max<VkDeviceSize>(testDevice.Properties.limits.nonCoherentAtomSize, 1);
+    TestSuballocation(allocator, atomSize);
+    TestBlockGrowth(allocator);
+    TestDedicated(allocator);
+
+    VulkanMemoryAllocator::Shutdown();
+    DestroyTestDevice(testDevice);
+
+    if (s_FailureCount > 0)
+    {
+        std::cerr << s_FailureCount << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "All checks passed\n";
+    return EXIT_SUCCESS;
+}